@@ -7,6 +7,7 @@
 
 #include <chainparams.h>
 #include <consensus/validation.h>
+#include <primitives/block_view.h>
 #include <streams.h>
 #include <validation.h>
 
@@ -49,5 +50,17 @@ static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
     });
 }
 
+// The same, parsing the block in place instead of deserializing it.
+static void ParseBlockViewTest(benchmark::Bench& bench)
+{
+    const std::vector<uint8_t>& data = benchmark::data::block413567;
+
+    bench.unit("block").run([&] {
+        CBlockView block(MakeByteSpan(data));
+        ankerl::nanobench::doNotOptimizeAway(block.Transactions().size());
+    });
+}
+
 BENCHMARK(DeserializeBlockTest);
 BENCHMARK(DeserializeAndCheckBlockTest);
+BENCHMARK(ParseBlockViewTest);
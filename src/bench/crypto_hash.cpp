@@ -54,6 +54,35 @@ static void SHA3_256_1M(benchmark::Bench& bench)
     });
 }
 
+/* SHA3-256 of 1000 independent 250-byte messages, one at a time. */
+static void SHA3_256_250b_1000(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(250 * 1000, 0);
+    std::vector<uint256> out(1000);
+    bench.batch(out.size()).unit("message").run([&] {
+        for (size_t i = 0; i < out.size(); ++i) {
+            SHA3_256().Write({in.data() + 250 * i, 250}).Finalize(out[i]);
+        }
+    });
+}
+
+/* The same messages through the multi-buffer SHA3-256. */
+static void SHA3_256Multi_250b_1000(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(250 * 1000, 0);
+    std::vector<uint256> out(1000);
+    std::vector<unsigned char*> outputs;
+    std::vector<const unsigned char*> inputs;
+    std::vector<size_t> lengths(out.size(), 250);
+    for (size_t i = 0; i < out.size(); ++i) {
+        outputs.push_back(out[i].begin());
+        inputs.push_back(in.data() + 250 * i);
+    }
+    bench.batch(out.size()).unit("message").run([&] {
+        SHA3_256Multi(outputs.data(), inputs.data(), lengths.data(), out.size());
+    });
+}
+
 static void SHA256_32b(benchmark::Bench& bench)
 {
     std::vector<uint8_t> in(32,0);
@@ -72,6 +101,35 @@ static void SHA256D64_1024(benchmark::Bench& bench)
     });
 }
 
+/* Double SHA256 of 1000 independent 250-byte messages (about a typical transaction), one at a time. */
+static void SHA256D_250b_1000(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(250 * 1000, 0);
+    std::vector<uint256> out(1000);
+    bench.batch(out.size()).unit("message").run([&] {
+        for (size_t i = 0; i < out.size(); ++i) {
+            CHash256().Write({in.data() + 250 * i, 250}).Finalize(out[i]);
+        }
+    });
+}
+
+/* The same messages through the multi-buffer SHA256. */
+static void SHA256DMulti_250b_1000(benchmark::Bench& bench)
+{
+    std::vector<uint8_t> in(250 * 1000, 0);
+    std::vector<uint256> out(1000);
+    std::vector<unsigned char*> outputs;
+    std::vector<const unsigned char*> inputs;
+    std::vector<size_t> lengths(out.size(), 250);
+    for (size_t i = 0; i < out.size(); ++i) {
+        outputs.push_back(out[i].begin());
+        inputs.push_back(in.data() + 250 * i);
+    }
+    bench.batch(out.size()).unit("message").run([&] {
+        SHA256DMulti(outputs.data(), inputs.data(), lengths.data(), out.size());
+    });
+}
+
 static void SHA512(benchmark::Bench& bench)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -90,6 +148,34 @@ static void SipHash_32b(benchmark::Bench& bench)
     });
 }
 
+/* SipHash of 1000 transaction hashes, as done for compact block short IDs, one at a time. */
+static void SipHashUint256_1000(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> txhashes;
+    for (int i = 0; i < 1000; ++i) txhashes.push_back(rng.rand256());
+    std::vector<uint64_t> out(txhashes.size());
+    bench.batch(txhashes.size()).unit("hash").run([&] {
+        for (size_t i = 0; i < txhashes.size(); ++i) {
+            out[i] = SipHashUint256(1, 2, txhashes[i]);
+        }
+    });
+}
+
+/* The same hashes through the batched SipHash. */
+static void SipHashUint256Batch_1000(benchmark::Bench& bench)
+{
+    FastRandomContext rng(true);
+    std::vector<uint256> txhashes;
+    std::vector<const uint256*> txhash_ptrs;
+    for (int i = 0; i < 1000; ++i) txhashes.push_back(rng.rand256());
+    for (const uint256& txhash : txhashes) txhash_ptrs.push_back(&txhash);
+    std::vector<uint64_t> out(txhashes.size());
+    bench.batch(txhashes.size()).unit("hash").run([&] {
+        SipHashUint256Batch(1, 2, txhash_ptrs.data(), out.data(), txhash_ptrs.size());
+    });
+}
+
 static void FastRandom_32bit(benchmark::Bench& bench)
 {
     FastRandomContext rng(true);
@@ -159,10 +245,16 @@ BENCHMARK(SHA1);
 BENCHMARK(SHA256);
 BENCHMARK(SHA512);
 BENCHMARK(SHA3_256_1M);
+BENCHMARK(SHA3_256_250b_1000);
+BENCHMARK(SHA3_256Multi_250b_1000);
 
 BENCHMARK(SHA256_32b);
 BENCHMARK(SipHash_32b);
+BENCHMARK(SipHashUint256_1000);
+BENCHMARK(SipHashUint256Batch_1000);
 BENCHMARK(SHA256D64_1024);
+BENCHMARK(SHA256D_250b_1000);
+BENCHMARK(SHA256DMulti_250b_1000);
 BENCHMARK(FastRandom_32bit);
 BENCHMARK(FastRandom_1bit);
 
@@ -4,8 +4,10 @@
 
 #include <bench/bench.h>
 #include <blockfilter.h>
+#include <streams.h>
+#include <util/golombrice.h>
 
-static void ConstructGCSFilter(benchmark::Bench& bench)
+static GCSFilter::ElementSet GenerateGCSTestElements()
 {
     GCSFilter::ElementSet elements;
     for (int i = 0; i < 10000; ++i) {
@@ -14,6 +16,12 @@ static void ConstructGCSFilter(benchmark::Bench& bench)
         element[1] = static_cast<unsigned char>(i >> 8);
         elements.insert(std::move(element));
     }
+    return elements;
+}
+
+static void ConstructGCSFilter(benchmark::Bench& bench)
+{
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
 
     uint64_t siphash_k0 = 0;
     bench.batch(elements.size()).unit("elem").run([&] {
@@ -25,13 +33,7 @@ static void ConstructGCSFilter(benchmark::Bench& bench)
 
 static void MatchGCSFilter(benchmark::Bench& bench)
 {
-    GCSFilter::ElementSet elements;
-    for (int i = 0; i < 10000; ++i) {
-        GCSFilter::Element element(32);
-        element[0] = static_cast<unsigned char>(i);
-        element[1] = static_cast<unsigned char>(i >> 8);
-        elements.insert(std::move(element));
-    }
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
     GCSFilter filter({0, 0, 20, 1 << 20}, elements);
 
     bench.unit("elem").run([&] {
@@ -39,5 +41,74 @@ static void MatchGCSFilter(benchmark::Bench& bench)
     });
 }
 
+static void MatchAnyGCSFilter(benchmark::Bench& bench)
+{
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
+    GCSFilter filter({0, 0, 20, 1 << 20}, elements);
+
+    // A wallet-sized query set, none of which is in the filter.
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element element(32);
+        element[2] = static_cast<unsigned char>(i);
+        element[3] = static_cast<unsigned char>(i >> 8);
+        queries.insert(std::move(element));
+    }
+
+    bench.unit("query").run([&] {
+        filter.MatchAny(queries);
+    });
+}
+
+static void DecodeGCSFilter(benchmark::Bench& bench)
+{
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
+    GCSFilter filter({0, 0, 20, 1 << 20}, elements);
+    const std::vector<unsigned char>& encoded = filter.GetEncoded();
+
+    // Decoding with the full check, as done for filters received from peers.
+    bench.batch(elements.size()).unit("elem").run([&] {
+        GCSFilter decoded({0, 0, 20, 1 << 20}, encoded);
+    });
+}
+
+static void GolombRiceDecodeBitwise(benchmark::Bench& bench)
+{
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
+    GCSFilter filter({0, 0, 20, 1 << 20}, elements);
+    const std::vector<unsigned char>& encoded = filter.GetEncoded();
+
+    bench.batch(elements.size()).unit("elem").run([&] {
+        VectorReader stream(SER_NETWORK, 0, encoded, 0);
+        const uint64_t N = ReadCompactSize(stream);
+        BitStreamReader<VectorReader> bitreader(stream);
+        uint64_t sum = 0;
+        for (uint64_t i = 0; i < N; ++i) {
+            sum += GolombRiceDecode(bitreader, 20);
+        }
+        ankerl::nanobench::doNotOptimizeAway(sum);
+    });
+}
+
+static void GolombRiceDecodeWordwise(benchmark::Bench& bench)
+{
+    GCSFilter::ElementSet elements = GenerateGCSTestElements();
+    GCSFilter filter({0, 0, 20, 1 << 20}, elements);
+    const std::vector<unsigned char>& encoded = filter.GetEncoded();
+
+    bench.batch(elements.size()).unit("elem").run([&] {
+        GolombRiceReader reader(Span<const unsigned char>(encoded).subspan(GetSizeOfCompactSize(filter.GetN())));
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < filter.GetN(); ++i) {
+            sum += reader.Decode(20);
+        }
+        ankerl::nanobench::doNotOptimizeAway(sum);
+    });
+}
+
 BENCHMARK(ConstructGCSFilter);
 BENCHMARK(MatchGCSFilter);
+BENCHMARK(MatchAnyGCSFilter);
+BENCHMARK(DecodeGCSFilter);
+BENCHMARK(GolombRiceDecodeBitwise);
+BENCHMARK(GolombRiceDecodeWordwise);
@@ -0,0 +1,110 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+
+#include <clientversion.h>
+#include <coins.h>
+#include <primitives/block.h>
+#include <serialize.h>
+#include <streams.h>
+#include <uint256.h>
+#include <version.h>
+
+#include <vector>
+
+static CBlock ReadBenchBlock()
+{
+    CDataStream stream(benchmark::data::block413567, SER_NETWORK, PROTOCOL_VERSION);
+    CBlock block;
+    stream >> block;
+    return block;
+}
+
+// Serializing a block into a stream that grows as needed and is cleansed when
+// it does, as for the raw block RPCs before they used non-secret streams.
+static void SerializeBlockTest(benchmark::Bench& bench)
+{
+    const CBlock block = ReadBenchBlock();
+
+    bench.unit("block").run([&] {
+        CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+        stream << block;
+        assert(stream.size() == benchmark::data::block413567.size());
+    });
+}
+
+// The same into a non-secret stream that is sized up front.
+static void SerializeBlockReservedTest(benchmark::Bench& bench)
+{
+    const CBlock block = ReadBenchBlock();
+
+    bench.unit("block").run([&] {
+        CDataStream stream(non_secret, SER_NETWORK, PROTOCOL_VERSION);
+        stream.ReserveFor(block);
+        stream << block;
+        assert(stream.size() == benchmark::data::block413567.size());
+    });
+}
+
+static void SerializeTransactionsTest(benchmark::Bench& bench)
+{
+    const CBlock block = ReadBenchBlock();
+
+    bench.batch(block.vtx.size()).unit("tx").run([&] {
+        for (const auto& tx : block.vtx) {
+            CDataStream stream(non_secret, SER_NETWORK, PROTOCOL_VERSION);
+            stream << tx;
+            ankerl::nanobench::doNotOptimizeAway(stream.size());
+        }
+    });
+}
+
+// Coins are written to and read from the chainstate database one at a time,
+// through a CDataStream each.
+static void SerializeCoinsTest(benchmark::Bench& bench)
+{
+    const CBlock block = ReadBenchBlock();
+    std::vector<Coin> coins;
+    for (const auto& tx : block.vtx) {
+        for (const auto& txout : tx->vout) {
+            coins.emplace_back(txout, 413567, tx->IsCoinBase());
+        }
+    }
+
+    bench.batch(coins.size()).unit("coin").run([&] {
+        CDataStream stream(non_secret, SER_DISK, CLIENT_VERSION);
+        for (const auto& coin : coins) {
+            stream << coin;
+            Coin read;
+            stream >> read;
+        }
+        assert(stream.empty());
+    });
+}
+
+// Vectors of hashes are serialized with a single write and read.
+static void SerializeHashVectorTest(benchmark::Bench& bench)
+{
+    const CBlock block = ReadBenchBlock();
+    std::vector<uint256> hashes;
+    for (const auto& tx : block.vtx) {
+        hashes.push_back(tx->GetHash());
+    }
+
+    bench.batch(hashes.size()).unit("hash").run([&] {
+        CDataStream stream(non_secret, SER_NETWORK, PROTOCOL_VERSION);
+        stream << hashes;
+        std::vector<uint256> read;
+        stream >> read;
+        assert(read.size() == hashes.size());
+    });
+}
+
+BENCHMARK(SerializeBlockTest);
+BENCHMARK(SerializeBlockReservedTest);
+BENCHMARK(SerializeTransactionsTest);
+BENCHMARK(SerializeCoinsTest);
+BENCHMARK(SerializeHashVectorTest);
@@ -0,0 +1,99 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <random.h>
+#include <script/interpreter.h>
+#include <script/sigcache.h>
+#include <util/system.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+static constexpr size_t SIGCACHE_SIGNATURES = 1024;
+static constexpr size_t LOOKUPS_PER_THREAD = 4096;
+
+// Cached ECDSA signature lookups from every core at once, as the script check
+// threads do while validating a block whose transactions were seen in the
+// mempool (store = false, which marks found entries for eviction), or while
+// accepting transactions (store = true). With a writer, one more thread keeps
+// verifying and inserting new signatures meanwhile, as transaction relay does.
+static void SigCacheLookups(benchmark::Bench& bench, bool store, bool writer = false)
+{
+    const ECCVerifyHandle verify_handle;
+    ECC_Start();
+    InitSignatureCache();
+
+    const unsigned int n_threads = std::max(1, GetNumCores());
+    const CTransaction tx{CMutableTransaction{}};
+    PrecomputedTransactionData txdata;
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey = key.GetPubKey();
+    FastRandomContext rng(true);
+    std::vector<uint256> sighashes(SIGCACHE_SIGNATURES);
+    std::vector<std::vector<unsigned char>> sigs(SIGCACHE_SIGNATURES);
+    for (size_t i = 0; i < SIGCACHE_SIGNATURES; ++i) {
+        sighashes[i] = rng.rand256();
+        key.Sign(sighashes[i], sigs[i]);
+        const CachingTransactionSignatureChecker checker(&tx, 0, 0, /* storeIn */ true, txdata);
+        assert(checker.VerifyECDSASignature(sigs[i], pubkey, sighashes[i]));
+    }
+
+    FastRandomContext writer_rng(true);
+    bench.batch(n_threads * LOOKUPS_PER_THREAD).unit("lookup").run([&] {
+        std::atomic<bool> readers_done{false};
+        std::thread writer_thread;
+        if (writer) {
+            writer_thread = std::thread([&] {
+                const CachingTransactionSignatureChecker checker(&tx, 0, 0, /* storeIn */ true, txdata);
+                std::vector<unsigned char> sig;
+                while (!readers_done) {
+                    const uint256 sighash = writer_rng.rand256();
+                    key.Sign(sighash, sig);
+                    assert(checker.VerifyECDSASignature(sig, pubkey, sighash));
+                }
+            });
+        }
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < n_threads; ++t) {
+            threads.emplace_back([&, t] {
+                const CachingTransactionSignatureChecker checker(&tx, 0, 0, store, txdata);
+                for (size_t i = 0; i < LOOKUPS_PER_THREAD; ++i) {
+                    const size_t n = (i * n_threads + t) % SIGCACHE_SIGNATURES;
+                    assert(checker.VerifyECDSASignature(sigs[n], pubkey, sighashes[n]));
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        readers_done = true;
+        if (writer_thread.joinable()) writer_thread.join();
+    });
+    ECC_Stop();
+}
+
+static void SigCacheLookupsBlockValidation(benchmark::Bench& bench)
+{
+    SigCacheLookups(bench, /* store */ false);
+}
+
+static void SigCacheLookupsMempool(benchmark::Bench& bench)
+{
+    SigCacheLookups(bench, /* store */ true);
+}
+
+static void SigCacheLookupsMempoolWithWriter(benchmark::Bench& bench)
+{
+    SigCacheLookups(bench, /* store */ true, /* writer */ true);
+}
+
+BENCHMARK(SigCacheLookupsBlockValidation);
+BENCHMARK(SigCacheLookupsMempool);
+BENCHMARK(SigCacheLookupsMempoolWithWriter);
@@ -3,10 +3,13 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <hash.h>
 #include <key.h>
+#include <policy/policy.h>
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/chymeraconsensus.h>
 #endif
+#include <script/interpreter.h>
 #include <script/script.h>
 #include <script/standard.h>
 #include <streams.h>
@@ -75,6 +78,89 @@ static void VerifyScriptBench(benchmark::Bench& bench)
     ECC_Stop();
 }
 
+namespace {
+/** Signature checker that accepts every signature, to measure script evaluation alone. */
+class AcceptingSignatureChecker : public BaseSignatureChecker
+{
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const CScript& script_code, SigVersion sigversion) const override
+    {
+        return true;
+    }
+};
+
+/** A spend of each standard template, with well-formed but unchecked signatures. */
+struct TemplateSpend {
+    CScript script_sig;
+    CScript script_pubkey;
+    CScriptWitness witness;
+};
+
+TemplateSpend MakeTemplateSpend(TxoutType type)
+{
+    // A DER signature with SIGHASH_ALL and a compressed public key.
+    std::vector<unsigned char> sig{0x30, 0x44, 0x02, 0x20};
+    sig.insert(sig.end(), 32, 0x11);
+    sig.insert(sig.end(), {0x02, 0x20});
+    sig.insert(sig.end(), 32, 0x22);
+    sig.push_back(SIGHASH_ALL);
+    std::vector<std::vector<unsigned char>> pubkeys;
+    for (unsigned char i = 1; i <= 3; ++i) {
+        pubkeys.emplace_back(CPubKey::COMPRESSED_SIZE, i);
+        pubkeys.back()[0] = 0x02;
+    }
+    const uint160 hash = Hash160(pubkeys[0]);
+
+    TemplateSpend spend;
+    switch (type) {
+    case TxoutType::PUBKEYHASH:
+        spend.script_sig << sig << pubkeys[0];
+        spend.script_pubkey << OP_DUP << OP_HASH160 << ToByteVector(hash) << OP_EQUALVERIFY << OP_CHECKSIG;
+        break;
+    case TxoutType::WITNESS_V0_KEYHASH:
+        spend.script_pubkey << OP_0 << ToByteVector(hash);
+        spend.witness.stack = {sig, pubkeys[0]};
+        break;
+    case TxoutType::SCRIPTHASH: {
+        // 2-of-3 multisig
+        const CScript redeem_script = CScript() << OP_2 << pubkeys[0] << pubkeys[1] << pubkeys[2] << OP_3 << OP_CHECKMULTISIG;
+        spend.script_sig << OP_0 << sig << sig << ToByteVector(redeem_script);
+        spend.script_pubkey << OP_HASH160 << ToByteVector(Hash160(redeem_script)) << OP_EQUAL;
+        break;
+    }
+    default:
+        assert(false);
+    }
+    return spend;
+}
+
+void VerifyTemplateSpend(benchmark::Bench& bench, TxoutType type, bool use_template)
+{
+    const TemplateSpend spend = MakeTemplateSpend(type);
+    const AcceptingSignatureChecker checker;
+    bench.run([&] {
+        ScriptError err;
+        bool success;
+        if (use_template) {
+            success = VerifyTemplateScript(spend.script_sig, spend.script_pubkey, &spend.witness, STANDARD_SCRIPT_VERIFY_FLAGS, checker, &err) == TemplateResult::VALID;
+        } else {
+            success = VerifyScript(spend.script_sig, spend.script_pubkey, &spend.witness, STANDARD_SCRIPT_VERIFY_FLAGS, checker, &err);
+        }
+        assert(err == SCRIPT_ERR_OK);
+        assert(success);
+    });
+}
+} // namespace
+
+// Script evaluation of the standard templates, without the cost of checking
+// signatures: by the interpreter and by VerifyTemplateScript.
+static void VerifyP2PKHInterpreter(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::PUBKEYHASH, false); }
+static void VerifyP2PKHTemplate(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::PUBKEYHASH, true); }
+static void VerifyP2WPKHInterpreter(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::WITNESS_V0_KEYHASH, false); }
+static void VerifyP2WPKHTemplate(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::WITNESS_V0_KEYHASH, true); }
+static void VerifyP2SHMultisigInterpreter(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::SCRIPTHASH, false); }
+static void VerifyP2SHMultisigTemplate(benchmark::Bench& bench) { VerifyTemplateSpend(bench, TxoutType::SCRIPTHASH, true); }
+
 static void VerifyNestedIfScript(benchmark::Bench& bench)
 {
     std::vector<std::vector<unsigned char>> stack;
@@ -97,4 +183,10 @@ static void VerifyNestedIfScript(benchmark::Bench& bench)
 }
 
 BENCHMARK(VerifyScriptBench);
+BENCHMARK(VerifyP2PKHInterpreter);
+BENCHMARK(VerifyP2PKHTemplate);
+BENCHMARK(VerifyP2WPKHInterpreter);
+BENCHMARK(VerifyP2WPKHTemplate);
+BENCHMARK(VerifyP2SHMultisigInterpreter);
+BENCHMARK(VerifyP2SHMultisigTemplate);
 BENCHMARK(VerifyNestedIfScript);
@@ -14,18 +14,25 @@
 #include <validation.h>
 #include <util/system.h>
 
+#include <algorithm>
 #include <unordered_map>
 
+//! Number of transaction hashes whose short IDs are computed per batch.
+static constexpr size_t SHORTID_BATCH_SIZE{64};
+
 CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block, bool fUseWTXID) :
         nonce(GetRand(std::numeric_limits<uint64_t>::max())),
         shorttxids(block.vtx.size() - 1), prefilledtxn(1), header(block) {
     FillShortTxIDSelector();
     //TODO: Use our mempool prior to block acceptance to predictively fill more than just the coinbase
     prefilledtxn[0] = {0, block.vtx[0]};
+    std::vector<const uint256*> txhashes;
+    txhashes.reserve(shorttxids.size());
     for (size_t i = 1; i < block.vtx.size(); i++) {
         const CTransaction& tx = *block.vtx[i];
-        shorttxids[i - 1] = GetShortID(fUseWTXID ? tx.GetWitnessHash() : tx.GetHash());
+        txhashes.push_back(fUseWTXID ? &tx.GetWitnessHash() : &tx.GetHash());
     }
+    GetShortIDs(txhashes.data(), shorttxids.data(), txhashes.size());
 }
 
 void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector() const {
@@ -44,6 +51,13 @@ uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256& txhash) const {
     return SipHashUint256(shorttxidk0, shorttxidk1, txhash) & cxffffffffffffL;
 }
 
+void CBlockHeaderAndShortTxIDs::GetShortIDs(const uint256* const* txhashes, uint64_t* shortids, size_t count) const {
+    SipHashUint256Batch(shorttxidk0, shorttxidk1, txhashes, shortids, count);
+    for (size_t i = 0; i < count; i++) {
+        shortids[i] &= 0xffffffffffffL;
+    }
+}
+
 
 
 ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const std::vector<std::pair<uint256, CTransactionRef>>& extra_txn) {
@@ -105,8 +119,18 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     std::vector<bool> have_txn(txn_available.size());
     {
     LOCK(pool->cs);
+    // Short IDs are computed a batch at a time, ahead of the lookups.
+    const uint256* txhashes[SHORTID_BATCH_SIZE];
+    uint64_t shortids[SHORTID_BATCH_SIZE];
     for (size_t i = 0; i < pool->vTxHashes.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(pool->vTxHashes[i].first);
+        if (i % SHORTID_BATCH_SIZE == 0) {
+            const size_t count = std::min(SHORTID_BATCH_SIZE, pool->vTxHashes.size() - i);
+            for (size_t j = 0; j < count; j++) {
+                txhashes[j] = &pool->vTxHashes[i + j].first;
+            }
+            cmpctblock.GetShortIDs(txhashes, shortids, count);
+        }
+        uint64_t shortid = shortids[i % SHORTID_BATCH_SIZE];
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
@@ -131,8 +155,17 @@ ReadStatus PartiallyDownloadedBlock::InitData(const CBlockHeaderAndShortTxIDs& c
     }
     }
 
+    const uint256* txhashes[SHORTID_BATCH_SIZE];
+    uint64_t shortids[SHORTID_BATCH_SIZE];
     for (size_t i = 0; i < extra_txn.size(); i++) {
-        uint64_t shortid = cmpctblock.GetShortID(extra_txn[i].first);
+        if (i % SHORTID_BATCH_SIZE == 0) {
+            const size_t count = std::min(SHORTID_BATCH_SIZE, extra_txn.size() - i);
+            for (size_t j = 0; j < count; j++) {
+                txhashes[j] = &extra_txn[i + j].first;
+            }
+            cmpctblock.GetShortIDs(txhashes, shortids, count);
+        }
+        uint64_t shortid = shortids[i % SHORTID_BATCH_SIZE];
         std::unordered_map<uint64_t, uint16_t>::iterator idit = shorttxids.find(shortid);
         if (idit != shorttxids.end()) {
             if (!have_txn[idit->second]) {
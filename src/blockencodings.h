@@ -108,6 +108,9 @@ public:
 
     uint64_t GetShortID(const uint256& txhash) const;
 
+    /** Compute the short IDs of count transaction hashes, as GetShortID would, in one batch. */
+    void GetShortIDs(const uint256* const* txhashes, uint64_t* shortids, size_t count) const;
+
     size_t BlockTxCount() const { return shorttxids.size() + prefilledtxn.size(); }
 
     SERIALIZE_METHODS(CBlockHeaderAndShortTxIDs, obj)
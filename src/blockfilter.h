@@ -58,8 +58,10 @@ public:
     /** Constructs an empty filter. */
     explicit GCSFilter(const Params& params = Params());
 
-    /** Reconstructs an already-created filter from an encoding. */
-    GCSFilter(const Params& params, std::vector<unsigned char> encoded_filter);
+    /** Reconstructs an already-created filter from an encoding. The encoding is fully decoded to
+     *  check that it holds exactly N elements, unless skip_decode_check is set because it comes
+     *  from a trusted source such as the block filter index. */
+    GCSFilter(const Params& params, std::vector<unsigned char> encoded_filter, bool skip_decode_check = false);
 
     /** Builds a new filter from the params and set of elements. */
     GCSFilter(const Params& params, const ElementSet& elements);
@@ -122,7 +124,7 @@ public:
 
     //! Reconstruct a BlockFilter from parts.
     BlockFilter(BlockFilterType filter_type, const uint256& block_hash,
-                std::vector<unsigned char> filter);
+                std::vector<unsigned char> filter, bool skip_decode_check = false);
 
     //! Construct a new BlockFilter of the specified type from a block.
     BlockFilter(BlockFilterType filter_type, const CBlock& block, const CBlockUndo& block_undo);
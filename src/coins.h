@@ -18,7 +18,9 @@
 #include <stdint.h>
 
 #include <functional>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 /**
  * A UTXO entry.
@@ -182,6 +184,11 @@ public:
     //! Get a cursor to iterate over the whole state
     virtual CCoinsViewCursor *Cursor() const;
 
+    //! Get up to n cursors over disjoint key ranges which together cover the
+    //! whole state, all reading the same snapshot of it, so that the state can
+    //! be scanned from several threads. Returns no cursors if not supported.
+    virtual std::vector<std::unique_ptr<CCoinsViewCursor>> PartitionedCursors(size_t n) const;
+
     //! As we use CCoinsViews polymorphically, have a virtual destructor
     virtual ~CCoinsView() {}
 
@@ -205,6 +212,7 @@ public:
     void SetBackend(CCoinsView &viewIn);
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> PartitionedCursors(size_t n) const override;
     size_t EstimateSize() const override;
 };
 
@@ -240,6 +248,9 @@ public:
     CCoinsViewCursor* Cursor() const override {
         throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
     }
+    std::vector<std::unique_ptr<CCoinsViewCursor>> PartitionedCursors(size_t n) const override {
+        throw std::logic_error("CCoinsViewCache cursor iteration not supported.");
+    }
 
     /**
      * Check if we have the given utxo already loaded in this cache.
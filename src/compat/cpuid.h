@@ -10,6 +10,8 @@
 
 #include <cpuid.h>
 
+#include <cstdint>
+
 // We can't use cpuid.h's __get_cpuid as it does not support subleafs.
 void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32_t& b, uint32_t& c, uint32_t& d)
 {
@@ -20,5 +22,48 @@ void static inline GetCPUID(uint32_t leaf, uint32_t subleaf, uint32_t& a, uint32
 #endif
 }
 
+/** Read XCR0, the set of register states the OS saves. Only valid if CPUID reports OSXSAVE. */
+uint64_t static inline GetXCR0()
+{
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (uint64_t{d} << 32) | a;
+}
+
+/** The instruction set extensions the SIMD crypto backends choose from. */
+struct X86Features {
+    bool sse4{false};
+    bool shani{false};
+    //! AVX, with its YMM registers enabled by the OS
+    bool avx{false};
+    //! AVX2, and usable AVX
+    bool avx2{false};
+    //! AVX512F and AVX512BW, with the opmask and ZMM registers enabled by the OS
+    bool avx512{false};
+};
+
+/** Detect which of the X86Features this CPU and OS support. */
+X86Features static inline GetX86Features()
+{
+    X86Features ret;
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(0, 0, eax, ebx, ecx, edx);
+    const uint32_t max_leaf = eax;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    ret.sse4 = (ecx >> 19) & 1;
+    const bool have_xsave = (ecx >> 27) & 1;
+    const bool have_avx = (ecx >> 28) & 1;
+    const uint64_t xcr0 = have_xsave ? GetXCR0() : 0;
+    ret.avx = have_avx && (xcr0 & 0x6) == 0x6;
+    if (max_leaf >= 7) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        ret.avx2 = ret.avx && ((ebx >> 5) & 1);
+        ret.shani = (ebx >> 29) & 1;
+        // AVX512F, and AVX512BW for the byte shuffles.
+        ret.avx512 = ret.avx && ((ebx >> 16) & 1) && ((ebx >> 30) & 1) && (xcr0 & 0xE6) == 0xE6;
+    }
+    return ret;
+}
+
 #endif // defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
 #endif // chymera_COMPAT_CPUID_H
@@ -6,6 +6,7 @@
 #include <index/base.h>
 #include <node/blockstorage.h>
 #include <node/ui_interface.h>
+#include <primitives/block_view.h>
 #include <shutdown.h>
 #include <tinyformat.h>
 #include <util/thread.h>
@@ -13,6 +14,8 @@
 #include <validation.h> // For g_chainman
 #include <warnings.h>
 
+#include <optional>
+
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr int64_t SYNC_LOG_INTERVAL = 30; // seconds
@@ -129,6 +132,8 @@ void BaseIndex::ThreadSync()
 
         int64_t last_log_time = 0;
         int64_t last_locator_write_time = 0;
+        // Reused across blocks by indexes that allow block views.
+        std::vector<uint8_t> block_data;
         while (true) {
             if (m_interrupt) {
                 m_best_block_index = pindex;
@@ -171,6 +176,21 @@ void BaseIndex::ThreadSync()
                 Commit();
             }
 
+            if (AllowsBlockView()) {
+                std::optional<CBlockView> block;
+                if (!ReadBlockViewFromDisk(block_data, block, pindex, Params())) {
+                    FatalError("%s: Failed to read block %s from disk",
+                               __func__, pindex->GetBlockHash().ToString());
+                    return;
+                }
+                if (!WriteBlockView(*block, pindex)) {
+                    FatalError("%s: Failed to write block %s to index database",
+                               __func__, pindex->GetBlockHash().ToString());
+                    return;
+                }
+                continue;
+            }
+
             CBlock block;
             if (!ReadBlockFromDisk(block, pindex, consensus_params)) {
                 FatalError("%s: Failed to read block %s from disk",
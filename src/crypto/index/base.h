@@ -12,6 +12,7 @@
 #include <validationinterface.h>
 
 class CBlockIndex;
+class CBlockView;
 class CChainState;
 
 struct IndexSummary {
@@ -91,6 +92,13 @@ protected:
     /// Write update index entries for a newly connected block.
     virtual bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) { return true; }
 
+    /// Whether the index can be built from blocks that are not deserialized.
+    /// If so, the initial sync calls WriteBlockView instead of WriteBlock.
+    virtual bool AllowsBlockView() const { return false; }
+
+    /// Write update index entries for a block read from disk during the initial sync.
+    virtual bool WriteBlockView(const CBlockView& block, const CBlockIndex* pindex) { return true; }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CommitInternal(CDBBatch& batch);
@@ -2,8 +2,11 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
 #include <map>
+#include <optional>
 
+#include <checkqueue.h>
 #include <dbwrapper.h>
 #include <index/blockfilterindex.h>
 #include <node/blockstorage.h>
@@ -37,6 +40,15 @@ constexpr unsigned int FLTR_FILE_CHUNK_SIZE = cx100000; // 1 MiB
  *  is big enough for a 2,000,000 length block chain, which
  *  we should be enough until ~2047. */
 constexpr size_t CF_HEADERS_CACHE_MAX_SZ{2000};
+/** Number of filters read from disk at a time by MatchFilterRange. */
+constexpr int MATCH_FILTER_BATCH_SIZE{1000};
+/** Number of filters a worker of MatchFilterRange takes from the queue at a time. */
+constexpr unsigned int MATCH_FILTER_CHECK_BATCH_SIZE{16};
+/** Number of most recent blocks whose index entries are kept in memory (about 5 MiB). This
+ *  covers the ranges light clients sync from with cfheaders and cfilters. */
+constexpr int RANGE_CACHE_MAX_HEIGHTS{50000};
+/** Maximum total size of the encoded filters held in the LRU filter cache. */
+constexpr size_t FILTER_CACHE_MAX_BYTES{16 << 20};
 
 namespace {
 
@@ -91,6 +103,9 @@ struct DBHashKey {
 
 static std::map<BlockFilterType, BlockFilterIndex> g_filter_indexes;
 
+static bool LookupRange(CDBWrapper& db, const std::string& index_name, int start_height,
+                        const CBlockIndex* stop_index, std::vector<DBVal>& results);
+
 BlockFilterIndex::BlockFilterIndex(BlockFilterType filter_type,
                                    size_t n_cache_size, bool f_memory, bool f_wipe)
     : m_filter_type(filter_type)
@@ -121,7 +136,30 @@ bool BlockFilterIndex::Init()
         m_next_filter_pos.nFile = 0;
         m_next_filter_pos.nPos = 0;
     }
-    return BaseIndex::Init();
+    if (!BaseIndex::Init()) {
+        return false;
+    }
+
+    // Warm the range cache with the most recent blocks of the indexed chain.
+    const CBlockIndex* best_block_index = CurrentIndex();
+    if (best_block_index) {
+        const int start_height = std::max(0, best_block_index->nHeight - RANGE_CACHE_MAX_HEIGHTS + 1);
+        std::vector<DBVal> entries;
+        if (LookupRange(*m_db, m_name, start_height, best_block_index, entries)) {
+            std::deque<RangeCacheEntry> range_cache(entries.size());
+            for (const CBlockIndex* block_index = best_block_index;
+                 block_index && block_index->nHeight >= start_height;
+                 block_index = block_index->pprev) {
+                const DBVal& entry = entries[block_index->nHeight - start_height];
+                range_cache[block_index->nHeight - start_height] = {block_index->GetBlockHash(), entry.hash, entry.header, entry.pos};
+            }
+
+            LOCK(m_cs_range_cache);
+            m_range_cache = std::move(range_cache);
+            m_range_cache_start = start_height;
+        }
+    }
+    return true;
 }
 
 bool BlockFilterIndex::CommitInternal(CDBBatch& batch)
@@ -141,6 +179,40 @@ bool BlockFilterIndex::CommitInternal(CDBBatch& batch)
     return BaseIndex::CommitInternal(batch);
 }
 
+bool BlockFilterIndex::ReadFiltersFromDisk(const std::vector<FlatFilePos>& positions, std::vector<BlockFilter>& filters_out) const
+{
+    filters_out.resize(positions.size());
+
+    // Filters of consecutive blocks are stored back to back, so a range is usually a single
+    // sequential read through one file.
+    std::optional<CAutoFile> filein;
+    int current_file = -1;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const FlatFilePos& pos = positions[i];
+        if (pos.nFile != current_file) {
+            filein.emplace(m_filter_fileseq->Open(pos, true), SER_DISK, CLIENT_VERSION);
+            if (filein->IsNull()) {
+                return false;
+            }
+            current_file = pos.nFile;
+        } else if (ftell(filein->Get()) != static_cast<long>(pos.nPos) && fseek(filein->Get(), pos.nPos, SEEK_SET)) {
+            return error("%s: fseek(...) failed in filter file %d", __func__, pos.nFile);
+        }
+
+        uint256 block_hash;
+        std::vector<uint8_t> encoded_filter;
+        try {
+            *filein >> block_hash >> encoded_filter;
+            filters_out[i] = BlockFilter(GetFilterType(), block_hash, std::move(encoded_filter), /* skip_decode_check */ true);
+        }
+        catch (const std::exception& e) {
+            return error("%s: Failed to deserialize block filter from disk: %s", __func__, e.what());
+        }
+    }
+
+    return true;
+}
+
 bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos& pos, BlockFilter& filter) const
 {
     CAutoFile filein(m_filter_fileseq->Open(pos, true), SER_DISK, CLIENT_VERSION);
@@ -152,7 +224,8 @@ bool BlockFilterIndex::ReadFilterFromDisk(const FlatFilePos& pos, BlockFilter& f
     std::vector<uint8_t> encoded_filter;
     try {
         filein >> block_hash >> encoded_filter;
-        filter = BlockFilter(GetFilterType(), block_hash, std::move(encoded_filter));
+        // The filter was validated when it was written, so skip the full decode.
+        filter = BlockFilter(GetFilterType(), block_hash, std::move(encoded_filter), /* skip_decode_check */ true);
     }
     catch (const std::exception& e) {
         return error("%s: Failed to deserialize block filter from disk: %s", __func__, e.what());
@@ -246,10 +319,84 @@ bool BlockFilterIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex
         return false;
     }
 
+    AddToRangeCache(pindex, {value.first, value.second.hash, value.second.header, value.second.pos});
+
     m_next_filter_pos.nPos += bytes_written;
     return true;
 }
 
+void BlockFilterIndex::AddToRangeCache(const CBlockIndex* pindex, const RangeCacheEntry& entry)
+{
+    LOCK(m_cs_range_cache);
+
+    // The cache always holds a contiguous piece of the indexed chain. Start over if the new block
+    // does not extend it.
+    if (m_range_cache.empty() ||
+        pindex->nHeight != m_range_cache_start + static_cast<int>(m_range_cache.size()) ||
+        m_range_cache.back().block_hash != pindex->pprev->GetBlockHash()) {
+        m_range_cache.clear();
+        m_range_cache_start = pindex->nHeight;
+    }
+
+    m_range_cache.push_back(entry);
+    while (m_range_cache.size() > static_cast<size_t>(RANGE_CACHE_MAX_HEIGHTS)) {
+        m_range_cache.pop_front();
+        ++m_range_cache_start;
+    }
+}
+
+bool BlockFilterIndex::LookupRangeCache(int start_height, const CBlockIndex* stop_index,
+                                        std::vector<RangeCacheEntry>& entries_out) const
+{
+    if (start_height < 0 || start_height > stop_index->nHeight) return false;
+
+    LOCK(m_cs_range_cache);
+    const int end_height = m_range_cache_start + static_cast<int>(m_range_cache.size());
+    if (start_height < m_range_cache_start || stop_index->nHeight >= end_height) {
+        return false;
+    }
+
+    // Since the cache is a contiguous chain, a matching stop block means every block below it
+    // matches as well.
+    const auto stop_it = m_range_cache.begin() + (stop_index->nHeight - m_range_cache_start);
+    if (stop_it->block_hash != stop_index->GetBlockHash()) {
+        return false;
+    }
+
+    entries_out.assign(m_range_cache.begin() + (start_height - m_range_cache_start), stop_it + 1);
+    return true;
+}
+
+bool BlockFilterIndex::LookupFilterCache(const uint256& block_hash, BlockFilter& filter_out) const
+{
+    LOCK(m_cs_filter_cache);
+    auto it = m_filter_cache_map.find(block_hash);
+    if (it == m_filter_cache_map.end()) {
+        return false;
+    }
+    m_filter_cache.splice(m_filter_cache.begin(), m_filter_cache, it->second);
+    filter_out = *it->second;
+    return true;
+}
+
+void BlockFilterIndex::AddToFilterCache(const BlockFilter& filter) const
+{
+    LOCK(m_cs_filter_cache);
+    if (m_filter_cache_map.count(filter.GetBlockHash())) {
+        return;
+    }
+    m_filter_cache.push_front(filter);
+    m_filter_cache_map.emplace(filter.GetBlockHash(), m_filter_cache.begin());
+    m_filter_cache_bytes += filter.GetEncodedFilter().size();
+
+    while (m_filter_cache_bytes > FILTER_CACHE_MAX_BYTES && m_filter_cache.size() > 1) {
+        const BlockFilter& evicted = m_filter_cache.back();
+        m_filter_cache_bytes -= evicted.GetEncodedFilter().size();
+        m_filter_cache_map.erase(evicted.GetBlockHash());
+        m_filter_cache.pop_back();
+    }
+}
+
 static bool CopyHeightIndexToHashIndex(CDBIterator& db_it, CDBBatch& batch,
                                        const std::string& index_name,
                                        int start_height, int stop_height)
@@ -296,6 +443,17 @@ bool BlockFilterIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex*
     batch.Write(DB_FILTER_POS, m_next_filter_pos);
     if (!m_db->WriteBatch(batch)) return false;
 
+    {
+        // Drop the cached entries of the disconnected blocks.
+        LOCK(m_cs_range_cache);
+        const int keep = new_tip->nHeight - m_range_cache_start + 1;
+        if (keep <= 0) {
+            m_range_cache.clear();
+        } else if (static_cast<size_t>(keep) < m_range_cache.size()) {
+            m_range_cache.resize(keep);
+        }
+    }
+
     return BaseIndex::Rewind(current_tip, new_tip);
 }
 
@@ -374,12 +532,27 @@ static bool LookupRange(CDBWrapper& db, const std::string& index_name, int start
 
 bool BlockFilterIndex::LookupFilter(const CBlockIndex* block_index, BlockFilter& filter_out) const
 {
-    DBVal entry;
-    if (!LookupOne(*m_db, block_index, entry)) {
-        return false;
+    if (LookupFilterCache(block_index->GetBlockHash(), filter_out)) {
+        return true;
+    }
+
+    FlatFilePos pos;
+    std::vector<RangeCacheEntry> cached;
+    if (LookupRangeCache(block_index->nHeight, block_index, cached)) {
+        pos = cached.front().pos;
+    } else {
+        DBVal entry;
+        if (!LookupOne(*m_db, block_index, entry)) {
+            return false;
+        }
+        pos = entry.pos;
     }
 
-    return ReadFilterFromDisk(entry.pos, filter_out);
+    if (!ReadFilterFromDisk(pos, filter_out)) {
+        return false;
+    }
+    AddToFilterCache(filter_out);
+    return true;
 }
 
 bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint256& header_out)
@@ -398,7 +571,10 @@ bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint25
     }
 
     DBVal entry;
-    if (!LookupOne(*m_db, block_index, entry)) {
+    std::vector<RangeCacheEntry> cached;
+    if (LookupRangeCache(block_index->nHeight, block_index, cached)) {
+        entry.header = cached.front().header;
+    } else if (!LookupOne(*m_db, block_index, entry)) {
         return false;
     }
 
@@ -412,36 +588,87 @@ bool BlockFilterIndex::LookupFilterHeader(const CBlockIndex* block_index, uint25
     return true;
 }
 
-bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex* stop_index,
-                                         std::vector<BlockFilter>& filters_out) const
+bool BlockFilterIndex::ReadFilterRange(int start_height, const CBlockIndex* stop_index,
+                                       std::vector<BlockFilter>& filters_out, bool use_filter_cache) const
 {
-    std::vector<DBVal> entries;
-    if (!LookupRange(*m_db, m_name, start_height, stop_index, entries)) {
-        return false;
+    std::vector<FlatFilePos> positions;
+    std::vector<RangeCacheEntry> cached;
+    if (LookupRangeCache(start_height, stop_index, cached)) {
+        positions.reserve(cached.size());
+        for (const auto& entry : cached) {
+            positions.push_back(entry.pos);
+        }
+    } else {
+        std::vector<DBVal> entries;
+        if (!LookupRange(*m_db, m_name, start_height, stop_index, entries)) {
+            return false;
+        }
+        positions.reserve(entries.size());
+        for (const auto& entry : entries) {
+            positions.push_back(entry.pos);
+        }
     }
 
-    filters_out.resize(entries.size());
-    auto filter_pos_it = filters_out.begin();
-    for (const auto& entry : entries) {
-        if (!ReadFilterFromDisk(entry.pos, *filter_pos_it)) {
-            return false;
+    if (!use_filter_cache) {
+        return ReadFiltersFromDisk(positions, filters_out);
+    }
+
+    // Serve what we can from the filter cache and read the rest from disk in one pass.
+    filters_out.resize(positions.size());
+    std::vector<size_t> missing;
+    const CBlockIndex* block_index = stop_index;
+    for (size_t i = positions.size(); i-- > 0; block_index = block_index->pprev) {
+        if (!LookupFilterCache(block_index->GetBlockHash(), filters_out[i])) {
+            missing.push_back(i);
         }
-        ++filter_pos_it;
+    }
+    if (missing.empty()) return true;
+
+    std::reverse(missing.begin(), missing.end());
+    std::vector<FlatFilePos> missing_positions;
+    missing_positions.reserve(missing.size());
+    for (size_t i : missing) {
+        missing_positions.push_back(positions[i]);
+    }
+
+    std::vector<BlockFilter> filters;
+    if (!ReadFiltersFromDisk(missing_positions, filters)) {
+        return false;
+    }
+    for (size_t i = 0; i < missing.size(); ++i) {
+        AddToFilterCache(filters[i]);
+        filters_out[missing[i]] = std::move(filters[i]);
     }
 
     return true;
 }
 
+bool BlockFilterIndex::LookupFilterRange(int start_height, const CBlockIndex* stop_index,
+                                         std::vector<BlockFilter>& filters_out) const
+{
+    return ReadFilterRange(start_height, stop_index, filters_out, /* use_filter_cache */ true);
+}
+
 bool BlockFilterIndex::LookupFilterHashRange(int start_height, const CBlockIndex* stop_index,
                                              std::vector<uint256>& hashes_out) const
 
 {
+    hashes_out.clear();
+
+    std::vector<RangeCacheEntry> cached;
+    if (LookupRangeCache(start_height, stop_index, cached)) {
+        hashes_out.reserve(cached.size());
+        for (const auto& entry : cached) {
+            hashes_out.push_back(entry.filter_hash);
+        }
+        return true;
+    }
+
     std::vector<DBVal> entries;
     if (!LookupRange(*m_db, m_name, start_height, stop_index, entries)) {
         return false;
     }
 
-    hashes_out.clear();
     hashes_out.reserve(entries.size());
     for (const auto& entry : entries) {
         hashes_out.push_back(entry.hash);
@@ -449,6 +676,98 @@ bool BlockFilterIndex::LookupFilterHashRange(int start_height, const CBlockIndex
     return true;
 }
 
+/** Matches a set of elements against one filter, on the worker threads of MatchFilterRange. */
+class FilterMatchCheck
+{
+private:
+    const BlockFilter* m_filter{nullptr};
+    const GCSFilter::ElementSet* m_elements{nullptr};
+    char* m_match{nullptr};
+
+public:
+    FilterMatchCheck() = default;
+    FilterMatchCheck(const BlockFilter& filter, const GCSFilter::ElementSet& elements, char& match)
+        : m_filter(&filter), m_elements(&elements), m_match(&match) {}
+
+    bool operator()()
+    {
+        // Filters read for matching are not decoded up front, so corruption shows up here.
+        try {
+            *m_match = m_filter->GetFilter().MatchAny(*m_elements);
+            return true;
+        } catch (const std::exception& e) {
+            LogPrintf("%s: Failed to decode filter of block %s: %s\n",
+                      __func__, m_filter->GetBlockHash().ToString(), e.what());
+            return false;
+        }
+    }
+
+    void swap(FilterMatchCheck& check)
+    {
+        std::swap(m_filter, check.m_filter);
+        std::swap(m_elements, check.m_elements);
+        std::swap(m_match, check.m_match);
+    }
+};
+
+BlockFilterIndex::~BlockFilterIndex()
+{
+    LOCK(m_cs_match_queue);
+    if (m_match_queue) m_match_queue->StopWorkerThreads();
+}
+
+CCheckQueue<FilterMatchCheck>& BlockFilterIndex::GetMatchQueue() const
+{
+    LOCK(m_cs_match_queue);
+    if (!m_match_queue) {
+        m_match_queue = std::make_unique<CCheckQueue<FilterMatchCheck>>(MATCH_FILTER_CHECK_BATCH_SIZE);
+        // The thread calling MatchFilterRange does its share of the work.
+        m_match_queue->StartWorkerThreads(std::clamp(GetNumCores(), 1, MAX_MATCH_FILTER_THREADS) - 1, "fltrmatch");
+    }
+    return *m_match_queue;
+}
+
+bool BlockFilterIndex::MatchFilterRange(int start_height, const CBlockIndex* stop_index,
+                                        const GCSFilter::ElementSet& elements,
+                                        std::vector<int>& heights_out) const
+{
+    if (start_height < 0 || start_height > stop_index->nHeight) {
+        return error("%s: invalid start height (%d) for stop height (%d)",
+                     __func__, start_height, stop_index->nHeight);
+    }
+
+    heights_out.clear();
+    if (elements.empty()) return true;
+
+    CCheckQueue<FilterMatchCheck>& queue = GetMatchQueue();
+    std::vector<BlockFilter> filters;
+    std::vector<char> matches;
+    for (int batch_start = start_height; batch_start <= stop_index->nHeight; batch_start += MATCH_FILTER_BATCH_SIZE) {
+        const int batch_stop = std::min(batch_start + MATCH_FILTER_BATCH_SIZE - 1, stop_index->nHeight);
+        if (!ReadFilterRange(batch_start, stop_index->GetAncestor(batch_stop), filters, /* use_filter_cache */ false)) {
+            return false;
+        }
+
+        // Each filter is keyed by its own block hash, so the elements are hashed
+        // for every filter, on whichever worker takes it from the queue.
+        matches.assign(filters.size(), 0);
+        std::vector<FilterMatchCheck> checks;
+        checks.reserve(filters.size());
+        for (size_t i = 0; i < filters.size(); ++i) {
+            checks.emplace_back(filters[i], elements, matches[i]);
+        }
+        CCheckQueueControl<FilterMatchCheck> control(&queue);
+        control.Add(checks);
+        if (!control.Wait()) return false;
+
+        for (size_t i = 0; i < matches.size(); ++i) {
+            if (matches[i]) heights_out.push_back(batch_start + static_cast<int>(i));
+        }
+    }
+
+    return true;
+}
+
 BlockFilterIndex* GetBlockFilterIndex(BlockFilterType filter_type)
 {
     auto it = g_filter_indexes.find(filter_type);
@@ -11,9 +11,19 @@
 #include <index/base.h>
 #include <util/hasher.h>
 
+#include <deque>
+#include <list>
+
 /** Interval between compact filter checkpoints. See BIP 157. */
 static constexpr int CFCHECKPT_INTERVAL = 1000;
 
+/** Maximum number of threads MatchFilterRange decodes filters on. */
+static constexpr int MAX_MATCH_FILTER_THREADS{16};
+
+template <typename T>
+class CCheckQueue;
+class FilterMatchCheck;
+
 /**
  * BlockFilterIndex is used to store and retrieve block filters, hashes, and headers for a range of
  * blocks by height. An index is constructed for each supported filter type with its own database
@@ -38,6 +48,50 @@ private:
     /** cache of block hash to filter header, to avoid disk access when responding to getcfcheckpt. */
     std::unordered_map<uint256, uint256, FilterHeaderHasher> m_headers_cache GUARDED_BY(m_cs_headers_cache);
 
+    /** In-memory copy of the index entry of a block on the indexed chain. */
+    struct RangeCacheEntry {
+        uint256 block_hash;
+        uint256 filter_hash;
+        uint256 header;
+        FlatFilePos pos;
+    };
+
+    mutable Mutex m_cs_range_cache;
+    /** Entries of the most recent blocks of the indexed chain, by height starting at
+     *  m_range_cache_start, so that cfheaders and cfilters ranges are served from memory. */
+    std::deque<RangeCacheEntry> m_range_cache GUARDED_BY(m_cs_range_cache);
+    int m_range_cache_start GUARDED_BY(m_cs_range_cache){0};
+
+    mutable Mutex m_cs_filter_cache;
+    /** LRU cache of recently served filters, most recently used first. */
+    mutable std::list<BlockFilter> m_filter_cache GUARDED_BY(m_cs_filter_cache);
+    mutable std::unordered_map<uint256, std::list<BlockFilter>::iterator, FilterHeaderHasher> m_filter_cache_map GUARDED_BY(m_cs_filter_cache);
+    mutable size_t m_filter_cache_bytes GUARDED_BY(m_cs_filter_cache){0};
+
+    /** Append the entry of a newly indexed block to the range cache. */
+    void AddToRangeCache(const CBlockIndex* pindex, const RangeCacheEntry& entry);
+
+    /** Copy the cached entries for a range of the chain ending at stop_index, if all are cached. */
+    bool LookupRangeCache(int start_height, const CBlockIndex* stop_index,
+                          std::vector<RangeCacheEntry>& entries_out) const;
+
+    bool LookupFilterCache(const uint256& block_hash, BlockFilter& filter_out) const;
+    void AddToFilterCache(const BlockFilter& filter) const;
+
+    /** Read filters at the given positions, opening each flat file once and reading it in order. */
+    bool ReadFiltersFromDisk(const std::vector<FlatFilePos>& positions, std::vector<BlockFilter>& filters_out) const;
+
+    /** Get a range of filters, optionally going through the LRU filter cache. Bulk scans skip the
+     *  cache so that they do not evict the filters light clients keep asking for. */
+    bool ReadFilterRange(int start_height, const CBlockIndex* stop_index,
+                         std::vector<BlockFilter>& filters_out, bool use_filter_cache) const;
+
+    mutable Mutex m_cs_match_queue;
+    /** Worker threads of MatchFilterRange, started on first use and kept for later calls. */
+    mutable std::unique_ptr<CCheckQueue<FilterMatchCheck>> m_match_queue GUARDED_BY(m_cs_match_queue);
+
+    CCheckQueue<FilterMatchCheck>& GetMatchQueue() const;
+
 protected:
     bool Init() override;
 
@@ -56,6 +110,9 @@ public:
     explicit BlockFilterIndex(BlockFilterType filter_type,
                               size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
 
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    ~BlockFilterIndex() override;
+
     BlockFilterType GetFilterType() const { return m_filter_type; }
 
     /** Get a single filter by block. */
@@ -71,6 +128,16 @@ public:
     /** Get a range of filter hashes between two heights on a chain. */
     bool LookupFilterHashRange(int start_height, const CBlockIndex* stop_index,
                                std::vector<uint256>& hashes_out) const;
+
+    /**
+     * Match a set of elements against the filters of a range of blocks on a chain. Filters are
+     * read in batches and decoded and matched on up to MAX_MATCH_FILTER_THREADS threads. The
+     * heights of blocks whose filter may contain any of the elements are returned in increasing
+     * order. Returns false if a filter cannot be read or decoded.
+     */
+    bool MatchFilterRange(int start_height, const CBlockIndex* stop_index,
+                          const GCSFilter::ElementSet& elements,
+                          std::vector<int>& heights_out) const;
 };
 
 /**
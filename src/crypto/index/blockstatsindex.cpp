@@ -0,0 +1,92 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/blockstatsindex.h>
+#include <node/blockstorage.h>
+#include <undo.h>
+#include <util/system.h>
+
+constexpr uint8_t DB_BLOCK_HEIGHT{'t'};
+
+std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+namespace {
+
+struct DBHeightKey {
+    int height;
+
+    explicit DBHeightKey(int height_in) : height(height_in) {}
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_BLOCK_HEIGHT);
+        ser_writedata32be(s, height);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_BLOCK_HEIGHT) {
+            throw std::ios_base::failure("Invalid format for blockstatsindex DB height key");
+        }
+        height = ser_readdata32be(s);
+    }
+};
+
+} // namespace
+
+/** Access to the block stats index database (indexes/blockstatsindex/) */
+class BlockStatsIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+BlockStatsIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "blockstatsindex", n_cache_size, f_memory, f_wipe)
+{}
+
+BlockStatsIndex::BlockStatsIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<BlockStatsIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+BlockStatsIndex::~BlockStatsIndex() {}
+
+bool BlockStatsIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis block has no undo data, and getblockstats does not report it.
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    std::pair<uint256, CBlockStats> value;
+    value.first = pindex->GetBlockHash();
+    if (!ComputeBlockStats(block, block_undo, value.second)) {
+        return error("%s: Undo data mismatch for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    // Entries of blocks disconnected since are overwritten here, which is why
+    // no Rewind() is needed: lookups check the hash.
+    return m_db->Write(DBHeightKey(pindex->nHeight), value);
+}
+
+BaseIndex::DB& BlockStatsIndex::GetDB() const { return *m_db; }
+
+bool BlockStatsIndex::LookUpStats(const CBlockIndex* block_index, CBlockStats& stats) const
+{
+    std::pair<uint256, CBlockStats> read_out;
+    if (!m_db->Read(DBHeightKey(block_index->nHeight), read_out)) {
+        return false;
+    }
+    if (read_out.first != block_index->GetBlockHash()) {
+        return false;
+    }
+    stats = std::move(read_out.second);
+    return true;
+}
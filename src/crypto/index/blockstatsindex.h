@@ -0,0 +1,52 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_INDEX_BLOCKSTATSINDEX_H
+#define chymera_INDEX_BLOCKSTATSINDEX_H
+
+#include <chain.h>
+#include <index/base.h>
+#include <node/blockstats.h>
+
+/**
+ * BlockStatsIndex keeps the statistics reported by getblockstats for every
+ * block of the active chain, keyed by height. They are computed once from the
+ * block and its undo data while syncing, so a request is a single lookup
+ * instead of reading and walking the block again.
+ */
+class BlockStatsIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "blockstatsindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit BlockStatsIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~BlockStatsIndex() override;
+
+    /// Look up the statistics of a block.
+    ///
+    /// @param[in]   block_index  The block, which need not be in the active chain.
+    /// @param[out]  stats  The statistics of the block.
+    /// @return  true if the block is indexed, false otherwise, as for blocks
+    ///          not yet synced or no longer in the indexed chain
+    bool LookUpStats(const CBlockIndex* block_index, CBlockStats& stats) const;
+};
+
+/// The global block stats index. May be null.
+extern std::unique_ptr<BlockStatsIndex> g_block_stats_index;
+
+#endif // chymera_INDEX_BLOCKSTATSINDEX_H
@@ -0,0 +1,140 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/prevoutindex.h>
+#include <node/blockstorage.h>
+#include <util/system.h>
+#include <validation.h>
+
+constexpr uint8_t DB_PREVOUT{'p'};
+
+std::unique_ptr<PrevoutIndex> g_prevout_index;
+
+namespace {
+
+struct DBVal {
+    uint256 spending_txid;
+    Coin coin;
+
+    SERIALIZE_METHODS(DBVal, obj)
+    {
+        READWRITE(obj.spending_txid);
+        READWRITE(obj.coin);
+    }
+};
+
+} // namespace
+
+/** Access to the prevout index database (indexes/prevoutindex/) */
+class PrevoutIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    /// Read the spender and spent output of the given outpoint. Returns false
+    /// if the outpoint is not indexed as spent.
+    bool ReadPrevout(const COutPoint& outpoint, DBVal& value) const;
+};
+
+PrevoutIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "prevoutindex", n_cache_size, f_memory, f_wipe)
+{}
+
+bool PrevoutIndex::DB::ReadPrevout(const COutPoint& outpoint, DBVal& value) const
+{
+    return Read(std::make_pair(DB_PREVOUT, outpoint), value);
+}
+
+PrevoutIndex::PrevoutIndex(size_t n_cache_size, bool f_memory, bool f_wipe)
+    : m_db(std::make_unique<PrevoutIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+PrevoutIndex::~PrevoutIndex() {}
+
+bool PrevoutIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
+{
+    // The genesis block has no undo data and spends nothing.
+    if (pindex->nHeight == 0) return true;
+
+    CBlockUndo block_undo;
+    if (!UndoReadFromDisk(block_undo, pindex)) {
+        return error("%s: Failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+    if (block_undo.vtxundo.size() + 1 != block.vtx.size()) {
+        return error("%s: Undo data mismatch for block %s", __func__, pindex->GetBlockHash().ToString());
+    }
+
+    CDBBatch batch(*m_db);
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        const CTransaction& tx = *block.vtx[i];
+        const CTxUndo& tx_undo = block_undo.vtxundo[i - 1];
+        for (size_t j = 0; j < tx.vin.size(); ++j) {
+            batch.Write(std::make_pair(DB_PREVOUT, tx.vin[j].prevout), DBVal{tx.GetHash(), tx_undo.vprevout[j]});
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool PrevoutIndex::EraseBlock(const CBlock& block)
+{
+    CDBBatch batch(*m_db);
+    for (size_t i = 1; i < block.vtx.size(); ++i) {
+        for (const CTxIn& txin : block.vtx[i]->vin) {
+            batch.Erase(std::make_pair(DB_PREVOUT, txin.prevout));
+        }
+    }
+    return m_db->WriteBatch(batch);
+}
+
+bool PrevoutIndex::Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip)
+{
+    assert(current_tip->GetAncestor(new_tip->nHeight) == new_tip);
+
+    // Outpoints spent by the disconnected blocks become unspent again, so
+    // their entries must be removed before the best block is moved back.
+    const auto& consensus_params{Params().GetConsensus()};
+    for (const CBlockIndex* iter_tip = current_tip; iter_tip != new_tip; iter_tip = iter_tip->pprev) {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, iter_tip, consensus_params)) {
+            return error("%s: Failed to read block %s from disk",
+                         __func__, iter_tip->GetBlockHash().ToString());
+        }
+        if (!EraseBlock(block)) {
+            return error("%s: Failed to erase entries of block %s",
+                         __func__, iter_tip->GetBlockHash().ToString());
+        }
+    }
+
+    return BaseIndex::Rewind(current_tip, new_tip);
+}
+
+BaseIndex::DB& PrevoutIndex::GetDB() const { return *m_db; }
+
+bool PrevoutIndex::FindSpender(const COutPoint& outpoint, uint256& spending_txid, Coin& coin) const
+{
+    DBVal value;
+    if (!m_db->ReadPrevout(outpoint, value)) {
+        return false;
+    }
+    spending_txid = value.spending_txid;
+    coin = std::move(value.coin);
+    return true;
+}
+
+bool PrevoutIndex::FindPrevouts(const CTransaction& tx, CTxUndo& txundo) const
+{
+    if (tx.IsCoinBase()) return false;
+
+    txundo.vprevout.clear();
+    txundo.vprevout.reserve(tx.vin.size());
+    for (const CTxIn& txin : tx.vin) {
+        DBVal value;
+        if (!m_db->ReadPrevout(txin.prevout, value) || value.spending_txid != tx.GetHash()) {
+            return false;
+        }
+        txundo.vprevout.emplace_back(std::move(value.coin));
+    }
+    return true;
+}
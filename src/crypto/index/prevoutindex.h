@@ -0,0 +1,65 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_INDEX_PREVOUTINDEX_H
+#define chymera_INDEX_PREVOUTINDEX_H
+
+#include <chain.h>
+#include <coins.h>
+#include <index/base.h>
+#include <undo.h>
+
+/**
+ * PrevoutIndex maps every spent outpoint to the transaction that spent it and
+ * to the output being spent (value, script, height and coinbase flag). It is
+ * populated from the block undo data while syncing, which lets input values
+ * and fees be reported without a txindex lookup per input.
+ */
+class PrevoutIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    /// Erase the entries written for a block that is being disconnected.
+    bool EraseBlock(const CBlock& block);
+
+protected:
+    bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
+
+    bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+    const char* GetName() const override { return "prevoutindex"; }
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit PrevoutIndex(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~PrevoutIndex() override;
+
+    /// Look up the spender of an outpoint.
+    ///
+    /// @param[in]   outpoint  The spent outpoint.
+    /// @param[out]  spending_txid  The txid of the transaction spending it.
+    /// @param[out]  coin  The output that was spent, with its height and coinbase flag.
+    /// @return  true if the outpoint is found to be spent, false otherwise
+    bool FindSpender(const COutPoint& outpoint, uint256& spending_txid, Coin& coin) const;
+
+    /// Reconstruct the undo data (the spent outputs) of a confirmed transaction.
+    ///
+    /// @param[in]   tx  A non-coinbase transaction included in the indexed chain.
+    /// @param[out]  txundo  The outputs spent by tx, in input order.
+    /// @return  true if every input of tx is found and spent by tx, false otherwise
+    bool FindPrevouts(const CTransaction& tx, CTxUndo& txundo) const;
+};
+
+/// The global prevout index. May be null.
+extern std::unique_ptr<PrevoutIndex> g_prevout_index;
+
+#endif // chymera_INDEX_PREVOUTINDEX_H
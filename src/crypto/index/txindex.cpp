@@ -6,11 +6,16 @@
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <node/ui_interface.h>
+#include <primitives/block_view.h>
 #include <shutdown.h>
 #include <util/system.h>
 #include <util/translation.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <numeric>
+#include <optional>
+
 constexpr uint8_t DB_BEST_BLOCK{'B'};
 constexpr uint8_t DB_TXINDEX{'t'};
 constexpr uint8_t DB_TXINDEX_BLOCK{'T'};
@@ -226,6 +231,23 @@ bool TxIndex::WriteBlock(const CBlock& block, const CBlockIndex* pindex)
     return m_db->WriteTxs(vPos);
 }
 
+bool TxIndex::WriteBlockView(const CBlockView& block, const CBlockIndex* pindex)
+{
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (pindex->nHeight == 0) return true;
+
+    const std::vector<CTransactionView>& vtx = block.Transactions();
+    const std::vector<uint256> txids = block.GetTxHashes();
+    // Transaction offsets are counted from the end of the block header.
+    const std::byte* const txs_begin = block.GetSerialization().data() + CBlockView::HEADER_SIZE;
+    std::vector<std::pair<uint256, CDiskTxPos>> vPos;
+    vPos.reserve(vtx.size());
+    for (size_t i = 0; i < vtx.size(); ++i) {
+        vPos.emplace_back(txids[i], CDiskTxPos(pindex->GetBlockPos(), vtx[i].GetSerialization().data() - txs_begin));
+    }
+    return m_db->WriteTxs(vPos);
+}
+
 BaseIndex::DB& TxIndex::GetDB() const { return *m_db; }
 
 bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const
@@ -255,3 +277,76 @@ bool TxIndex::FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRe
     block_hash = header.GetHash();
     return true;
 }
+
+size_t TxIndex::FindTxs(const std::vector<uint256>& tx_hashes, std::vector<uint256>& block_hashes, std::vector<CTransactionRef>& txs) const
+{
+    block_hashes.assign(tx_hashes.size(), uint256());
+    txs.assign(tx_hashes.size(), nullptr);
+
+    // Read the index entries in key order, which keeps LevelDB block cache
+    // hits high for large batches.
+    std::vector<size_t> order(tx_hashes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return tx_hashes[a] < tx_hashes[b]; });
+
+    std::vector<std::pair<CDiskTxPos, size_t>> positions;
+    positions.reserve(tx_hashes.size());
+    for (const size_t i : order) {
+        CDiskTxPos postx;
+        if (m_db->ReadTxPos(tx_hashes[i], postx)) {
+            positions.emplace_back(postx, i);
+        }
+    }
+
+    // Then read the transactions front to back through each block file.
+    std::sort(positions.begin(), positions.end(), [](const auto& a, const auto& b) {
+        return std::tie(a.first.nFile, a.first.nPos, a.first.nTxOffset) < std::tie(b.first.nFile, b.first.nPos, b.first.nTxOffset);
+    });
+
+    size_t found = 0;
+    std::optional<CAutoFile> file;
+    int current_file = -1;
+    unsigned int current_block_pos = 0;
+    uint256 current_block_hash;
+    for (const auto& [postx, i] : positions) {
+        try {
+            if (postx.nFile != current_file) {
+                file.emplace(OpenBlockFile(postx, true), SER_DISK, CLIENT_VERSION);
+                if (file->IsNull()) {
+                    error("%s: OpenBlockFile failed", __func__);
+                    current_file = -1;
+                    continue;
+                }
+                current_file = postx.nFile;
+                current_block_hash.SetNull();
+            }
+            if (current_block_hash.IsNull() || postx.nPos != current_block_pos) {
+                if (fseek(file->Get(), postx.nPos, SEEK_SET)) {
+                    error("%s: fseek(...) failed", __func__);
+                    continue;
+                }
+                CBlockHeader header;
+                *file >> header;
+                current_block_pos = postx.nPos;
+                current_block_hash = header.GetHash();
+            }
+            if (fseek(file->Get(), postx.nPos + ::GetSerializeSize(CBlockHeader(), CLIENT_VERSION) + postx.nTxOffset, SEEK_SET)) {
+                error("%s: fseek(...) failed", __func__);
+                continue;
+            }
+            CTransactionRef tx;
+            *file >> tx;
+            if (tx->GetHash() != tx_hashes[i]) {
+                error("%s: txid mismatch", __func__);
+                continue;
+            }
+            block_hashes[i] = current_block_hash;
+            txs[i] = std::move(tx);
+            ++found;
+        } catch (const std::exception& e) {
+            error("%s: Deserialize or I/O error - %s", __func__, e.what());
+            current_block_hash.SetNull();
+        }
+    }
+    return found;
+}
@@ -28,6 +28,12 @@ protected:
 
     bool WriteBlock(const CBlock& block, const CBlockIndex* pindex) override;
 
+    /// Only txids and offsets are indexed, so the initial sync does not
+    /// deserialize the blocks.
+    bool AllowsBlockView() const override { return true; }
+
+    bool WriteBlockView(const CBlockView& block, const CBlockIndex* pindex) override;
+
     BaseIndex::DB& GetDB() const override;
 
     const char* GetName() const override { return "txindex"; }
@@ -46,6 +52,16 @@ public:
     /// @param[out]  tx  The transaction itself.
     /// @return  true if transaction is found, false otherwise
     bool FindTx(const uint256& tx_hash, uint256& block_hash, CTransactionRef& tx) const;
+
+    /// Look up a batch of transactions by hash. Index entries are read in key
+    /// order, then the transactions are read in (file, offset) order so that
+    /// each block file is opened once and each block header is read once.
+    ///
+    /// @param[in]   tx_hashes  The hashes of the transactions to be returned.
+    /// @param[out]  block_hashes  For each hash, the hash of the block the transaction is found in.
+    /// @param[out]  txs  For each hash, the transaction itself, or nullptr if it is not found.
+    /// @return  the number of transactions found
+    size_t FindTxs(const std::vector<uint256>& tx_hashes, std::vector<uint256>& block_hashes, std::vector<CTransactionRef>& txs) const;
 };
 
 /// The global transaction index, used in GetTransaction. May be null.
@@ -59,6 +59,42 @@ inline void muln2(limb_t& c0, limb_t& c1, const limb_t& n)
     c1 = t;
 }
 
+#if defined(USE_ASM) && defined(HAVE___INT128) && (defined(__x86_64__) || defined(__amd64__))
+/** [c0,c1,c2] += a * b
+ *
+ * Keeping the multiply and the carry chain in one block lets the additions
+ * use adc directly instead of the compare-and-add sequences the compiler
+ * emits for the portable version below. This speeds up Multiply and Square
+ * by roughly a quarter, which dominates MuHash3072::Insert.
+ */
+inline void muladd3(limb_t& c0, limb_t& c1, limb_t& c2, const limb_t& a, const limb_t& b)
+{
+    limb_t tl, th;
+    __asm__ ("mulq %5\n"
+             "addq %%rax, %0\n"
+             "adcq %%rdx, %1\n"
+             "adcq $0, %2\n"
+             : "+r"(c0), "+r"(c1), "+r"(c2), "=&a"(tl), "=&d"(th)
+             : "rm"(b), "3"(a)
+             : "cc");
+}
+
+/** [c0,c1,c2] += 2 * a * b */
+inline void muldbladd3(limb_t& c0, limb_t& c1, limb_t& c2, const limb_t& a, const limb_t& b)
+{
+    limb_t tl, th;
+    __asm__ ("mulq %5\n"
+             "addq %%rax, %0\n"
+             "adcq %%rdx, %1\n"
+             "adcq $0, %2\n"
+             "addq %%rax, %0\n"
+             "adcq %%rdx, %1\n"
+             "adcq $0, %2\n"
+             : "+r"(c0), "+r"(c1), "+r"(c2), "=&a"(tl), "=&d"(th)
+             : "rm"(b), "3"(a)
+             : "cc");
+}
+#else
 /** [c0,c1,c2] += a * b */
 inline void muladd3(limb_t& c0, limb_t& c1, limb_t& c2, const limb_t& a, const limb_t& b)
 {
@@ -88,6 +124,7 @@ inline void muldbladd3(limb_t& c0, limb_t& c1, limb_t& c2, const limb_t& a, cons
     c1 += th;
     c2 += (c1 < th) ? 1 : 0;
 }
+#endif
 
 /**
  * Add limb a to [c0,c1]: [c0,c1] += a. Then extract the lowest
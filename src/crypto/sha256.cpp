@@ -5,11 +5,23 @@
 #include <crypto/sha256.h>
 #include <crypto/common.h>
 
+#include <algorithm>
 #include <assert.h>
 #include <string.h>
+#include <vector>
 
 #include <compat/cpuid.h>
 
+#if defined(__linux__) && defined(ENABLE_ARM_SHANI) && !defined(BUILD_chymera_INTERNAL)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+#if defined(MAC_OSX) && defined(ENABLE_ARM_SHANI) && !defined(BUILD_chymera_INTERNAL)
+#include <sys/types.h>
+#include <sys/sysctl.h>
+#endif
+
 #if defined(__x86_64__) || defined(__amd64__) || defined(__i386__)
 #if defined(USE_ASM)
 namespace sha256_sse4
@@ -39,6 +51,31 @@ namespace sha256_shani
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 }
 
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* const* chunks);
+}
+
+namespace sha256d64_avx512
+{
+void Transform_16way(unsigned char* out, const unsigned char* in);
+}
+
+namespace sha256_avx512
+{
+void Transform_16way(uint32_t* s, const unsigned char* const* chunks);
+}
+
+namespace sha256_arm_shani
+{
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
+}
+
+namespace sha256d64_arm_shani
+{
+void Transform_2way(unsigned char* out, const unsigned char* in);
+}
+
 // Internal implementation code.
 namespace
 {
@@ -461,6 +498,12 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformD64Type TransformD64_16way = nullptr;
+
+/** Transform one 64-byte chunk per lane, each lane with its own 8-word state (lane after lane in s). */
+typedef void (*TransformMultiType)(uint32_t* s, const unsigned char* const* chunks);
+TransformMultiType TransformMulti_8way = nullptr;
+TransformMultiType TransformMulti_16way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -544,18 +587,47 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformD64_16way, if available, on the 8 messages above twice over.
+    if (TransformD64_16way) {
+        unsigned char in[1024];
+        std::copy(data + 1, data + 513, in);
+        std::copy(data + 1, data + 513, in + 512);
+        unsigned char out[512];
+        TransformD64_16way(out, in);
+        if (!std::equal(out, out + 256, result_d64) || !std::equal(out + 256, out + 512, result_d64)) return false;
+    }
+
+    // Test TransformMulti_8way, if available: lane i continues from the state after i chunks.
+    if (TransformMulti_8way) {
+        uint32_t states[64];
+        const unsigned char* chunks[8];
+        for (int i = 0; i < 8; ++i) {
+            std::copy(result[i], result[i] + 8, states + 8 * i);
+            chunks[i] = data + 1 + 64 * i;
+        }
+        TransformMulti_8way(states, chunks);
+        for (int i = 0; i < 8; ++i) {
+            if (!std::equal(states + 8 * i, states + 8 * i + 8, result[i + 1])) return false;
+        }
+    }
+
+    // Test TransformMulti_16way, if available, the same way with lane i + 8 repeating lane i.
+    if (TransformMulti_16way) {
+        uint32_t states[128];
+        const unsigned char* chunks[16];
+        for (int i = 0; i < 16; ++i) {
+            std::copy(result[i % 8], result[i % 8] + 8, states + 8 * i);
+            chunks[i] = data + 1 + 64 * (i % 8);
+        }
+        TransformMulti_16way(states, chunks);
+        for (int i = 0; i < 16; ++i) {
+            if (!std::equal(states + 8 * i, states + 8 * i + 8, result[i % 8 + 1])) return false;
+        }
+    }
+
     return true;
 }
 
-#if defined(USE_ASM) && (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
-/** Check whether the OS has enabled AVX registers. */
-bool AVXEnabled()
-{
-    uint32_t a, d;
-    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
-    return (a & 6) == 6;
-}
-#endif
 } // namespace
 
 
@@ -563,34 +635,16 @@ std::string SHA256AutoDetect()
 {
     std::string ret = "standard";
 #if defined(USE_ASM) && defined(HAVE_GETCPUID)
-    bool have_sse4 = false;
-    bool have_xsave = false;
-    bool have_avx = false;
-    bool have_avx2 = false;
-    bool have_shani = false;
-    bool enabled_avx = false;
-
-    (void)AVXEnabled;
+    const X86Features features = GetX86Features();
+    bool have_sse4 = features.sse4;
+    bool have_avx2 = features.avx2;
+    const bool have_shani = features.shani;
+    const bool have_avx512 = features.avx512;
+
     (void)have_sse4;
-    (void)have_avx;
-    (void)have_xsave;
     (void)have_avx2;
     (void)have_shani;
-    (void)enabled_avx;
-
-    uint32_t eax, ebx, ecx, edx;
-    GetCPUID(1, 0, eax, ebx, ecx, edx);
-    have_sse4 = (ecx >> 19) & 1;
-    have_xsave = (ecx >> 27) & 1;
-    have_avx = (ecx >> 28) & 1;
-    if (have_xsave && have_avx) {
-        enabled_avx = AVXEnabled();
-    }
-    if (have_sse4) {
-        GetCPUID(7, 0, eax, ebx, ecx, edx);
-        have_avx2 = (ebx >> 5) & 1;
-        have_shani = (ebx >> 29) & 1;
-    }
+    (void)have_avx512;
 
 #if defined(ENABLE_SHANI) && !defined(BUILD_chymera_INTERNAL)
     if (have_shani) {
@@ -616,11 +670,54 @@ std::string SHA256AutoDetect()
     }
 
 #if defined(ENABLE_AVX2) && !defined(BUILD_chymera_INTERNAL)
-    if (have_avx2 && have_avx && enabled_avx) {
+    if (have_avx2) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256_avx2::Transform_8way;
         ret += ",avx2(8way)";
     }
 #endif
+
+#if defined(ENABLE_AVX512) && !defined(BUILD_chymera_INTERNAL)
+    // Unlike AVX2, the 16-way kernel outpaces SHA-NI on batches, so it is used
+    // alongside it for TransformD64 and the multi-buffer hasher.
+    if (have_avx512) {
+        TransformD64_16way = sha256d64_avx512::Transform_16way;
+        TransformMulti_16way = sha256_avx512::Transform_16way;
+        ret += ",avx512(16way)";
+    }
+#endif
+#endif
+
+#if defined(ENABLE_ARM_SHANI) && !defined(BUILD_chymera_INTERNAL)
+    bool have_arm_shani = false;
+
+#if defined(__linux__)
+#if defined(__arm__) // 32-bit
+    if (getauxval(AT_HWCAP2) & HWCAP2_SHA2) {
+        have_arm_shani = true;
+    }
+#endif
+#if defined(__aarch64__) // 64-bit
+    if (getauxval(AT_HWCAP) & HWCAP_SHA2) {
+        have_arm_shani = true;
+    }
+#endif
+#endif
+
+#if defined(MAC_OSX)
+    int val = 0;
+    size_t len = sizeof(val);
+    if (sysctlbyname("hw.optional.arm.FEAT_SHA256", &val, &len, nullptr, 0) == 0) {
+        have_arm_shani = val != 0;
+    }
+#endif
+
+    if (have_arm_shani) {
+        Transform = sha256_arm_shani::Transform;
+        TransformD64 = TransformD64Wrapper<sha256_arm_shani::Transform>;
+        TransformD64_2way = sha256d64_arm_shani::Transform_2way;
+        ret = "arm_shani(1way,2way)";
+    }
 #endif
 
     assert(SelfTest());
@@ -686,6 +783,14 @@ CSHA256& CSHA256::Reset()
 
 void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
 {
+    if (TransformD64_16way) {
+        while (blocks >= 16) {
+            TransformD64_16way(out, in);
+            out += 512;
+            in += 1024;
+            blocks -= 16;
+        }
+    }
     if (TransformD64_8way) {
         while (blocks >= 8) {
             TransformD64_8way(out, in);
@@ -717,3 +822,113 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+namespace {
+
+/** Progress of one message through a lane of the multi-buffer hasher. */
+struct MultiLane
+{
+    size_t msg;                  //!< index of the message being hashed
+    size_t block;                //!< index of the next block to process
+    size_t full_blocks;          //!< number of whole 64-byte blocks taken directly from the input
+    size_t total_blocks;         //!< full_blocks plus the one or two padded tail blocks
+    unsigned char tail[128];     //!< remaining input bytes followed by the padding
+
+    void Load(size_t index, const unsigned char* input, size_t len)
+    {
+        msg = index;
+        block = 0;
+        full_blocks = len / 64;
+        const size_t rem = len % 64;
+        total_blocks = full_blocks + (rem < 56 ? 1 : 2);
+        std::fill(tail, tail + sizeof(tail), 0);
+        if (rem) memcpy(tail, input + 64 * full_blocks, rem);
+        tail[rem] = 0x80;
+        WriteBE64(tail + 64 * (total_blocks - full_blocks) - 8, (uint64_t)len << 3);
+    }
+
+    const unsigned char* Chunk(const unsigned char* input) const
+    {
+        return block < full_blocks ? input + 64 * block : tail + 64 * (block - full_blocks);
+    }
+};
+
+void WriteState(unsigned char* out, const uint32_t* s)
+{
+    for (int i = 0; i < 8; ++i) WriteBE32(out + 4 * i, s[i]);
+}
+
+} // namespace
+
+void SHA256Multi(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count)
+{
+    const TransformMultiType transform_multi = TransformMulti_16way ? TransformMulti_16way : TransformMulti_8way;
+    const int n_lanes = TransformMulti_16way ? 16 : 8;
+    if (!transform_multi || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            CSHA256().Write(inputs[i], lengths[i]).Finalize(outputs[i]);
+        }
+        return;
+    }
+
+    uint32_t states[128];
+    MultiLane lanes[16];
+    bool active[16] = {false};
+    size_t next = 0;
+    int n_active = 0;
+    auto load = [&](int lane) {
+        if (next < count) {
+            lanes[lane].Load(next, inputs[next], lengths[next]);
+            sha256::Initialize(states + 8 * lane);
+            active[lane] = true;
+            ++n_active;
+            ++next;
+        }
+    };
+    for (int lane = 0; lane < n_lanes; ++lane) load(lane);
+
+    // Idle lanes hash a dummy chunk into their own, unused state.
+    static const unsigned char idle_chunk[64] = {0};
+    const unsigned char* chunks[16];
+    // Once the queue is drained and few lanes remain busy, the remaining
+    // (typically long) messages are cheaper to finish one at a time.
+    while (n_active > 0 && (next < count || 2 * n_active >= n_lanes)) {
+        for (int lane = 0; lane < n_lanes; ++lane) {
+            chunks[lane] = active[lane] ? lanes[lane].Chunk(inputs[lanes[lane].msg]) : idle_chunk;
+        }
+        transform_multi(states, chunks);
+        for (int lane = 0; lane < n_lanes; ++lane) {
+            if (!active[lane] || ++lanes[lane].block < lanes[lane].total_blocks) continue;
+            WriteState(outputs[lanes[lane].msg], states + 8 * lane);
+            active[lane] = false;
+            --n_active;
+            load(lane);
+        }
+    }
+
+    for (int lane = 0; lane < n_lanes; ++lane) {
+        if (!active[lane]) continue;
+        MultiLane& l = lanes[lane];
+        uint32_t* s = states + 8 * lane;
+        if (l.block < l.full_blocks) {
+            Transform(s, inputs[l.msg] + 64 * l.block, l.full_blocks - l.block);
+            l.block = l.full_blocks;
+        }
+        Transform(s, l.tail + 64 * (l.block - l.full_blocks), l.total_blocks - l.block);
+        WriteState(outputs[l.msg], s);
+    }
+}
+
+bool SHA256MultiAvailable()
+{
+    return TransformMulti_8way || TransformMulti_16way;
+}
+
+void SHA256DMulti(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count)
+{
+    SHA256Multi(outputs, inputs, lengths, count);
+    // The second pass hashes each 32-byte digest in place; every lane copies
+    // its message into its tail buffer before the digest is overwritten.
+    std::vector<size_t> digest_lengths(count, size_t{CSHA256::OUTPUT_SIZE});
+    SHA256Multi(outputs, outputs, digest_lengths.data(), count);
+}
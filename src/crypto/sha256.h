@@ -38,4 +38,19 @@ std::string SHA256AutoDetect();
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** Compute the SHA256 of several independent messages of any length.
+ *  Where a multi-lane implementation is available the messages are hashed in
+ *  lockstep, one per lane; otherwise they are hashed one after the other.
+ *  outputs: count pointers to 32-byte output buffers
+ *  inputs:  count pointers to the messages
+ *  lengths: count message lengths in bytes
+ */
+void SHA256Multi(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count);
+
+/** Like SHA256Multi, but computes double SHA256's. */
+void SHA256DMulti(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count);
+
+/** Whether SHA256Multi has a multi-lane implementation to hash messages in lockstep. */
+bool SHA256MultiAvailable();
+
 #endif // chymera_CRYPTO_SHA256_H
@@ -0,0 +1,149 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_ARM_SHANI
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <arm_acle.h>
+#include <arm_neon.h>
+
+namespace {
+alignas(uint32x4_t) static constexpr std::array<uint32_t, 64> K =
+{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+alignas(uint32x4_t) static constexpr std::array<uint32_t, 8> INIT =
+{
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+/** Load four big endian message words. */
+uint32x4_t inline Load(const unsigned char* p) { return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p))); }
+
+/** Store four words big endian. */
+void inline Store(unsigned char* p, uint32x4_t v) { vst1q_u8(p, vrev32q_u8(vreinterpretq_u8_u32(v))); }
+
+/**
+ * Run the 64 rounds of SHA-256 on N independent lanes in lockstep, so the
+ * latency of the SHA instructions of one lane is hidden behind the other.
+ * state0/state1 hold ABCD/EFGH of every lane and msg its 16 message words,
+ * which are consumed.
+ */
+template<int N>
+void inline __attribute__((always_inline)) Compress(uint32x4_t* state0, uint32x4_t* state1, uint32x4_t (*msg)[4])
+{
+    uint32x4_t abcd[N], efgh[N];
+    for (int l = 0; l < N; ++l) {
+        abcd[l] = state0[l];
+        efgh[l] = state1[l];
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        const uint32x4_t k = vld1q_u32(&K[4 * i]);
+        for (int l = 0; l < N; ++l) {
+            const uint32x4_t tmp = vaddq_u32(msg[l][i & 3], k);
+            if (i < 12) {
+                // Extend the schedule by the four words consumed four quad-rounds from now.
+                msg[l][i & 3] = vsha256su1q_u32(vsha256su0q_u32(msg[l][i & 3], msg[l][(i + 1) & 3]), msg[l][(i + 2) & 3], msg[l][(i + 3) & 3]);
+            }
+            const uint32x4_t prev = state0[l];
+            state0[l] = vsha256hq_u32(state0[l], state1[l], tmp);
+            state1[l] = vsha256h2q_u32(state1[l], prev, tmp);
+        }
+    }
+
+    for (int l = 0; l < N; ++l) {
+        state0[l] = vaddq_u32(state0[l], abcd[l]);
+        state1[l] = vaddq_u32(state1[l], efgh[l]);
+    }
+}
+}
+
+namespace sha256_arm_shani {
+void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks)
+{
+    uint32x4_t state0 = vld1q_u32(&s[0]);
+    uint32x4_t state1 = vld1q_u32(&s[4]);
+    uint32x4_t msg[1][4];
+
+    while (blocks--) {
+        msg[0][0] = Load(chunk);
+        msg[0][1] = Load(chunk + 16);
+        msg[0][2] = Load(chunk + 32);
+        msg[0][3] = Load(chunk + 48);
+        Compress<1>(&state0, &state1, msg);
+        chunk += 64;
+    }
+
+    vst1q_u32(&s[0], state0);
+    vst1q_u32(&s[4], state1);
+}
+}
+
+namespace sha256d64_arm_shani {
+void Transform_2way(unsigned char* output, const unsigned char* input)
+{
+    // The second block of a 64-byte message is its fixed padding; the
+    // second hash covers the 32-byte digest, padded, in a single block.
+    alignas(uint32x4_t) static constexpr std::array<uint32_t, 4> PAD_START = {0x80000000, 0, 0, 0};
+    alignas(uint32x4_t) static constexpr std::array<uint32_t, 4> PAD_LEN_512 = {0, 0, 0, 0x200};
+    alignas(uint32x4_t) static constexpr std::array<uint32_t, 4> PAD_LEN_256 = {0, 0, 0, 0x100};
+    const uint32x4_t zero = vdupq_n_u32(0);
+
+    uint32x4_t state0[2], state1[2], msg[2][4];
+
+    // Transform 1
+    for (int l = 0; l < 2; ++l) {
+        state0[l] = vld1q_u32(&INIT[0]);
+        state1[l] = vld1q_u32(&INIT[4]);
+        for (int i = 0; i < 4; ++i) msg[l][i] = Load(input + 64 * l + 16 * i);
+    }
+    Compress<2>(state0, state1, msg);
+
+    // Transform 2
+    for (int l = 0; l < 2; ++l) {
+        msg[l][0] = vld1q_u32(PAD_START.data());
+        msg[l][1] = zero;
+        msg[l][2] = zero;
+        msg[l][3] = vld1q_u32(PAD_LEN_512.data());
+    }
+    Compress<2>(state0, state1, msg);
+
+    // Transform 3
+    for (int l = 0; l < 2; ++l) {
+        msg[l][0] = state0[l];
+        msg[l][1] = state1[l];
+        msg[l][2] = vld1q_u32(PAD_START.data());
+        msg[l][3] = vld1q_u32(PAD_LEN_256.data());
+        state0[l] = vld1q_u32(&INIT[0]);
+        state1[l] = vld1q_u32(&INIT[4]);
+    }
+    Compress<2>(state0, state1, msg);
+
+    for (int l = 0; l < 2; ++l) {
+        Store(output + 32 * l, state0[l]);
+        Store(output + 32 * l + 16, state1[l]);
+    }
+}
+}
+
+#endif
@@ -0,0 +1,164 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX512
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+
+namespace sha256d64_avx512 {
+namespace {
+
+__m512i inline K(uint32_t x) { return _mm512_set1_epi32(x); }
+
+__m512i inline Add(__m512i x, __m512i y) { return _mm512_add_epi32(x, y); }
+__m512i inline Add(__m512i x, __m512i y, __m512i z) { return Add(Add(x, y), z); }
+__m512i inline Add(__m512i x, __m512i y, __m512i z, __m512i w) { return Add(Add(x, y), Add(z, w)); }
+__m512i inline Inc(__m512i& x, __m512i y, __m512i z, __m512i w) { x = Add(x, y, z, w); return x; }
+__m512i inline Xor(__m512i x, __m512i y, __m512i z) { return _mm512_ternarylogic_epi32(x, y, z, 0x96); }
+__m512i inline Ror(__m512i x, int n) { return _mm512_ror_epi32(x, n); }
+__m512i inline ShR(__m512i x, int n) { return _mm512_srli_epi32(x, n); }
+
+__m512i inline Ch(__m512i x, __m512i y, __m512i z) { return _mm512_ternarylogic_epi32(x, y, z, 0xCA); }
+__m512i inline Maj(__m512i x, __m512i y, __m512i z) { return _mm512_ternarylogic_epi32(x, y, z, 0xE8); }
+__m512i inline Sigma0(__m512i x) { return Xor(Ror(x, 2), Ror(x, 13), Ror(x, 22)); }
+__m512i inline Sigma1(__m512i x) { return Xor(Ror(x, 6), Ror(x, 11), Ror(x, 25)); }
+__m512i inline sigma0(__m512i x) { return Xor(Ror(x, 7), Ror(x, 18), ShR(x, 3)); }
+__m512i inline sigma1(__m512i x) { return Xor(Ror(x, 17), Ror(x, 19), ShR(x, 10)); }
+
+/** One round of SHA-256. */
+void inline __attribute__((always_inline)) Round(__m512i a, __m512i b, __m512i c, __m512i& d, __m512i e, __m512i f, __m512i g, __m512i& h, __m512i k)
+{
+    __m512i t1 = Add(h, Sigma1(e), Ch(e, f, g), k);
+    __m512i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+const uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+const uint32_t INITIAL_STATE[8] = {
+    0x6a09e667ul, 0xbb67ae85ul, 0x3c6ef372ul, 0xa54ff53aul, 0x510e527ful, 0x9b05688cul, 0x1f83d9abul, 0x5be0cd19ul,
+};
+
+/** Convert every 32-bit word between big and little endian. */
+__m512i inline ByteSwap(__m512i v)
+{
+    const __m512i mask = _mm512_set4_epi32(0x0C0D0E0FUL, 0x08090A0BUL, 0x04050607UL, 0x00010203UL);
+    return _mm512_shuffle_epi8(v, mask);
+}
+
+/** Run the 64 rounds over the message words w (which are consumed) and add the result into state. */
+void inline __attribute__((always_inline)) Compress(__m512i* state, __m512i* w)
+{
+    __m512i a = state[0], b = state[1], c = state[2], d = state[3];
+    __m512i e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; i += 8) {
+        if (i >= 16) {
+            for (int j = i; j < i + 8; ++j) {
+                Inc(w[j & 15], sigma1(w[(j + 14) & 15]), w[(j + 9) & 15], sigma0(w[(j + 1) & 15]));
+            }
+        }
+        Round(a, b, c, d, e, f, g, h, Add(K(ROUND_CONSTANTS[i + 0]), w[(i + 0) & 15]));
+        Round(h, a, b, c, d, e, f, g, Add(K(ROUND_CONSTANTS[i + 1]), w[(i + 1) & 15]));
+        Round(g, h, a, b, c, d, e, f, Add(K(ROUND_CONSTANTS[i + 2]), w[(i + 2) & 15]));
+        Round(f, g, h, a, b, c, d, e, Add(K(ROUND_CONSTANTS[i + 3]), w[(i + 3) & 15]));
+        Round(e, f, g, h, a, b, c, d, Add(K(ROUND_CONSTANTS[i + 4]), w[(i + 4) & 15]));
+        Round(d, e, f, g, h, a, b, c, Add(K(ROUND_CONSTANTS[i + 5]), w[(i + 5) & 15]));
+        Round(c, d, e, f, g, h, a, b, Add(K(ROUND_CONSTANTS[i + 6]), w[(i + 6) & 15]));
+        Round(b, c, d, e, f, g, h, a, Add(K(ROUND_CONSTANTS[i + 7]), w[(i + 7) & 15]));
+    }
+
+    state[0] = Add(state[0], a);
+    state[1] = Add(state[1], b);
+    state[2] = Add(state[2], c);
+    state[3] = Add(state[3], d);
+    state[4] = Add(state[4], e);
+    state[5] = Add(state[5], f);
+    state[6] = Add(state[6], g);
+    state[7] = Add(state[7], h);
+}
+
+}
+
+void Transform_16way(unsigned char* out, const unsigned char* in)
+{
+    // Word i of message j lives at in + 64 * j + 4 * i, and word i of its
+    // digest goes to out + 32 * j + 4 * i.
+    const __m512i in_offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), K(16));
+    const __m512i out_offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), K(8));
+
+    __m512i state[8], w[16];
+
+    // Transform 1: the 64-byte input of every lane.
+    for (int i = 0; i < 8; ++i) state[i] = K(INITIAL_STATE[i]);
+    for (int i = 0; i < 16; ++i) w[i] = ByteSwap(_mm512_i32gather_epi32(in_offsets, in + 4 * i, 4));
+    Compress(state, w);
+
+    // Transform 2: the padding block of a 64-byte message.
+    w[0] = K(0x80000000ul);
+    for (int i = 1; i < 15; ++i) w[i] = K(0);
+    w[15] = K(0x200ul);
+    Compress(state, w);
+
+    // Transform 3: the 32-byte digest, padded, hashed again.
+    for (int i = 0; i < 8; ++i) w[i] = state[i];
+    w[8] = K(0x80000000ul);
+    for (int i = 9; i < 15; ++i) w[i] = K(0);
+    w[15] = K(0x100ul);
+    for (int i = 0; i < 8; ++i) state[i] = K(INITIAL_STATE[i]);
+    Compress(state, w);
+
+    for (int i = 0; i < 8; ++i) {
+        _mm512_i32scatter_epi32(out + 4 * i, out_offsets, ByteSwap(state[i]), 4);
+    }
+}
+
+}
+
+namespace sha256_avx512 {
+using namespace sha256d64_avx512;
+
+void Transform_16way(uint32_t* s, const unsigned char* const* chunks)
+{
+    // s holds 16 states of 8 words each, lane after lane. Word j of every
+    // lane is gathered into one vector, lane i in element i.
+    const __m512i lane_offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), K(8));
+    __m512i state[8], w[16];
+    for (int j = 0; j < 8; ++j) {
+        state[j] = _mm512_i32gather_epi32(lane_offsets, s + j, 4);
+    }
+
+    alignas(64) uint32_t words[16][16];
+    for (int lane = 0; lane < 16; ++lane) {
+        for (int i = 0; i < 16; ++i) {
+            words[i][lane] = ReadLE32(chunks[lane] + 4 * i);
+        }
+    }
+    for (int i = 0; i < 16; ++i) {
+        w[i] = ByteSwap(_mm512_load_si512(words[i]));
+    }
+
+    Compress(state, w);
+
+    for (int j = 0; j < 8; ++j) {
+        _mm512_i32scatter_epi32(s + j, lane_offsets, state[j], 4);
+    }
+}
+
+}
+
+#endif
@@ -11,101 +11,188 @@
 
 #include <algorithm>
 #include <array> // For std::begin and std::end.
+#include <assert.h>
+#include <string.h>
 
 #include <stdint.h>
 
+#include <compat/cpuid.h>
+
+namespace sha3_avx2
+{
+void KeccakF_4way(uint64_t* st);
+}
+
+namespace sha3_avx512
+{
+void KeccakF_8way(uint64_t* st);
+}
+
 // Internal implementation code.
 namespace
 {
 uint64_t Rotl(uint64_t x, int n) { return (x << n) | (x >> (64 - n)); }
+
+constexpr uint64_t RNDC[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+/** The lanes kept complemented between rounds, which saves most NOTs in Chi. */
+constexpr uint64_t COMPLEMENTED[25] = {
+    0, ~0ULL, ~0ULL, 0, 0,
+    0, 0, 0, ~0ULL, 0,
+    0, 0, ~0ULL, 0, 0,
+    0, 0, ~0ULL, 0, 0,
+    ~0ULL, 0, 0, 0, 0
+};
+
+/**
+ * One round of Keccak-f[1600] from a into e, both in lane-complemented form.
+ * Rho and Pi are folded into the loads of each output plane, so no lane is
+ * moved in place.
+ */
+void inline __attribute__((always_inline)) Round(uint64_t (&e)[25], const uint64_t (&a)[25], uint64_t rc)
+{
+    uint64_t b0, b1, b2, b3, b4;
+
+    // Theta
+    b0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20];
+    b1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21];
+    b2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22];
+    b3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23];
+    b4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24];
+    const uint64_t d0 = b4 ^ Rotl(b1, 1);
+    const uint64_t d1 = b0 ^ Rotl(b2, 1);
+    const uint64_t d2 = b1 ^ Rotl(b3, 1);
+    const uint64_t d3 = b2 ^ Rotl(b4, 1);
+    const uint64_t d4 = b3 ^ Rotl(b0, 1);
+
+    // Plane 0: Rho Pi Chi Iota
+    b0 = a[0] ^ d0; b1 = Rotl(a[6] ^ d1, 44); b2 = Rotl(a[12] ^ d2, 43); b3 = Rotl(a[18] ^ d3, 21); b4 = Rotl(a[24] ^ d4, 14);
+    e[0] = b0 ^ (b1 | b2) ^ rc;
+    e[1] = b1 ^ (~b2 | b3);
+    e[2] = b2 ^ (b3 & b4);
+    e[3] = b3 ^ (b4 | b0);
+    e[4] = b4 ^ (b0 & b1);
+
+    // Plane 1: Rho Pi Chi
+    b0 = Rotl(a[3] ^ d3, 28); b1 = Rotl(a[9] ^ d4, 20); b2 = Rotl(a[10] ^ d0, 3); b3 = Rotl(a[16] ^ d1, 45); b4 = Rotl(a[22] ^ d2, 61);
+    e[5] = b0 ^ (b1 | b2);
+    e[6] = b1 ^ (b2 & b3);
+    e[7] = b2 ^ (b3 | ~b4);
+    e[8] = b3 ^ (b4 | b0);
+    e[9] = b4 ^ (b0 & b1);
+
+    // Plane 2: Rho Pi Chi
+    b0 = Rotl(a[1] ^ d1, 1); b1 = Rotl(a[7] ^ d2, 6); b2 = Rotl(a[13] ^ d3, 25); b3 = Rotl(a[19] ^ d4, 8); b4 = Rotl(a[20] ^ d0, 18);
+    e[10] = b0 ^ (b1 | b2);
+    e[11] = b1 ^ (b2 & b3);
+    e[12] = b2 ^ (~b3 & b4);
+    e[13] = ~b3 ^ (b4 | b0);
+    e[14] = b4 ^ (b0 & b1);
+
+    // Plane 3: Rho Pi Chi
+    b0 = Rotl(a[4] ^ d4, 27); b1 = Rotl(a[5] ^ d0, 36); b2 = Rotl(a[11] ^ d1, 10); b3 = Rotl(a[17] ^ d2, 15); b4 = Rotl(a[23] ^ d3, 56);
+    e[15] = b0 ^ (b1 & b2);
+    e[16] = b1 ^ (b2 | b3);
+    e[17] = b2 ^ (~b3 | b4);
+    e[18] = ~b3 ^ (b4 & b0);
+    e[19] = b4 ^ (b0 | b1);
+
+    // Plane 4: Rho Pi Chi
+    b0 = Rotl(a[2] ^ d2, 62); b1 = Rotl(a[8] ^ d3, 55); b2 = Rotl(a[14] ^ d4, 39); b3 = Rotl(a[15] ^ d0, 41); b4 = Rotl(a[21] ^ d1, 2);
+    e[20] = b0 ^ (~b1 & b2);
+    e[21] = ~b1 ^ (b2 | b3);
+    e[22] = b2 ^ (b3 & b4);
+    e[23] = b3 ^ (b4 | b0);
+    e[24] = b4 ^ (b0 & b1);
+}
 } // namespace
 
 void KeccakF(uint64_t (&st)[25])
 {
-    static constexpr uint64_t RNDC[24] = {
-        cx0000000000000001, cx0000000000008082, cx800000000000808a, cx8000000080008000,
-        cx000000000000808b, cx0000000080000001, cx8000000080008081, cx8000000000008009,
-        cx000000000000008a, cx0000000000000088, cx0000000080008009, cx000000008000000a,
-        cx000000008000808b, cx800000000000008b, cx8000000000008089, cx8000000000008003,
-        cx8000000000008002, cx8000000000000080, cx000000000000800a, cx800000008000000a,
-        cx8000000080008081, cx8000000000008080, cx0000000080000001, cx8000000080008008
-    };
-    static constexpr int ROUNDS = 24;
-
-    for (int round = 0; round < ROUNDS; ++round) {
-        uint64_t bc0, bc1, bc2, bc3, bc4, t;
-
-        // Theta
-        bc0 = st[0] ^ st[5] ^ st[10] ^ st[15] ^ st[20];
-        bc1 = st[1] ^ st[6] ^ st[11] ^ st[16] ^ st[21];
-        bc2 = st[2] ^ st[7] ^ st[12] ^ st[17] ^ st[22];
-        bc3 = st[3] ^ st[8] ^ st[13] ^ st[18] ^ st[23];
-        bc4 = st[4] ^ st[9] ^ st[14] ^ st[19] ^ st[24];
-        t = bc4 ^ Rotl(bc1, 1); st[0] ^= t; st[5] ^= t; st[10] ^= t; st[15] ^= t; st[20] ^= t;
-        t = bc0 ^ Rotl(bc2, 1); st[1] ^= t; st[6] ^= t; st[11] ^= t; st[16] ^= t; st[21] ^= t;
-        t = bc1 ^ Rotl(bc3, 1); st[2] ^= t; st[7] ^= t; st[12] ^= t; st[17] ^= t; st[22] ^= t;
-        t = bc2 ^ Rotl(bc4, 1); st[3] ^= t; st[8] ^= t; st[13] ^= t; st[18] ^= t; st[23] ^= t;
-        t = bc3 ^ Rotl(bc0, 1); st[4] ^= t; st[9] ^= t; st[14] ^= t; st[19] ^= t; st[24] ^= t;
-
-        // Rho Pi
-        t = st[1];
-        bc0 = st[10]; st[10] = Rotl(t, 1); t = bc0;
-        bc0 = st[7]; st[7] = Rotl(t, 3); t = bc0;
-        bc0 = st[11]; st[11] = Rotl(t, 6); t = bc0;
-        bc0 = st[17]; st[17] = Rotl(t, 10); t = bc0;
-        bc0 = st[18]; st[18] = Rotl(t, 15); t = bc0;
-        bc0 = st[3]; st[3] = Rotl(t, 21); t = bc0;
-        bc0 = st[5]; st[5] = Rotl(t, 28); t = bc0;
-        bc0 = st[16]; st[16] = Rotl(t, 36); t = bc0;
-        bc0 = st[8]; st[8] = Rotl(t, 45); t = bc0;
-        bc0 = st[21]; st[21] = Rotl(t, 55); t = bc0;
-        bc0 = st[24]; st[24] = Rotl(t, 2); t = bc0;
-        bc0 = st[4]; st[4] = Rotl(t, 14); t = bc0;
-        bc0 = st[15]; st[15] = Rotl(t, 27); t = bc0;
-        bc0 = st[23]; st[23] = Rotl(t, 41); t = bc0;
-        bc0 = st[19]; st[19] = Rotl(t, 56); t = bc0;
-        bc0 = st[13]; st[13] = Rotl(t, 8); t = bc0;
-        bc0 = st[12]; st[12] = Rotl(t, 25); t = bc0;
-        bc0 = st[2]; st[2] = Rotl(t, 43); t = bc0;
-        bc0 = st[20]; st[20] = Rotl(t, 62); t = bc0;
-        bc0 = st[14]; st[14] = Rotl(t, 18); t = bc0;
-        bc0 = st[22]; st[22] = Rotl(t, 39); t = bc0;
-        bc0 = st[9]; st[9] = Rotl(t, 61); t = bc0;
-        bc0 = st[6]; st[6] = Rotl(t, 20); t = bc0;
-        st[1] = Rotl(t, 44);
-
-        // Chi Iota
-        bc0 = st[0]; bc1 = st[1]; bc2 = st[2]; bc3 = st[3]; bc4 = st[4];
-        st[0] = bc0 ^ (~bc1 & bc2) ^ RNDC[round];
-        st[1] = bc1 ^ (~bc2 & bc3);
-        st[2] = bc2 ^ (~bc3 & bc4);
-        st[3] = bc3 ^ (~bc4 & bc0);
-        st[4] = bc4 ^ (~bc0 & bc1);
-        bc0 = st[5]; bc1 = st[6]; bc2 = st[7]; bc3 = st[8]; bc4 = st[9];
-        st[5] = bc0 ^ (~bc1 & bc2);
-        st[6] = bc1 ^ (~bc2 & bc3);
-        st[7] = bc2 ^ (~bc3 & bc4);
-        st[8] = bc3 ^ (~bc4 & bc0);
-        st[9] = bc4 ^ (~bc0 & bc1);
-        bc0 = st[10]; bc1 = st[11]; bc2 = st[12]; bc3 = st[13]; bc4 = st[14];
-        st[10] = bc0 ^ (~bc1 & bc2);
-        st[11] = bc1 ^ (~bc2 & bc3);
-        st[12] = bc2 ^ (~bc3 & bc4);
-        st[13] = bc3 ^ (~bc4 & bc0);
-        st[14] = bc4 ^ (~bc0 & bc1);
-        bc0 = st[15]; bc1 = st[16]; bc2 = st[17]; bc3 = st[18]; bc4 = st[19];
-        st[15] = bc0 ^ (~bc1 & bc2);
-        st[16] = bc1 ^ (~bc2 & bc3);
-        st[17] = bc2 ^ (~bc3 & bc4);
-        st[18] = bc3 ^ (~bc4 & bc0);
-        st[19] = bc4 ^ (~bc0 & bc1);
-        bc0 = st[20]; bc1 = st[21]; bc2 = st[22]; bc3 = st[23]; bc4 = st[24];
-        st[20] = bc0 ^ (~bc1 & bc2);
-        st[21] = bc1 ^ (~bc2 & bc3);
-        st[22] = bc2 ^ (~bc3 & bc4);
-        st[23] = bc3 ^ (~bc4 & bc0);
-        st[24] = bc4 ^ (~bc0 & bc1);
+    uint64_t a[25], e[25];
+    for (int i = 0; i < 25; ++i) a[i] = st[i] ^ COMPLEMENTED[i];
+    for (int round = 0; round < 24; round += 2) {
+        Round(e, a, RNDC[round]);
+        Round(a, e, RNDC[round + 1]);
     }
+    for (int i = 0; i < 25; ++i) st[i] = a[i] ^ COMPLEMENTED[i];
+}
+
+namespace
+{
+/** Permute several independent states; word i of state j is at st[lanes * i + j]. */
+typedef void (*KeccakFMultiType)(uint64_t* st);
+KeccakFMultiType KeccakF_4way = nullptr;
+KeccakFMultiType KeccakF_8way = nullptr;
+
+/** Check a multi-state permutation against KeccakF, with every lane starting from a different state. */
+bool SelfTestMulti(KeccakFMultiType permute, int lanes)
+{
+    uint64_t expected[8][25];
+    uint64_t st[8 * 25];
+    for (int j = 0; j < lanes; ++j) {
+        for (int i = 0; i < 25; ++i) {
+            expected[j][i] = 0x9e3779b97f4a7c15ULL * (25 * j + i + 1);
+            st[lanes * i + j] = expected[j][i];
+        }
+        KeccakF(expected[j]);
+    }
+    permute(st);
+    for (int j = 0; j < lanes; ++j) {
+        for (int i = 0; i < 25; ++i) {
+            if (st[lanes * i + j] != expected[j][i]) return false;
+        }
+    }
+    return true;
+}
+
+bool SelfTest()
+{
+    // The first two states of the zero state's orbit (see also keccak_tests).
+    uint64_t st[25] = {0};
+    KeccakF(st);
+    if (st[0] != 0xf1258f7940e1dde7ULL || st[24] != 0xeaf1ff7b5ceca249ULL) return false;
+    KeccakF(st);
+    if (st[0] != 0x2d5c954df96ecb3cULL || st[24] != 0x20d06cd26a8fbf5cULL) return false;
+
+    if (KeccakF_4way && !SelfTestMulti(KeccakF_4way, 4)) return false;
+    if (KeccakF_8way && !SelfTestMulti(KeccakF_8way, 8)) return false;
+    return true;
+}
+
+} // namespace
+
+std::string SHA3AutoDetect()
+{
+    std::string ret = "standard";
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+    const X86Features features = GetX86Features();
+    (void)features;
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_chymera_INTERNAL)
+    if (features.avx2) {
+        KeccakF_4way = sha3_avx2::KeccakF_4way;
+        ret += ",avx2(4way)";
+    }
+#endif
+
+#if defined(ENABLE_AVX512) && !defined(BUILD_chymera_INTERNAL)
+    if (features.avx512) {
+        KeccakF_8way = sha3_avx512::KeccakF_8way;
+        ret += ",avx512(8way)";
+    }
+#endif
+#endif
+
+    assert(SelfTest());
+    return ret;
 }
 
 SHA3_256& SHA3_256::Write(Span<const unsigned char> data)
@@ -159,3 +246,103 @@ SHA3_256& SHA3_256::Reset()
     std::fill(std::begin(m_state), std::end(m_state), 0);
     return *this;
 }
+
+namespace {
+
+//! The SHA3-256 sponge rate in bytes and 64-bit words.
+constexpr size_t SHA3_256_RATE = 136;
+constexpr size_t SHA3_256_RATE_WORDS = SHA3_256_RATE / 8;
+
+/** Progress of one message through a lane of the multi-buffer hasher. */
+struct KeccakLane
+{
+    size_t msg;                  //!< index of the message being hashed
+    const unsigned char* data;   //!< the input not absorbed yet
+    size_t remaining;            //!< its length
+
+    /**
+     * XOR the next block, padded if it is the last one, into a state whose
+     * words are stride apart. Returns true once the whole message is absorbed.
+     */
+    bool Absorb(uint64_t* st, size_t stride)
+    {
+        if (remaining >= SHA3_256_RATE) {
+            for (size_t i = 0; i < SHA3_256_RATE_WORDS; ++i) st[stride * i] ^= ReadLE64(data + 8 * i);
+            data += SHA3_256_RATE;
+            remaining -= SHA3_256_RATE;
+            return false;
+        }
+        unsigned char block[SHA3_256_RATE] = {0};
+        if (remaining) memcpy(block, data, remaining);
+        block[remaining] ^= 0x06;
+        block[SHA3_256_RATE - 1] ^= 0x80;
+        for (size_t i = 0; i < SHA3_256_RATE_WORDS; ++i) st[stride * i] ^= ReadLE64(block + 8 * i);
+        remaining = 0;
+        return true;
+    }
+};
+
+void WriteDigest(unsigned char* out, const uint64_t* st, size_t stride)
+{
+    for (size_t i = 0; i < SHA3_256::OUTPUT_SIZE / 8; ++i) WriteLE64(out + 8 * i, st[stride * i]);
+}
+
+} // namespace
+
+void SHA3_256Multi(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count)
+{
+    const KeccakFMultiType permute = KeccakF_8way ? KeccakF_8way : KeccakF_4way;
+    const size_t n_lanes = KeccakF_8way ? 8 : 4;
+    if (!permute || count < 2) {
+        for (size_t i = 0; i < count; ++i) {
+            SHA3_256().Write({inputs[i], lengths[i]}).Finalize({outputs[i], SHA3_256::OUTPUT_SIZE});
+        }
+        return;
+    }
+
+    // Zeroed, as idle lanes are permuted too.
+    uint64_t st[25 * 8]{};
+    KeccakLane lanes[8];
+    bool active[8] = {false};
+    size_t next = 0;
+    size_t n_active = 0;
+    auto load = [&](size_t lane) {
+        if (next < count) {
+            lanes[lane] = KeccakLane{next, inputs[next], lengths[next]};
+            for (size_t i = 0; i < 25; ++i) st[n_lanes * i + lane] = 0;
+            active[lane] = true;
+            ++n_active;
+            ++next;
+        }
+    };
+    for (size_t lane = 0; lane < n_lanes; ++lane) load(lane);
+
+    // Idle lanes permute their own, unused state. Once the queue is drained
+    // and few lanes remain busy, the rest is finished one message at a time.
+    bool absorbed[8];
+    while (n_active > 0 && (next < count || 2 * n_active >= n_lanes)) {
+        for (size_t lane = 0; lane < n_lanes; ++lane) {
+            absorbed[lane] = active[lane] && lanes[lane].Absorb(st + lane, n_lanes);
+        }
+        permute(st);
+        for (size_t lane = 0; lane < n_lanes; ++lane) {
+            if (!absorbed[lane]) continue;
+            WriteDigest(outputs[lanes[lane].msg], st + lane, n_lanes);
+            active[lane] = false;
+            --n_active;
+            load(lane);
+        }
+    }
+
+    for (size_t lane = 0; lane < n_lanes; ++lane) {
+        if (!active[lane]) continue;
+        uint64_t state[25];
+        for (size_t i = 0; i < 25; ++i) state[i] = st[n_lanes * i + lane];
+        bool done;
+        do {
+            done = lanes[lane].Absorb(state, 1);
+            KeccakF(state);
+        } while (!done);
+        WriteDigest(outputs[lanes[lane].msg], state, 1);
+    }
+}
@@ -9,10 +9,16 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
 //! The Keccak-f[1600] transform.
 void KeccakF(uint64_t (&st)[25]);
 
+/** Autodetect the best available multi-state Keccak-f[1600] implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SHA3AutoDetect();
+
 class SHA3_256
 {
 private:
@@ -38,4 +44,11 @@ public:
     SHA3_256& Reset();
 };
 
+/** Compute the SHA3-256 digests of count independent messages, several at a
+ *  time when a multi-state Keccak-f[1600] implementation is available.
+ *  outputs[i] receives SHA3_256::OUTPUT_SIZE bytes for the lengths[i] bytes
+ *  at inputs[i]. Equivalent to hashing every message with SHA3_256.
+ */
+void SHA3_256Multi(unsigned char* const* outputs, const unsigned char* const* inputs, const size_t* lengths, size_t count);
+
 #endif // chymera_CRYPTO_SHA3_H
@@ -0,0 +1,124 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace sha3_avx2 {
+namespace {
+
+const uint64_t RNDC[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a, 0x8000000080008000,
+    0x000000000000808b, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008a, 0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800a, 0x800000008000000a,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+__m256i inline K(uint64_t x) { return _mm256_set1_epi64x(x); }
+
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Xor(__m256i x, __m256i y, __m256i z, __m256i w, __m256i v) { return Xor(Xor(Xor(x, y), Xor(z, w)), v); }
+__m256i inline Rotl(__m256i x, int n) { return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n)); }
+/** x ^ (~y & z) */
+__m256i inline Chi(__m256i x, __m256i y, __m256i z) { return Xor(x, _mm256_andnot_si256(y, z)); }
+
+/** One round of Keccak-f[1600] on 4 states at once, from a into e. */
+void inline __attribute__((always_inline)) Round(__m256i (&e)[25], const __m256i (&a)[25], __m256i rc)
+{
+    __m256i b0, b1, b2, b3, b4;
+
+    // Theta
+    b0 = Xor(a[0], a[5], a[10], a[15], a[20]);
+    b1 = Xor(a[1], a[6], a[11], a[16], a[21]);
+    b2 = Xor(a[2], a[7], a[12], a[17], a[22]);
+    b3 = Xor(a[3], a[8], a[13], a[18], a[23]);
+    b4 = Xor(a[4], a[9], a[14], a[19], a[24]);
+    const __m256i d0 = Xor(b4, Rotl(b1, 1));
+    const __m256i d1 = Xor(b0, Rotl(b2, 1));
+    const __m256i d2 = Xor(b1, Rotl(b3, 1));
+    const __m256i d3 = Xor(b2, Rotl(b4, 1));
+    const __m256i d4 = Xor(b3, Rotl(b0, 1));
+
+    // Plane 0: Rho Pi Chi Iota
+    b0 = Xor(a[0], d0);
+    b1 = Rotl(Xor(a[6], d1), 44);
+    b2 = Rotl(Xor(a[12], d2), 43);
+    b3 = Rotl(Xor(a[18], d3), 21);
+    b4 = Rotl(Xor(a[24], d4), 14);
+    e[0] = Xor(Chi(b0, b1, b2), rc);
+    e[1] = Chi(b1, b2, b3);
+    e[2] = Chi(b2, b3, b4);
+    e[3] = Chi(b3, b4, b0);
+    e[4] = Chi(b4, b0, b1);
+
+    // Plane 1: Rho Pi Chi
+    b0 = Rotl(Xor(a[3], d3), 28);
+    b1 = Rotl(Xor(a[9], d4), 20);
+    b2 = Rotl(Xor(a[10], d0), 3);
+    b3 = Rotl(Xor(a[16], d1), 45);
+    b4 = Rotl(Xor(a[22], d2), 61);
+    e[5] = Chi(b0, b1, b2);
+    e[6] = Chi(b1, b2, b3);
+    e[7] = Chi(b2, b3, b4);
+    e[8] = Chi(b3, b4, b0);
+    e[9] = Chi(b4, b0, b1);
+
+    // Plane 2: Rho Pi Chi
+    b0 = Rotl(Xor(a[1], d1), 1);
+    b1 = Rotl(Xor(a[7], d2), 6);
+    b2 = Rotl(Xor(a[13], d3), 25);
+    b3 = Rotl(Xor(a[19], d4), 8);
+    b4 = Rotl(Xor(a[20], d0), 18);
+    e[10] = Chi(b0, b1, b2);
+    e[11] = Chi(b1, b2, b3);
+    e[12] = Chi(b2, b3, b4);
+    e[13] = Chi(b3, b4, b0);
+    e[14] = Chi(b4, b0, b1);
+
+    // Plane 3: Rho Pi Chi
+    b0 = Rotl(Xor(a[4], d4), 27);
+    b1 = Rotl(Xor(a[5], d0), 36);
+    b2 = Rotl(Xor(a[11], d1), 10);
+    b3 = Rotl(Xor(a[17], d2), 15);
+    b4 = Rotl(Xor(a[23], d3), 56);
+    e[15] = Chi(b0, b1, b2);
+    e[16] = Chi(b1, b2, b3);
+    e[17] = Chi(b2, b3, b4);
+    e[18] = Chi(b3, b4, b0);
+    e[19] = Chi(b4, b0, b1);
+
+    // Plane 4: Rho Pi Chi
+    b0 = Rotl(Xor(a[2], d2), 62);
+    b1 = Rotl(Xor(a[8], d3), 55);
+    b2 = Rotl(Xor(a[14], d4), 39);
+    b3 = Rotl(Xor(a[15], d0), 41);
+    b4 = Rotl(Xor(a[21], d1), 2);
+    e[20] = Chi(b0, b1, b2);
+    e[21] = Chi(b1, b2, b3);
+    e[22] = Chi(b2, b3, b4);
+    e[23] = Chi(b3, b4, b0);
+    e[24] = Chi(b4, b0, b1);
+}
+
+}
+
+/** Permute 4 independent states; word i of state j is st[4 * i + j]. */
+void KeccakF_4way(uint64_t* st)
+{
+    __m256i a[25], e[25];
+    for (int i = 0; i < 25; ++i) a[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(st + 4 * i));
+    for (int round = 0; round < 24; round += 2) {
+        Round(e, a, K(RNDC[round]));
+        Round(a, e, K(RNDC[round + 1]));
+    }
+    for (int i = 0; i < 25; ++i) _mm256_storeu_si256(reinterpret_cast<__m256i*>(st + 4 * i), a[i]);
+}
+
+}
+
+#endif
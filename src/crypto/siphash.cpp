@@ -4,6 +4,15 @@
 
 #include <crypto/siphash.h>
 
+#include <compat/cpuid.h>
+
+#include <assert.h>
+
+namespace siphash_avx2
+{
+void SipHashUint256_8way(uint64_t k0, uint64_t k1, const uint256* const* vals, const uint32_t* extras, uint64_t* out);
+}
+
 #define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
 
 #define SIPROUND do { \
@@ -171,3 +180,58 @@ uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint3
     SIPROUND;
     return v0 ^ v1 ^ v2 ^ v3;
 }
+
+namespace {
+
+/** Hash 8 keys at once; extras is either null (plain uint256 keys) or holds one extra word per key. */
+typedef void (*SipHashBatchType)(uint64_t k0, uint64_t k1, const uint256* const* vals, const uint32_t* extras, uint64_t* out);
+SipHashBatchType SipHashUint256_8way = nullptr;
+
+bool SelfTest()
+{
+    uint256 keys[8];
+    const uint256* vals[8];
+    uint32_t extras[8];
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 32; ++j) keys[i].begin()[j] = 29 * i + j;
+        vals[i] = &keys[i];
+        extras[i] = 0x01020304 * (i + 1);
+    }
+    uint64_t out[8];
+    SipHashUint256_8way(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, vals, nullptr, out);
+    for (int i = 0; i < 8; ++i) {
+        if (out[i] != SipHashUint256(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, keys[i])) return false;
+    }
+    SipHashUint256_8way(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, vals, extras, out);
+    for (int i = 0; i < 8; ++i) {
+        if (out[i] != SipHashUint256Extra(0x0706050403020100ULL, 0x0F0E0D0C0B0A0908ULL, keys[i], extras[i])) return false;
+    }
+    return true;
+}
+
+} // namespace
+
+std::string SipHashAutoDetect()
+{
+    std::string ret = "standard";
+#if defined(USE_ASM) && defined(HAVE_GETCPUID) && defined(ENABLE_AVX2) && !defined(BUILD_chymera_INTERNAL)
+    if (GetX86Features().avx2) {
+        SipHashUint256_8way = siphash_avx2::SipHashUint256_8way;
+        ret = "avx2(8way)";
+        assert(SelfTest());
+    }
+#endif
+    return ret;
+}
+
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, const uint256* const* vals, uint64_t* out, size_t count)
+{
+    if (SipHashUint256_8way) {
+        for (; count >= 8; count -= 8, vals += 8, out += 8) {
+            SipHashUint256_8way(k0, k1, vals, nullptr, out);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = SipHashUint256(k0, k1, *vals[i]);
+    }
+}
@@ -6,6 +6,7 @@
 #define chymera_CRYPTO_SIPHASH_H
 
 #include <stdint.h>
+#include <string>
 
 #include <uint256.h>
 
@@ -44,4 +45,14 @@ public:
 uint64_t SipHashUint256(uint64_t k0, uint64_t k1, const uint256& val);
 uint64_t SipHashUint256Extra(uint64_t k0, uint64_t k1, const uint256& val, uint32_t extra);
 
+/** Autodetect the best available batched SipHash implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SipHashAutoDetect();
+
+/** SipHashUint256 of count keys: out[i] = SipHashUint256(k0, k1, *vals[i]).
+ *  Keys are hashed 8 at a time with SIMD when available.
+ */
+void SipHashUint256Batch(uint64_t k0, uint64_t k1, const uint256* const* vals, uint64_t* out, size_t count);
+
 #endif // chymera_CRYPTO_SIPHASH_H
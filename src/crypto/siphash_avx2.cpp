@@ -0,0 +1,98 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#include <crypto/common.h>
+#include <uint256.h>
+
+namespace siphash_avx2 {
+namespace {
+
+__m256i inline K(uint64_t x) { return _mm256_set1_epi64x(x); }
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi64(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline Rotl(__m256i x, int n) { return _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - n)); }
+__m256i inline Rotl16(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13, 6, 7, 0, 1, 2, 3, 4, 5, 14, 15, 8, 9, 10, 11, 12, 13)); }
+__m256i inline Rotl32(__m256i x) { return _mm256_shuffle_epi32(x, 0xB1); }
+
+/** SipHash state of 4 lanes, one 64-bit word per lane in each vector. */
+struct State
+{
+    __m256i v0, v1, v2, v3;
+
+    void Init(uint64_t k0, uint64_t k1)
+    {
+        v0 = K(0x736f6d6570736575ULL ^ k0);
+        v1 = K(0x646f72616e646f6dULL ^ k1);
+        v2 = K(0x6c7967656e657261ULL ^ k0);
+        v3 = K(0x7465646279746573ULL ^ k1);
+    }
+
+    void inline __attribute__((always_inline)) Round()
+    {
+        v0 = Add(v0, v1); v1 = Rotl(v1, 13); v1 = Xor(v1, v0);
+        v0 = Rotl32(v0);
+        v2 = Add(v2, v3); v3 = Rotl16(v3); v3 = Xor(v3, v2);
+        v0 = Add(v0, v3); v3 = Rotl(v3, 21); v3 = Xor(v3, v0);
+        v2 = Add(v2, v1); v1 = Rotl(v1, 17); v1 = Xor(v1, v2);
+        v2 = Rotl32(v2);
+    }
+};
+
+/** Word `word` of the 4 keys starting at vals, lane i in element i. */
+__m256i inline ReadWord(const uint256* const* vals, int word)
+{
+    return _mm256_setr_epi64x(
+        vals[0]->GetUint64(word),
+        vals[1]->GetUint64(word),
+        vals[2]->GetUint64(word),
+        vals[3]->GetUint64(word));
+}
+
+/** The final, length-carrying word of 4 keys, with their extra words if any. */
+__m256i inline ReadLast(const uint32_t* extras)
+{
+    if (!extras) return K(((uint64_t)32) << 56);
+    return Xor(K(((uint64_t)36) << 56), _mm256_setr_epi64x(extras[0], extras[1], extras[2], extras[3]));
+}
+
+}
+
+void SipHashUint256_8way(uint64_t k0, uint64_t k1, const uint256* const* vals, const uint32_t* extras, uint64_t* out)
+{
+    // Two groups of four lanes are interleaved so that the dependency chain
+    // of each SipRound is hidden behind the other group's.
+    State a, b;
+    a.Init(k0, k1);
+    b.Init(k0, k1);
+
+    for (int word = 0; word < 5; ++word) {
+        const __m256i da = word < 4 ? ReadWord(vals, word) : ReadLast(extras);
+        const __m256i db = word < 4 ? ReadWord(vals + 4, word) : ReadLast(extras ? extras + 4 : nullptr);
+        a.v3 = Xor(a.v3, da);
+        b.v3 = Xor(b.v3, db);
+        a.Round(); b.Round();
+        a.Round(); b.Round();
+        a.v0 = Xor(a.v0, da);
+        b.v0 = Xor(b.v0, db);
+    }
+
+    a.v2 = Xor(a.v2, K(0xFF));
+    b.v2 = Xor(b.v2, K(0xFF));
+    for (int i = 0; i < 4; ++i) {
+        a.Round(); b.Round();
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), Xor(Xor(a.v0, a.v1), Xor(a.v2, a.v3)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4), Xor(Xor(b.v0, b.v1), Xor(b.v2, b.v3)));
+}
+
+}
+
+#endif
@@ -477,6 +477,24 @@ public:
             }
         return false;
     }
+
+    /** for_each_element calls fn(e) for every element that has not been
+     * erased, those of the older epoch first, so that inserting them in the
+     * same order into an empty cache approximately restores their ages.
+     *
+     * Requires no concurrent Write (like contains()).
+     *
+     * @param fn a callable taking a const Element&
+     */
+    template <typename Fn>
+    void for_each_element(Fn&& fn) const
+    {
+        for (const bool recent : {false, true}) {
+            for (uint32_t i = 0; i < size; ++i) {
+                if (epoch_flags[i] == recent && !collection_flags.bit_is_set(i)) fn(table[i]);
+            }
+        }
+    }
 };
 } // namespace CuckooCache
 
@@ -7,6 +7,9 @@
 #include <chainparams.h>
 #include <crypto/hmac_sha256.h>
 #include <httpserver.h>
+#include <logging.h>
+#include <rpc/cbor.h>
+#include <rpc/jsonwriter.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
 #include <util/strencodings.h>
@@ -18,6 +21,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <optional>
 #include <stdio.h>
 #include <set>
 #include <string>
@@ -63,6 +67,57 @@ private:
     struct event_base* base;
 };
 
+/** Sends the reply to a single JSON-RPC request as a chunked HTTP reply, for
+ * methods that stream their result.
+ */
+class HTTPRPCResultStream final : public JSONRPCResultStream
+{
+public:
+    HTTPRPCResultStream(HTTPRequest* req, const UniValue& id) : m_req(req), m_id(id)
+    {
+    }
+    JSONWriter& Begin() override
+    {
+        assert(!m_writer);
+        m_req->WriteHeader("Content-Type", "application/json");
+        m_req->StartChunkedReply(HTTP_OK);
+        m_writer.emplace([this](Span<const char> chunk) {
+            // Stop producing a result that nobody will receive.
+            if (!m_req->WriteReplyChunk(chunk)) throw std::runtime_error("Client disconnected");
+        });
+        m_writer->BeginObject();
+        m_writer->Key("result");
+        return *m_writer;
+    }
+    bool Started() const override
+    {
+        return m_writer.has_value();
+    }
+    /** Complete the reply after the result was written. */
+    void End()
+    {
+        try {
+            m_writer->Pair("error", NullUniValue);
+            m_writer->Pair("id", m_id);
+            m_writer->EndObject();
+            m_writer->Flush();
+            m_req->WriteReplyChunk(MakeSpan("\n").first(1));
+        } catch (const std::runtime_error&) {
+            // The client disconnected, there is nothing left to send it.
+        }
+        m_req->EndChunkedReply();
+    }
+    /** Cut the reply short after the result could not be written. */
+    void Abort()
+    {
+        m_req->EndChunkedReply(false);
+    }
+
+private:
+    HTTPRequest* const m_req;
+    const UniValue& m_id;
+    std::optional<JSONWriter> m_writer;
+};
 
 /* Pre-base64-encoded authentication token */
 static std::string strRPCUserColonPass;
@@ -74,7 +129,7 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
 
-static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id)
+static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id, bool cbor)
 {
     // Send error reply from json-rpc error object
     int nStatus = HTTP_INTERNAL_SERVER_ERROR;
@@ -85,12 +140,19 @@ static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const Uni
     else if (code == RPC_METHOD_NOT_FOUND)
         nStatus = HTTP_NOT_FOUND;
 
+    if (cbor) {
+        req->WriteHeader("Content-Type", CBOR_CONTENT_TYPE);
+        req->WriteReply(nStatus, EncodeCBORReply(JSONRPCReplyObj(NullUniValue, objError, id), nullptr));
+        return;
+    }
+
     std::string strReply = JSONRPCReply(NullUniValue, objError, id);
 
     req->WriteHeader("Content-Type", "application/json");
     req->WriteReply(nStatus, strReply);
 }
 
+
 //This function checks username and password against -rpcauth
 //entries from config file.
 static bool multiUserAuthorized(std::string strUserPass)
@@ -159,6 +221,13 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         return false;
     }
 
+    // Requests in CBOR are replied to in CBOR, and so are JSON requests that
+    // prefer it.
+    const std::pair<bool, std::string> content_type = req->GetHeader("content-type");
+    const std::pair<bool, std::string> accept = req->GetHeader("accept");
+    const bool cbor_request = content_type.first && IsCBORContentType(content_type.second);
+    const bool cbor_reply = cbor_request || (accept.first && AcceptsCBOR(accept.second));
+
     JSONRPCRequest jreq;
     jreq.context = context;
     jreq.peerAddr = req->GetPeer().ToString();
@@ -178,7 +247,11 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
     try {
         // Parse request
         UniValue valRequest;
-        if (!valRequest.read(req->ReadBody()))
+        if (cbor_request) {
+            const std::string body = req->ReadBody();
+            if (!DecodeCBOR(MakeUCharSpan(body), valRequest))
+                throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
+        } else if (!valRequest.read(req->ReadBody()))
             throw JSONRPCError(RPC_PARSE_ERROR, "Parse error");
 
         // Set the URI
@@ -199,10 +272,30 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                 req->WriteReply(HTTP_FORBIDDEN);
                 return false;
             }
-            UniValue result = tableRPC.execute(jreq);
+            // Only JSON results are streamed.
+            HTTPRPCResultStream stream(req, jreq.id);
+            if (!cbor_reply) jreq.result_stream = &stream;
+            UniValue result;
+            try {
+                result = tableRPC.execute(jreq);
+            } catch (...) {
+                if (!stream.Started()) throw;
+                // Too late for an error reply.
+                LogPrintf("RPC method %s failed while streaming its result\n", jreq.strMethod);
+                stream.Abort();
+                return false;
+            }
+            if (stream.Started()) {
+                stream.End();
+                return true;
+            }
 
             // Send reply
-            strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            if (cbor_reply) {
+                strReply = EncodeCBORReply(JSONRPCReplyObj(result, NullUniValue, jreq.id), tableRPC.getResults(jreq.strMethod));
+            } else {
+                strReply = JSONRPCReply(result, NullUniValue, jreq.id);
+            }
 
         // array of requests
         } else if (valRequest.isArray()) {
@@ -222,18 +315,27 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
                     }
                 }
             }
-            strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
+            if (cbor_reply) {
+                std::vector<const RPCResults*> results;
+                for (const UniValue& request : valRequest.getValues()) {
+                    const UniValue& method = find_value(request, "method");
+                    results.push_back(method.isStr() ? tableRPC.getResults(method.get_str()) : nullptr);
+                }
+                strReply = EncodeCBORBatchReply(JSONRPCExecBatchReplies(jreq, valRequest.get_array()), results);
+            } else {
+                strReply = JSONRPCExecBatch(jreq, valRequest.get_array());
+            }
         }
         else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
-        req->WriteHeader("Content-Type", "application/json");
+        req->WriteHeader("Content-Type", cbor_reply ? CBOR_CONTENT_TYPE : "application/json");
         req->WriteReply(HTTP_OK, strReply);
     } catch (const UniValue& objError) {
-        JSONErrorReply(req, objError, jreq.id);
+        JSONErrorReply(req, objError, jreq.id, cbor_reply);
         return false;
     } catch (const std::exception& e) {
-        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id);
+        JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, cbor_reply);
         return false;
     }
     return true;
@@ -300,6 +402,12 @@ bool StartHTTPRPC(const std::any& context)
     if (g_wallet_init_interface.HasWalletSupport()) {
         RegisterHTTPHandler("/wallet/", false, handle_rpc);
     }
+    SetHTTPAuthUserFunction([](const HTTPRequest& req) {
+        const std::pair<bool, std::string> auth_header = req.GetHeader("authorization");
+        std::string user;
+        if (!auth_header.first || !RPCAuthorized(auth_header.second, user)) return std::string{};
+        return user;
+    });
     struct event_base* eventBase = EventBase();
     assert(eventBase);
     httpRPCTimerInterface = std::make_unique<HTTPRPCTimerInterface>(eventBase);
@@ -315,6 +423,7 @@ void InterruptHTTPRPC()
 void StopHTTPRPC()
 {
     LogPrint(BCLog::RPC, "Stopping HTTP RPC server\n");
+    SetHTTPAuthUserFunction(nullptr);
     UnregisterHTTPHandler("/", true);
     if (g_wallet_init_interface.HasWalletSupport()) {
         UnregisterHTTPHandler("/wallet/", false);
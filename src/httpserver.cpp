@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <httpserver.h>
+#include <httpworkqueue.h>
 
 #include <chainparamsbase.h>
 #include <compat.h>
@@ -16,7 +17,7 @@
 #include <util/threadnames.h>
 #include <util/translation.h>
 
-#include <deque>
+#include <atomic>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
@@ -30,11 +31,16 @@
 #include <event2/bufferevent.h>
 #include <event2/util.h>
 #include <event2/keyvalq_struct.h>
+#include <event2/listener.h>
 
 #include <support/events.h>
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
+/** Size of a chunked reply that may be waiting to be sent before the worker producing it blocks */
+static const size_t MAX_CHUNKED_REPLY_UNSENT = 1 << 20;
+/** Memory a queued request is counted to take besides its URI and body */
+static const size_t HTTP_REQUEST_OVERHEAD = 1024;
 
 /** HTTP request work item */
 class HTTPWorkItem final : public HTTPClosure
@@ -56,64 +62,19 @@ private:
     HTTPRequestHandler func;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
+/** State of a chunked reply, shared between the worker producing it and the
+ * event loop thread sending it.
  */
-template <typename WorkItem>
-class WorkQueue
+struct HTTPChunkedReply
 {
-private:
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
-    bool running GUARDED_BY(cs);
-    const size_t maxDepth;
-
-public:
-    explicit WorkQueue(size_t _maxDepth) : running(true),
-                                 maxDepth(_maxDepth)
-    {
-    }
-    /** Precondition: worker threads have all stopped (they have been joined).
-     */
-    ~WorkQueue()
-    {
-    }
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
-    {
-        LOCK(cs);
-        if (queue.size() >= maxDepth) {
-            return false;
-        }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
-        return true;
-    }
-    /** Thread function */
-    void Run()
-    {
-        while (true) {
-            std::unique_ptr<WorkItem> i;
-            {
-                WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
-                    cond.wait(lock);
-                if (!running)
-                    break;
-                i = std::move(queue.front());
-                queue.pop_front();
-            }
-            (*i)();
-        }
-    }
-    /** Interrupt and exit loops */
-    void Interrupt()
-    {
-        LOCK(cs);
-        running = false;
-        cond.notify_all();
-    }
+    //! Bytes passed to the event loop and not yet written to the socket.
+    size_t unsent GUARDED_BY(cs){0};
+    //! The connection was closed.
+    bool closed GUARDED_BY(cs){false};
+    //! Bytes in the connection's output buffer. Only used from the event loop thread.
+    size_t buffered{0};
 };
 
 struct HTTPPathHandler
@@ -139,8 +100,17 @@ static std::vector<CSubNet> rpc_allow_subnets;
 static WorkQueue<HTTPClosure>* workQueue = nullptr;
 //! Handlers for (sub)paths
 static std::vector<HTTPPathHandler> pathHandlers;
+//! Protects boundSockets, which the event loop uses to stop and resume accepting connections
+static Mutex g_bound_sockets_mutex;
 //! Bound listening sockets
-static std::vector<evhttp_bound_socket *> boundSockets;
+static std::vector<evhttp_bound_socket *> boundSockets GUARDED_BY(g_bound_sockets_mutex);
+//! Whether the work queue asks not to accept new connections
+static std::atomic<bool> g_accept_paused{false};
+//! The work queue, on HTTP worker threads
+static thread_local WorkQueue<HTTPClosure>* g_worker_queue = nullptr;
+static Mutex g_auth_user_mutex;
+//! Finds the user of requests from local clients
+static HTTPAuthUserFunction g_auth_user_func GUARDED_BY(g_auth_user_mutex);
 
 /** Check if a network address is allowed to access the HTTP server */
 static bool ClientAllowed(const CNetAddr& netaddr)
@@ -202,6 +172,22 @@ std::string RequestMethodString(HTTPRequest::RequestMethod m)
     }
 }
 
+/** Re-enable reading from the socket, which http_request_cb disabled to work
+ * around a libevent bug.
+ */
+static void http_resume_reading(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= cx02010600 && event_get_version_number() < cx02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** HTTP request callback */
 static void http_request_cb(struct evhttp_request* req, void* arg)
 {
@@ -255,19 +241,44 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        const CService peer = hreq->GetPeer();
+        std::string auth_user;
+        if (peer.IsLocal()) {
+            LOCK(g_auth_user_mutex);
+            if (g_auth_user_func) auth_user = g_auth_user_func(*hreq);
+        }
+        const std::string client = HTTPClientKey(peer, auth_user);
+        const size_t bytes = HTTP_REQUEST_OVERHEAD + strURI.size() + evbuffer_get_length(evhttp_request_get_input_buffer(req));
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(item.get(), client, bytes))
             item.release(); /* if true, queue took ownership */
         else {
-            LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
+            LogPrintf("WARNING: request rejected because http work queue memory exceeded, it can be increased with the -rpcworkqueuemem= setting\n");
+            item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue memory exceeded");
         }
     } else {
         hreq->WriteReply(HTTP_NOT_FOUND);
     }
 }
 
+/** Stop or resume accepting connections, as the work queue asks. Runs on the event loop. */
+static void http_update_accepting()
+{
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+    LOCK(g_bound_sockets_mutex);
+    const bool paused = g_accept_paused;
+    for (evhttp_bound_socket* socket : boundSockets) {
+        evconnlistener* listener = evhttp_bound_socket_get_listener(socket);
+        if (paused) {
+            evconnlistener_disable(listener);
+        } else {
+            evconnlistener_enable(listener);
+        }
+    }
+#endif
+}
+
 /** Callback to reject HTTP requests after shutdown. */
 static void http_reject_request_cb(struct evhttp_request* req, void*)
 {
@@ -320,11 +331,13 @@ static bool HTTPBindAddresses(struct evhttp* http)
             if (i->first.empty() || (LookupHost(i->first, addr, false) && addr.IsBindAny())) {
                 LogPrintf("WARNING: the RPC server is not safe to expose to untrusted networks such as the public internet\n");
             }
+            LOCK(g_bound_sockets_mutex);
             boundSockets.push_back(bind_handle);
         } else {
             LogPrintf("Binding RPC on address %s port %i failed.\n", i->first, i->second);
         }
     }
+    LOCK(g_bound_sockets_mutex);
     return !boundSockets.empty();
 }
 
@@ -332,6 +345,7 @@ static bool HTTPBindAddresses(struct evhttp* http)
 static void HTTPWorkQueueRun(WorkQueue<HTTPClosure>* queue, int worker_num)
 {
     util::ThreadRename(strprintf("httpworker.%i", worker_num));
+    g_worker_queue = queue;
     queue->Run();
 }
 
@@ -389,16 +403,41 @@ bool InitHTTPServer()
     }
 
     LogPrint(BCLog::HTTP, "Initialized HTTP server\n");
-    int workQueueDepth = std::max((long)gArgs.GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
-
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    if (gArgs.IsArgSet("-rpcworkqueue")) {
+        LogPrintf("WARNING: -rpcworkqueue is deprecated and ignored, the work queue is limited by -rpcworkqueuemem\n");
+    }
+    const size_t workQueueMem = std::max((int64_t)gArgs.GetArg("-rpcworkqueuemem", DEFAULT_HTTP_WORKQUEUE_MEM), int64_t{1}) << 20;
+    const int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
+    LogPrintf("HTTP: creating work queue of %d MiB\n", workQueueMem >> 20);
+
+    // As many workers may park as there are spare ones, see StartHTTPServer.
+    workQueue = new WorkQueue<HTTPClosure>(workQueueMem, rpcThreads, rpcThreads, [](bool paused) {
+        LogPrint(BCLog::HTTP, "%s accepting connections, work queue %s\n", paused ? "Stopped" : "Resumed", paused ? "full" : "drained");
+        g_accept_paused = paused;
+        HTTPEvent* ev = new HTTPEvent(eventBase, true, http_update_accepting);
+        ev->trigger(nullptr);
+    });
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
     return true;
 }
 
+std::optional<HTTPWorkQueueStats> GetHTTPWorkQueueStats()
+{
+    if (!workQueue) return std::nullopt;
+    return workQueue->GetStats();
+}
+
+HTTPWorkerParkScope::HTTPWorkerParkScope() : m_parked(g_worker_queue != nullptr && g_worker_queue->Park())
+{
+}
+
+HTTPWorkerParkScope::~HTTPWorkerParkScope()
+{
+    if (m_parked) g_worker_queue->Unpark();
+}
+
 bool UpdateHTTPServerLogging(bool enable) {
 #if LIBEVENT_VERSION_NUMBER >= cx02010100
     if (enable) {
@@ -420,10 +459,11 @@ void StartHTTPServer()
 {
     LogPrint(BCLog::HTTP, "Starting HTTP server\n");
     int rpcThreads = std::max((long)gArgs.GetArg("-rpcthreads", DEFAULT_HTTP_THREADS), 1L);
-    LogPrintf("HTTP: starting %d worker threads\n", rpcThreads);
+    // As many spare workers, to take the place of parked ones.
+    LogPrintf("HTTP: starting %d worker threads\n", 2 * rpcThreads);
     g_thread_http = std::thread(ThreadHTTP, eventBase);
 
-    for (int i = 0; i < rpcThreads; i++) {
+    for (int i = 0; i < 2 * rpcThreads; i++) {
         g_thread_http_workers.emplace_back(HTTPWorkQueueRun, workQueue, i);
     }
 }
@@ -453,10 +493,13 @@ void StopHTTPServer()
     }
     // Unlisten sockets, these are what make the event loop running, which means
     // that after this and all connections are closed the event loop will quit.
-    for (evhttp_bound_socket *socket : boundSockets) {
-        evhttp_del_accept_socket(eventHTTP, socket);
+    {
+        LOCK(g_bound_sockets_mutex);
+        for (evhttp_bound_socket *socket : boundSockets) {
+            evhttp_del_accept_socket(eventHTTP, socket);
+        }
+        boundSockets.clear();
     }
-    boundSockets.clear();
     if (eventBase) {
         LogPrint(BCLog::HTTP, "Waiting for HTTP event thread to exit\n");
         if (g_thread_http.joinable()) g_thread_http.join();
@@ -509,7 +552,10 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, bool _replySent) : req(_re
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (!replySent && m_chunked) {
+        LogPrintf("%s: Unfinished chunked reply\n", __func__);
+        EndChunkedReply(false);
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -562,7 +608,7 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
  */
 void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
 {
-    assert(!replySent && req);
+    assert(!replySent && req && !m_chunked);
     if (ShutdownRequested()) {
         WriteHeader("Connection", "close");
     }
@@ -575,15 +621,117 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
         // Re-enable reading from the socket. This is the second part of the libevent
         // workaround above.
-        if (event_get_version_number() >= cx02010600 && event_get_version_number() < cx02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
+        http_resume_reading(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/** Called when a connection with a chunked reply in progress is closed. */
+static void http_chunked_reply_close_cb(struct evhttp_connection*, void* arg)
+{
+    HTTPChunkedReply* chunked = static_cast<HTTPChunkedReply*>(arg);
+    LOCK(chunked->cs);
+    chunked->closed = true;
+    chunked->cond.notify_all();
+}
+
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+/** Called when the chunks of a reply passed to libevent have been written to the socket. */
+static void http_chunk_sent_cb(struct evhttp_connection*, void* arg)
+{
+    HTTPChunkedReply* chunked = static_cast<HTTPChunkedReply*>(arg);
+    LOCK(chunked->cs);
+    chunked->unsent -= chunked->buffered;
+    chunked->buffered = 0;
+    chunked->cond.notify_all();
+}
+#endif
+
+/* Like WriteReply, the parts of a chunked reply are sent from the main http
+ * thread, in the order in which the events for them are triggered.
+ */
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && req && !m_chunked);
+    if (ShutdownRequested()) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked = std::make_shared<HTTPChunkedReply>();
+    auto req_copy = req;
+    auto chunked = m_chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked, nStatus]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (!conn) {
+            // The client went away while the request was handled.
+            http_chunked_reply_close_cb(nullptr, chunked.get());
+            return;
+        }
+        evhttp_connection_set_closecb(conn, http_chunked_reply_close_cb, chunked.get());
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(Span<const char> chunk)
+{
+    assert(!replySent && m_chunked);
+    {
+        LOCK(m_chunked->cs);
+        if (m_chunked->closed) return false;
+        m_chunked->unsent += chunk.size();
+    }
+    auto req_copy = req;
+    auto chunked = m_chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked, data = std::string(chunk.begin(), chunk.end())]{
+        // Without a connection, evhttp_send_reply_chunk does nothing.
+        if (evhttp_request_get_connection(req_copy)) {
+            struct evbuffer* evb = evbuffer_new();
+            evbuffer_add(evb, data.data(), data.size());
+#if LIBEVENT_VERSION_NUMBER >= 0x02010100
+            chunked->buffered += data.size();
+            evhttp_send_reply_chunk_with_cb(req_copy, evb, http_chunk_sent_cb, chunked.get());
+            evbuffer_free(evb);
+            return;
+#else
+            // Older libevent can not tell when the chunk was written, so only
+            // what was not passed to it yet counts.
+            evhttp_send_reply_chunk(req_copy, evb);
+            evbuffer_free(evb);
+#endif
+        }
+        LOCK(chunked->cs);
+        chunked->unsent -= data.size();
+        chunked->cond.notify_all();
+    });
+    ev->trigger(nullptr);
+
+    WAIT_LOCK(m_chunked->cs, lock);
+    while (!m_chunked->closed && m_chunked->unsent > MAX_CHUNKED_REPLY_UNSENT) {
+        m_chunked->cond.wait(lock);
+    }
+    return !m_chunked->closed;
+}
+
+void HTTPRequest::EndChunkedReply(bool complete)
+{
+    assert(!replySent && m_chunked);
+    auto req_copy = req;
+    auto chunked = m_chunked;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, chunked, complete]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+            if (!complete) {
+                // Frees the request too.
+                evhttp_connection_free(conn);
+                return;
             }
         }
+        // Before the reply is ended, as that may free the request.
+        http_resume_reading(req_copy);
+        evhttp_send_reply_end(req_copy);
     });
     ev->trigger(nullptr);
     replySent = true;
@@ -649,3 +797,19 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
         pathHandlers.erase(i);
     }
 }
+
+void SetHTTPAuthUserFunction(const HTTPAuthUserFunction& func)
+{
+    LOCK(g_auth_user_mutex);
+    g_auth_user_func = func;
+}
+
+std::string HTTPClientKey(const CService& peer, const std::string& auth_user)
+{
+    // Per address rather than per connection, so that a client does not get
+    // a turn for each of its connections. Local clients all share an address,
+    // so they are told apart by the user they authenticate as. Addresses never
+    // contain a space, so they cannot be mistaken for a user.
+    if (peer.IsLocal() && !auth_user.empty()) return "user " + auth_user;
+    return peer.ToStringIP();
+}
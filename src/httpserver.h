@@ -5,17 +5,25 @@
 #ifndef chymera_HTTPSERVER_H
 #define chymera_HTTPSERVER_H
 
+#include <span.h>
+
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <functional>
+#include <memory>
+#include <optional>
 
 static const int DEFAULT_HTTP_THREADS=4;
-static const int DEFAULT_HTTP_WORKQUEUE=16;
+//! Default for -rpcworkqueuemem, in MiB
+static const int DEFAULT_HTTP_WORKQUEUE_MEM=16;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
 struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+struct HTTPChunkedReply;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -31,6 +39,49 @@ void InterruptHTTPServer();
 /** Stop HTTP server */
 void StopHTTPServer();
 
+/** State of the queue of HTTP requests waiting for a worker */
+struct HTTPWorkQueueStats
+{
+    size_t queued{0};
+    size_t queued_bytes{0};
+    size_t max_bytes{0};
+    //! Clients with queued requests
+    size_t clients{0};
+    //! Workers handling a request, not counting parked ones
+    int active{0};
+    int parked{0};
+    //! Whether new connections are not accepted until the queue drains
+    bool paused{false};
+    uint64_t dispatched{0};
+    uint64_t rejected{0};
+    //! Time dispatched requests spent in the queue
+    std::chrono::microseconds total_wait{0};
+    std::chrono::microseconds max_wait{0};
+};
+
+/** Return the state of the work queue, if the HTTP server is running */
+std::optional<HTTPWorkQueueStats> GetHTTPWorkQueueStats();
+
+/**
+ * Park the current HTTP worker while in scope, for handlers that wait for an
+ * event for a long time, like a new block. Another worker takes its place, so
+ * that it does not count against -rpcthreads. There are -rpcthreads spare
+ * workers, so as many workers can park at the same time; beyond that, the
+ * worker keeps counting against -rpcthreads while waiting. Does nothing
+ * outside of HTTP workers.
+ */
+class HTTPWorkerParkScope
+{
+public:
+    HTTPWorkerParkScope();
+    ~HTTPWorkerParkScope();
+    HTTPWorkerParkScope(const HTTPWorkerParkScope&) = delete;
+    HTTPWorkerParkScope& operator=(const HTTPWorkerParkScope&) = delete;
+
+private:
+    const bool m_parked;
+};
+
 /** Change logging level for libevent. Removes BCLog::LIBEVENT from log categories if
  * libevent doesn't support debug logging.*/
 bool UpdateHTTPServerLogging(bool enable);
@@ -45,6 +96,15 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Return the user a request authenticates as, or an empty string */
+typedef std::function<std::string(const HTTPRequest& req)> HTTPAuthUserFunction;
+/** Set how to find the user of requests from local clients, which are queued per user */
+void SetHTTPAuthUserFunction(const HTTPAuthUserFunction& func);
+/** Return the client a request is queued for: the address of the peer, or for
+ * local peers, the user the request authenticates as if any.
+ */
+std::string HTTPClientKey(const CService& peer, const std::string& auth_user);
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -58,6 +118,8 @@ class HTTPRequest
 private:
     struct evhttp_request* req;
     bool replySent;
+    //! Set while a chunked reply is being sent.
+    std::shared_ptr<HTTPChunkedReply> m_chunked;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, bool replySent = false);
@@ -113,6 +175,32 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a reply whose body is sent in parts with WriteReplyChunk, as it is
+     * produced, so that large replies need not be held in memory at once.
+     *
+     * @note Call this instead of WriteReply, after any WriteHeader calls, and
+     * finish the reply with EndChunkedReply.
+     */
+    void StartChunkedReply(int nStatus);
+
+    /**
+     * Send part of the body of a chunked reply. Blocks while too much of the
+     * reply is still waiting to be sent to the client.
+     *
+     * @returns false if the client has gone away, in which case the rest of
+     * the reply may as well not be produced.
+     */
+    bool WriteReplyChunk(Span<const char> chunk);
+
+    /**
+     * Finish a chunked reply. If complete is false, the connection is closed
+     * instead, so that the client can tell that the reply was cut short.
+     *
+     * @note As with WriteReply, do not call any other methods after this.
+     */
+    void EndChunkedReply(bool complete = true);
 };
 
 /** Event handler closure.
@@ -0,0 +1,189 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_HTTPWORKQUEUE_H
+#define chymera_HTTPWORKQUEUE_H
+
+#include <httpserver.h>
+#include <sync.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+/** Work queue for distributing work over multiple threads.
+ * Work items are simply callable objects.
+ *
+ * Items are queued per client, and taken from the clients in turn, so that
+ * a client sending many requests at once does not hold up the requests of
+ * others. The queue is bounded by the memory its items take rather than by
+ * their number: beyond maxBytes items are rejected, and beyond half of that
+ * the queue is paused, which asks the server to stop accepting connections
+ * until it has drained to a quarter.
+ *
+ * Up to maxActive threads run items at the same time. A thread that waits for
+ * a long time in an item can park, and another thread takes its place. Up to
+ * maxParked threads park at the same time, so running maxActive + maxParked
+ * threads always leaves one to take the place of a parked thread.
+ */
+template <typename WorkItem>
+class WorkQueue
+{
+private:
+    struct QueuedItem {
+        std::unique_ptr<WorkItem> item;
+        size_t bytes;
+        std::chrono::steady_clock::time_point queued;
+    };
+
+    Mutex cs;
+    std::condition_variable cond GUARDED_BY(cs);
+    //! Queued items of each client with any.
+    std::map<std::string, std::deque<QueuedItem>> queues GUARDED_BY(cs);
+    //! Clients with queued items, in the order in which they are served.
+    std::deque<std::string> clients GUARDED_BY(cs);
+    size_t queuedItems GUARDED_BY(cs){0};
+    size_t queuedBytes GUARDED_BY(cs){0};
+    bool running GUARDED_BY(cs);
+    bool paused GUARDED_BY(cs){false};
+    //! Threads running an item, not counting parked ones.
+    int active GUARDED_BY(cs){0};
+    int parked GUARDED_BY(cs){0};
+    uint64_t dispatched GUARDED_BY(cs){0};
+    uint64_t rejected GUARDED_BY(cs){0};
+    std::chrono::microseconds totalWait GUARDED_BY(cs){0};
+    std::chrono::microseconds maxWait GUARDED_BY(cs){0};
+    const size_t maxBytes;
+    const int maxActive;
+    const int maxParked;
+    //! Called with the new state when the queue is paused or resumed, with cs held.
+    const std::function<void(bool)> onPause;
+
+public:
+    WorkQueue(size_t _maxBytes, int _maxActive, int _maxParked, std::function<void(bool)> _onPause) : running(true),
+                                 maxBytes(_maxBytes),
+                                 maxActive(_maxActive),
+                                 maxParked(_maxParked),
+                                 onPause(std::move(_onPause))
+    {
+    }
+    /** Precondition: worker threads have all stopped (they have been joined).
+     */
+    ~WorkQueue()
+    {
+    }
+    /** Enqueue a work item of the given client, taking about bytes of memory.
+     * Returns false if the queue is full, in which case the caller keeps ownership of item.
+     */
+    bool Enqueue(WorkItem* item, const std::string& client, size_t bytes)
+    {
+        LOCK(cs);
+        // An item larger than the whole queue is still accepted into an empty one.
+        if (queuedItems > 0 && queuedBytes + bytes > maxBytes) {
+            ++rejected;
+            return false;
+        }
+        std::deque<QueuedItem>& client_queue = queues[client];
+        if (client_queue.empty()) clients.push_back(client);
+        client_queue.push_back({std::unique_ptr<WorkItem>(item), bytes, std::chrono::steady_clock::now()});
+        ++queuedItems;
+        queuedBytes += bytes;
+        if (!paused && queuedBytes > maxBytes / 2) {
+            paused = true;
+            onPause(true);
+        }
+        cond.notify_one();
+        return true;
+    }
+    /** Thread function */
+    void Run()
+    {
+        while (true) {
+            std::unique_ptr<WorkItem> i;
+            {
+                WAIT_LOCK(cs, lock);
+                while (running && (clients.empty() || active >= maxActive))
+                    cond.wait(lock);
+                if (!running)
+                    break;
+                std::deque<QueuedItem>& client_queue = queues[clients.front()];
+                QueuedItem queued = std::move(client_queue.front());
+                client_queue.pop_front();
+                if (client_queue.empty()) {
+                    queues.erase(clients.front());
+                } else {
+                    clients.push_back(clients.front());
+                }
+                clients.pop_front();
+                --queuedItems;
+                queuedBytes -= queued.bytes;
+                if (paused && queuedBytes <= maxBytes / 4) {
+                    paused = false;
+                    onPause(false);
+                }
+                const auto wait = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - queued.queued);
+                ++dispatched;
+                totalWait += wait;
+                maxWait = std::max(maxWait, wait);
+                ++active;
+                i = std::move(queued.item);
+            }
+            (*i)();
+            i.reset();
+            LOCK(cs);
+            --active;
+            cond.notify_one();
+        }
+    }
+    /** Let another thread run items while the calling one waits in an item.
+     * Returns false, and the calling thread keeps counting against maxActive,
+     * if maxParked threads are parked already. Call Unpark if it returns true.
+     */
+    bool Park()
+    {
+        LOCK(cs);
+        if (parked >= maxParked) return false;
+        --active;
+        ++parked;
+        cond.notify_one();
+        return true;
+    }
+    void Unpark()
+    {
+        LOCK(cs);
+        ++active;
+        --parked;
+    }
+    /** Interrupt and exit loops */
+    void Interrupt()
+    {
+        LOCK(cs);
+        running = false;
+        cond.notify_all();
+    }
+    HTTPWorkQueueStats GetStats()
+    {
+        LOCK(cs);
+        HTTPWorkQueueStats stats;
+        stats.queued = queuedItems;
+        stats.queued_bytes = queuedBytes;
+        stats.max_bytes = maxBytes;
+        stats.clients = clients.size();
+        stats.active = active;
+        stats.parked = parked;
+        stats.paused = paused;
+        stats.dispatched = dispatched;
+        stats.rejected = rejected;
+        stats.total_wait = totalWait;
+        stats.max_wait = maxWait;
+        return stats;
+    }
+};
+
+#endif // chymera_HTTPWORKQUEUE_H
@@ -0,0 +1,71 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_NODE_BLOCKSTATS_H
+#define chymera_NODE_BLOCKSTATS_H
+
+#include <amount.h>
+#include <serialize.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockUndo;
+
+static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
+
+/**
+ * The statistics of a block reported by getblockstats, other than those taken
+ * from its header and height. They only depend on the block and the outputs it
+ * spends, so they can be computed once when the block is connected.
+ */
+struct CBlockStats
+{
+    int64_t txs{0};
+    int64_t ins{0};
+    int64_t outs{0};
+    CAmount total_out{0};
+    CAmount totalfee{0};
+    CAmount minfee{0};
+    CAmount maxfee{0};
+    CAmount medianfee{0};
+    //! Feerates in satoshis per virtual byte
+    CAmount minfeerate{0};
+    CAmount maxfeerate{0};
+    CAmount feerate_percentiles[NUM_GETBLOCKSTATS_PERCENTILES]{};
+    int64_t total_size{0};
+    int64_t mintxsize{0};
+    int64_t maxtxsize{0};
+    int64_t mediantxsize{0};
+    int64_t total_weight{0};
+    int64_t swtxs{0};
+    int64_t swtotal_size{0};
+    int64_t swtotal_weight{0};
+    int64_t utxo_size_inc{0};
+
+    SERIALIZE_METHODS(CBlockStats, obj)
+    {
+        READWRITE(obj.txs, obj.ins, obj.outs, obj.total_out, obj.totalfee);
+        READWRITE(obj.minfee, obj.maxfee, obj.medianfee, obj.minfeerate, obj.maxfeerate);
+        for (auto& feerate : obj.feerate_percentiles) {
+            READWRITE(feerate);
+        }
+        READWRITE(obj.total_size, obj.mintxsize, obj.maxtxsize, obj.mediantxsize, obj.total_weight);
+        READWRITE(obj.swtxs, obj.swtotal_size, obj.swtotal_weight, obj.utxo_size_inc);
+    }
+};
+
+/**
+ * Compute the statistics of a block.
+ * @param[in] block_undo  the outputs spent by block
+ * @returns false if block_undo does not match block
+ */
+bool ComputeBlockStats(const CBlock& block, const CBlockUndo& block_undo, CBlockStats& stats);
+
+/** Used by getblockstats to get feerates at different percentiles by weight  */
+void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
+
+#endif // chymera_NODE_BLOCKSTATS_H
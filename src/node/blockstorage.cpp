@@ -11,6 +11,7 @@
 #include <flatfile.h>
 #include <fs.h>
 #include <hash.h>
+#include <primitives/block_view.h>
 #include <pow.h>
 #include <shutdown.h>
 #include <signet.h>
@@ -457,6 +458,28 @@ bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex
     return ReadRawBlockFromDisk(block, block_pos, message_start);
 }
 
+bool ReadBlockViewFromDisk(std::vector<uint8_t>& block_data, std::optional<CBlockView>& block, const CBlockIndex* pindex, const CChainParams& params)
+{
+    block.reset();
+    if (!ReadRawBlockFromDisk(block_data, pindex, params.MessageStart())) {
+        return false;
+    }
+    try {
+        block.emplace(MakeByteSpan(block_data));
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pindex->ToString());
+    }
+    if (block->GetHash() != pindex->GetBlockHash()) {
+        block.reset();
+        return error("%s: GetHash() doesn't match index for %s", __func__, pindex->ToString());
+    }
+    if (!CheckProofOfWork(block->GetHash(), block->GetHeader().nBits, params.GetConsensus())) {
+        block.reset();
+        return error("%s: Errors in block header at %s", __func__, pindex->ToString());
+    }
+    return true;
+}
+
 /** Store block on disk. If dbp is non-nullptr, the file is known to already reside on disk */
 FlatFilePos SaveBlockToDisk(const CBlock& block, int nHeight, CChain& active_chain, const CChainParams& chainparams, const FlatFilePos* dbp)
 {
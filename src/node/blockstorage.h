@@ -6,6 +6,7 @@
 #define chymera_NODE_BLOCKSTORAGE_H
 
 #include <cstdint>
+#include <optional>
 #include <vector>
 
 #include <fs.h>
@@ -17,6 +18,7 @@ class CBlock;
 class CBlockFileInfo;
 class CBlockIndex;
 class CBlockUndo;
+class CBlockView;
 class CChain;
 class CChainParams;
 class ChainstateManager;
@@ -70,6 +72,12 @@ bool ReadBlockFromDisk(CBlock& block, const FlatFilePos& pos, const Consensus::P
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const FlatFilePos& pos, const CMessageHeader::MessageStartChars& message_start);
 bool ReadRawBlockFromDisk(std::vector<uint8_t>& block, const CBlockIndex* pindex, const CMessageHeader::MessageStartChars& message_start);
+/**
+ * Read a block into block_data and parse it in place into block, with the
+ * checks of ReadBlockFromDisk() but without deserializing its transactions.
+ * block refers to block_data, which must outlive it.
+ */
+bool ReadBlockViewFromDisk(std::vector<uint8_t>& block_data, std::optional<CBlockView>& block, const CBlockIndex* pindex, const CChainParams& params);
 
 bool UndoReadFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
 bool WriteUndoDataForBlock(const CBlockUndo& blockundo, BlockValidationState& state, CBlockIndex* pindex, const CChainParams& chainparams);
@@ -14,7 +14,16 @@
 #include <util/system.h>
 #include <validation.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <map>
+#include <stdexcept>
+#include <type_traits>
+
+/** Maximum number of threads scanning the UTXO set for an order-independent hash. */
+static constexpr int MAX_UTXO_STATS_THREADS{16};
 
 // Database-independent metric indicating the UTXO set size
 uint64_t GetBogoSize(const CScript& script_pub_key)
@@ -87,38 +96,51 @@ static void ApplyStats(CCoinsStats& stats, const uint256& hash, const std::map<u
     }
 }
 
-//! Calculate statistics about the unspent transaction output set
-template <typename T>
-static bool GetUTXOStats(CCoinsView* view, BlockManager& blockman, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point, const CBlockIndex* pindex)
+static void MergeHash(MuHash3072& muhash, const MuHash3072& partial)
 {
-    std::unique_ptr<CCoinsViewCursor> pcursor(view->Cursor());
-    assert(pcursor);
+    muhash *= partial;
+}
 
-    if (!pindex) {
-        {
-            LOCK(cs_main);
-            assert(std::addressof(g_chainman.m_blockman) == std::addressof(blockman));
-            pindex = blockman.LookupBlockIndex(view->GetBestBlock());
-        }
-    }
-    stats.nHeight = Assert(pindex)->nHeight;
-    stats.hashBlock = pindex->GetBlockHash();
+static void MergeHash(std::nullptr_t, std::nullptr_t) {}
 
-    // Use CoinStatsIndex if it is requested and available and a hash_type of Muhash or None was requested
-    if ((stats.m_hash_type == CoinStatsHashType::MUHASH || stats.m_hash_type == CoinStatsHashType::NONE) && g_coin_stats_index && stats.index_requested) {
-        stats.index_used = true;
-        return g_coin_stats_index->LookUpStats(pindex, stats);
+static void MergeStats(CCoinsStats& stats, const CCoinsStats& partial)
+{
+    stats.nTransactions += partial.nTransactions;
+    stats.nTransactionOutputs += partial.nTransactionOutputs;
+    stats.nBogoSize += partial.nBogoSize;
+    stats.nTotalAmount += partial.nTotalAmount;
+    stats.coins_count += partial.coins_count;
+}
+
+//! Get the cursors to scan the UTXO set with. MuHash and the plain statistics
+//! do not depend on the order of the coins, so they are computed over
+//! partitions of the set in parallel. The serialized hash needs a single cursor.
+template <typename T>
+static std::vector<std::unique_ptr<CCoinsViewCursor>> GetCursors(CCoinsView* view, const T&)
+{
+    if constexpr (!std::is_same_v<T, CHashWriter>) {
+        const int n_threads = std::clamp(GetNumCores(), 1, MAX_UTXO_STATS_THREADS);
+        if (n_threads > 1) {
+            auto cursors = view->PartitionedCursors(n_threads);
+            if (!cursors.empty()) return cursors;
+        }
     }
 
-    PrepareHash(hash_obj, stats);
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.emplace_back(view->Cursor());
+    return cursors;
+}
 
+template <typename T>
+static bool ScanCoins(CCoinsViewCursor& cursor, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point)
+{
     uint256 prevkey;
     std::map<uint32_t, Coin> outputs;
-    while (pcursor->Valid()) {
+    while (cursor.Valid()) {
         interruption_point();
         COutPoint key;
         Coin coin;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
             if (!outputs.empty() && key.hash != prevkey) {
                 ApplyStats(stats, prevkey, outputs);
                 ApplyHash(hash_obj, prevkey, outputs);
@@ -130,12 +152,95 @@ static bool GetUTXOStats(CCoinsView* view, BlockManager& blockman, CCoinsStats&
         } else {
             return error("%s: unable to read value", __func__);
         }
-        pcursor->Next();
+        cursor.Next();
     }
     if (!outputs.empty()) {
         ApplyStats(stats, prevkey, outputs);
         ApplyHash(hash_obj, prevkey, outputs);
     }
+    return true;
+}
+
+//! Scan every partition on its own thread into partial statistics and a
+//! partial hash, then merge them. interruption_point is only called from the
+//! calling thread; the workers are stopped if it throws.
+template <typename T>
+static bool ScanCoinsParallel(const std::vector<std::unique_ptr<CCoinsViewCursor>>& cursors, CCoinsStats& stats, T& hash_obj, const std::function<void()>& interruption_point)
+{
+    std::vector<CCoinsStats> partial_stats(cursors.size(), CCoinsStats{stats.m_hash_type});
+    std::vector<T> partial_hashes(cursors.size());
+
+    std::atomic<bool> abort{false};
+    const std::function<void()> abort_point = [&abort] {
+        if (abort) throw std::runtime_error("UTXO set scan aborted");
+    };
+
+    // Declared outside of the try block so that the workers are waited for
+    // (by the future destructors) after abort has been set.
+    std::vector<std::future<bool>> results;
+    try {
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            results.push_back(std::async(std::launch::async, [&, i] {
+                try {
+                    return ScanCoins(*cursors[i], partial_stats[i], partial_hashes[i], abort_point);
+                } catch (const std::exception&) {
+                    return false;
+                }
+            }));
+        }
+        for (auto& result : results) {
+            while (result.wait_for(std::chrono::milliseconds{100}) != std::future_status::ready) {
+                interruption_point();
+            }
+        }
+    } catch (...) {
+        abort = true;
+        throw;
+    }
+
+    bool success{true};
+    for (auto& result : results) {
+        success &= result.get();
+    }
+    if (!success) return false;
+
+    for (size_t i = 0; i < cursors.size(); ++i) {
+        MergeStats(stats, partial_stats[i]);
+        MergeHash(hash_obj, partial_hashes[i]);
+    }
+    return true;
+}
+
+//! Calculate statistics about the unspent transaction output set
+template <typename T>
+static bool GetUTXOStats(CCoinsView* view, BlockManager& blockman, CCoinsStats& stats, T hash_obj, const std::function<void()>& interruption_point, const CBlockIndex* pindex)
+{
+    const std::vector<std::unique_ptr<CCoinsViewCursor>> cursors{GetCursors(view, hash_obj)};
+    assert(!cursors.empty() && cursors.front());
+
+    if (!pindex) {
+        {
+            LOCK(cs_main);
+            assert(std::addressof(g_chainman.m_blockman) == std::addressof(blockman));
+            pindex = blockman.LookupBlockIndex(view->GetBestBlock());
+        }
+    }
+    stats.nHeight = Assert(pindex)->nHeight;
+    stats.hashBlock = pindex->GetBlockHash();
+
+    // Use CoinStatsIndex if it is requested and available and a hash_type of Muhash or None was requested
+    if ((stats.m_hash_type == CoinStatsHashType::MUHASH || stats.m_hash_type == CoinStatsHashType::NONE) && g_coin_stats_index && stats.index_requested) {
+        stats.index_used = true;
+        return g_coin_stats_index->LookUpStats(pindex, stats);
+    }
+
+    PrepareHash(hash_obj, stats);
+
+    if (cursors.size() == 1) {
+        if (!ScanCoins(*cursors.front(), stats, hash_obj, interruption_point)) return false;
+    } else if constexpr (!std::is_same_v<T, CHashWriter>) {
+        if (!ScanCoinsParallel(cursors, stats, hash_obj, interruption_point)) return false;
+    }
 
     FinalizeHash(hash_obj, stats);
 
@@ -10,6 +10,8 @@
 #include <serialize.h>
 #include <uint256.h>
 
+#include <algorithm>
+
 /** Nodes collect new transactions into a block, hash them into a hash tree,
  * and scan through nonce values to make the block's hash satisfy proof-of-work
  * requirements.  When they solve the proof-of-work, they broadcast the block
@@ -59,6 +61,31 @@ public:
 };
 
 
+/** Formatter for the transactions of a block. Deserialization reads all of
+ *  them before building the CTransactions, so that their txids and wtxids are
+ *  computed in one batch by MakeTransactionRefs. */
+struct BlockTransactionsFormatter
+{
+    template <typename Stream>
+    void Ser(Stream& s, const std::vector<CTransactionRef>& vtx)
+    {
+        s << vtx;
+    }
+
+    template <typename Stream>
+    void Unser(Stream& s, std::vector<CTransactionRef>& vtx)
+    {
+        const uint64_t count = ReadCompactSize(s);
+        std::vector<CMutableTransaction> txs;
+        // Don't trust the announced count for the allocation.
+        txs.reserve(std::min<uint64_t>(count, 1024));
+        for (uint64_t i = 0; i < count; ++i) {
+            txs.emplace_back(deserialize, s);
+        }
+        vtx = MakeTransactionRefs(std::move(txs));
+    }
+};
+
 class CBlock : public CBlockHeader
 {
 public:
@@ -82,7 +109,7 @@ public:
     SERIALIZE_METHODS(CBlock, obj)
     {
         READWRITEAS(CBlockHeader, obj);
-        READWRITE(obj.vtx);
+        READWRITE(Using<BlockTransactionsFormatter>(obj.vtx));
     }
 
     void SetNull()
@@ -0,0 +1,107 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block_view.h>
+
+#include <crypto/sha256.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+
+CBlockView::CBlockView(Span<const std::byte> data) : m_data(data)
+{
+    SpanReader reader(data);
+    m_header.nVersion = int32_t(reader.ReadLE32());
+    std::memcpy(m_header.hashPrevBlock.begin(), reader.Take(32).data(), 32);
+    std::memcpy(m_header.hashMerkleRoot.begin(), reader.Take(32).data(), 32);
+    m_header.nTime = reader.ReadLE32();
+    m_header.nBits = reader.ReadLE32();
+    m_header.nNonce = reader.ReadLE32();
+
+    const uint64_t count = reader.ReadCompactSize();
+    // Don't trust the announced count for the allocation.
+    m_vtx.reserve(std::min<uint64_t>(count, 1024));
+    for (uint64_t i = 0; i < count; ++i) {
+        m_vtx.emplace_back(reader);
+    }
+    if (!reader.empty()) {
+        throw std::ios_base::failure("CBlockView: trailing data");
+    }
+}
+
+namespace {
+/** Double SHA256 every message into hashes, with SHA256DMulti. */
+void HashMessages(std::vector<uint256>& hashes, const std::vector<Span<const std::byte>>& messages)
+{
+    hashes.resize(messages.size());
+    std::vector<unsigned char*> outputs(messages.size());
+    std::vector<const unsigned char*> inputs(messages.size());
+    std::vector<size_t> lengths(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        outputs[i] = hashes[i].begin();
+        inputs[i] = reinterpret_cast<const unsigned char*>(messages[i].data());
+        lengths[i] = messages[i].size();
+    }
+    SHA256DMulti(outputs.data(), inputs.data(), lengths.data(), messages.size());
+}
+} // namespace
+
+std::vector<uint256> CBlockView::GetTxHashes() const
+{
+    // The serialization of a transaction without witness is contiguous in
+    // the block unless it has a witness; those are gathered into one buffer.
+    std::vector<std::byte> stripped;
+    stripped.reserve(GetStrippedSize());
+    std::vector<Span<const std::byte>> messages;
+    messages.reserve(m_vtx.size());
+    for (const auto& tx : m_vtx) {
+        if (!tx.HasWitness()) {
+            messages.push_back(tx.GetSerialization());
+            continue;
+        }
+        const size_t start = stripped.size();
+        for (const auto& segment : tx.GetStrippedSegments()) {
+            stripped.insert(stripped.end(), segment.begin(), segment.end());
+        }
+        // Reserved up front, so the buffer does not move.
+        messages.emplace_back(stripped.data() + start, stripped.size() - start);
+    }
+    std::vector<uint256> hashes;
+    HashMessages(hashes, messages);
+    return hashes;
+}
+
+std::vector<uint256> CBlockView::GetWitnessHashes() const
+{
+    std::vector<Span<const std::byte>> messages;
+    messages.reserve(m_vtx.size());
+    for (const auto& tx : m_vtx) {
+        messages.push_back(tx.GetSerialization());
+    }
+    std::vector<uint256> hashes;
+    HashMessages(hashes, messages);
+    return hashes;
+}
+
+size_t CBlockView::GetStrippedSize() const
+{
+    size_t size = m_data.size();
+    for (const auto& tx : m_vtx) {
+        size -= tx.GetTotalSize() - tx.GetStrippedSize();
+    }
+    return size;
+}
+
+CBlock CBlockView::ToBlock() const
+{
+    const std::vector<uint256> txids = GetTxHashes();
+    CBlock block(m_header);
+    block.vtx.reserve(m_vtx.size());
+    for (size_t i = 0; i < m_vtx.size(); ++i) {
+        const uint256 wtxid = m_vtx[i].HasWitness() ? m_vtx[i].GetWitnessHash() : txids[i];
+        block.vtx.push_back(std::make_shared<const CTransaction>(m_vtx[i].ToMutableTransaction(), txids[i], wtxid));
+    }
+    return block;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_PRIMITIVES_BLOCK_VIEW_H
+#define chymera_PRIMITIVES_BLOCK_VIEW_H
+
+#include <primitives/block.h>
+#include <primitives/transaction_view.h>
+#include <serialize.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <vector>
+
+/**
+ * A serialized block, parsed in place. The header is copied out; the
+ * transactions are CTransactionViews into the serialized data, which must
+ * outlive the view. Parsing allocates only the vector of transaction views.
+ *
+ * Throws std::ios_base::failure on data that deserializing a CBlock would
+ * reject, and on trailing data after the last transaction.
+ */
+class CBlockView
+{
+    Span<const std::byte> m_data;
+    CBlockHeader m_header;
+    std::vector<CTransactionView> m_vtx;
+
+public:
+    //! Size of a serialized CBlockHeader.
+    static constexpr size_t HEADER_SIZE = 80;
+
+    explicit CBlockView(Span<const std::byte> data);
+
+    const CBlockHeader& GetHeader() const { return m_header; }
+    uint256 GetHash() const { return m_header.GetHash(); }
+    const std::vector<CTransactionView>& Transactions() const { return m_vtx; }
+
+    /** The txids of all transactions, hashed in one batch. */
+    std::vector<uint256> GetTxHashes() const;
+    /** The wtxids of all transactions, hashed in one batch. */
+    std::vector<uint256> GetWitnessHashes() const;
+
+    /** The serialization, with witness. */
+    Span<const std::byte> GetSerialization() const { return m_data; }
+    size_t GetTotalSize() const { return m_data.size(); }
+    size_t GetStrippedSize() const;
+
+    /** Deserialize into a CBlock, for code that needs one. */
+    CBlock ToBlock() const;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        if (s.GetVersion() & SERIALIZE_TRANSACTION_NO_WITNESS) {
+            const std::byte* const txs_begin = m_vtx.empty() ? m_data.end() : m_vtx.front().GetSerialization().begin();
+            s.write(reinterpret_cast<const char*>(m_data.data()), txs_begin - m_data.begin());
+            for (const auto& tx : m_vtx) {
+                tx.Serialize(s);
+            }
+        } else {
+            s.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+        }
+    }
+};
+
+#endif // chymera_PRIMITIVES_BLOCK_VIEW_H
@@ -5,7 +5,9 @@
 
 #include <primitives/transaction.h>
 
+#include <crypto/sha256.h>
 #include <hash.h>
+#include <streams.h>
 #include <tinyformat.h>
 #include <util/strencodings.h>
 
@@ -79,6 +81,56 @@ uint256 CTransaction::ComputeWitnessHash() const
 
 CTransaction::CTransaction(const CMutableTransaction& tx) : vin(tx.vin), vout(tx.vout), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash{ComputeHash()}, m_witness_hash{ComputeWitnessHash()} {}
 CTransaction::CTransaction(CMutableTransaction&& tx) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash{ComputeHash()}, m_witness_hash{ComputeWitnessHash()} {}
+CTransaction::CTransaction(CMutableTransaction&& tx, const uint256& hash, const uint256& witness_hash) : vin(std::move(tx.vin)), vout(std::move(tx.vout)), nVersion(tx.nVersion), nLockTime(tx.nLockTime), hash{hash}, m_witness_hash{witness_hash} {}
+
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs)
+{
+    std::vector<CTransactionRef> ret;
+    ret.reserve(txs.size());
+
+    // Without a multi-lane SHA256 (as with SHA-NI, or without AVX2), batching
+    // only adds a copy of every transaction, so each is hashed as it is built.
+    if (!SHA256MultiAvailable()) {
+        for (auto& tx : txs) {
+            ret.push_back(std::make_shared<const CTransaction>(std::move(tx)));
+        }
+        return ret;
+    }
+
+    // Serialize every transaction without witness for its txid, and again with
+    // witness for its wtxid if it has one, all into one buffer.
+    std::vector<unsigned char> buffer;
+    std::vector<size_t> offsets{0};
+    std::vector<size_t> witness_message(txs.size());
+    for (size_t i = 0; i < txs.size(); ++i) {
+        CVectorWriter(SER_GETHASH, SERIALIZE_TRANSACTION_NO_WITNESS, buffer, buffer.size(), txs[i]);
+        offsets.push_back(buffer.size());
+        if (txs[i].HasWitness()) {
+            CVectorWriter(SER_GETHASH, 0, buffer, buffer.size(), txs[i]);
+            offsets.push_back(buffer.size());
+        }
+        witness_message[i] = offsets.size() - 2;
+    }
+
+    const size_t count = offsets.size() - 1;
+    std::vector<uint256> hashes(count);
+    std::vector<unsigned char*> outputs(count);
+    std::vector<const unsigned char*> inputs(count);
+    std::vector<size_t> lengths(count);
+    for (size_t i = 0; i < count; ++i) {
+        outputs[i] = hashes[i].begin();
+        inputs[i] = buffer.data() + offsets[i];
+        lengths[i] = offsets[i + 1] - offsets[i];
+    }
+    SHA256DMulti(outputs.data(), inputs.data(), lengths.data(), count);
+
+    for (size_t i = 0; i < txs.size(); ++i) {
+        const uint256& witness_hash = hashes[witness_message[i]];
+        const uint256& hash = txs[i].HasWitness() ? hashes[witness_message[i] - 1] : witness_hash;
+        ret.push_back(std::make_shared<const CTransaction>(std::move(txs[i]), hash, witness_hash));
+    }
+    return ret;
+}
 
 CAmount CTransaction::GetValueOut() const
 {
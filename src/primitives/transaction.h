@@ -284,6 +284,8 @@ public:
     /** Convert a CMutableTransaction into a CTransaction. */
     explicit CTransaction(const CMutableTransaction& tx);
     CTransaction(CMutableTransaction&& tx);
+    /** Convert a CMutableTransaction whose txid and wtxid were already computed by the caller. */
+    CTransaction(CMutableTransaction&& tx, const uint256& hash, const uint256& witness_hash);
 
     template <typename Stream>
     inline void Serialize(Stream& s) const {
@@ -386,6 +388,12 @@ struct CMutableTransaction
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
 
+/** Convert a batch of transactions, computing all their txids and wtxids together with the multi-buffer SHA256.
+ * Each transaction is allocated on its own, not in an arena shared by the batch, as some outlive their block
+ * (in the mempool after a reorg, or in a wallet) and would otherwise keep the memory of the whole block.
+ */
+std::vector<CTransactionRef> MakeTransactionRefs(std::vector<CMutableTransaction>&& txs);
+
 /** A generic txid reference (txid or wtxid). */
 class GenTxid
 {
@@ -0,0 +1,263 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/transaction_view.h>
+
+#include <crypto/common.h>
+#include <hash.h>
+
+#include <cstring>
+#include <ios>
+#include <stdexcept>
+#include <string>
+
+namespace {
+Span<const unsigned char> UCharSpan(Span<const std::byte> s)
+{
+    return {reinterpret_cast<const unsigned char*>(s.data()), s.size()};
+}
+} // namespace
+
+Span<const std::byte> SpanReader::Take(size_t n)
+{
+    if (n > m_data.size()) {
+        throw std::ios_base::failure("SpanReader::Take(): end of data");
+    }
+    Span<const std::byte> ret = m_data.first(n);
+    m_data = m_data.subspan(n);
+    return ret;
+}
+
+uint32_t SpanReader::ReadLE32()
+{
+    return ::ReadLE32(reinterpret_cast<const unsigned char*>(Take(4).data()));
+}
+
+uint64_t SpanReader::ReadLE64()
+{
+    return ::ReadLE64(reinterpret_cast<const unsigned char*>(Take(8).data()));
+}
+
+uint64_t SpanReader::ReadCompactSize()
+{
+    const uint8_t ch_size = ReadU8();
+    uint64_t size;
+    if (ch_size < 253) {
+        size = ch_size;
+    } else if (ch_size == 253) {
+        size = ::ReadLE16(reinterpret_cast<const unsigned char*>(Take(2).data()));
+        if (size < 253) throw std::ios_base::failure("non-canonical ReadCompactSize()");
+    } else if (ch_size == 254) {
+        size = ReadLE32();
+        if (size < 0x10000u) throw std::ios_base::failure("non-canonical ReadCompactSize()");
+    } else {
+        size = ReadLE64();
+        if (size < 0x100000000ULL) throw std::ios_base::failure("non-canonical ReadCompactSize()");
+    }
+    if (size > MAX_SIZE) {
+        throw std::ios_base::failure("ReadCompactSize(): size too large");
+    }
+    return size;
+}
+
+Span<const unsigned char> SpanReader::ReadBytes()
+{
+    return UCharSpan(Take(ReadCompactSize()));
+}
+
+CScriptWitness CScriptWitnessView::ToScriptWitness() const
+{
+    CScriptWitness witness;
+    witness.stack.reserve(m_count);
+    for (const auto& item : *this) {
+        witness.stack.emplace_back(item.begin(), item.end());
+    }
+    return witness;
+}
+
+CTxIn CTxInView::ToTxIn() const
+{
+    CTxIn txin(prevout, CScript(scriptSig.begin(), scriptSig.end()), nSequence);
+    txin.scriptWitness = scriptWitness.ToScriptWitness();
+    return txin;
+}
+
+CTxOut CTxOutView::ToTxOut() const
+{
+    return CTxOut(nValue, CScript(scriptPubKey.begin(), scriptPubKey.end()));
+}
+
+CTxInView CTransactionView::InputParser::Next()
+{
+    CTxInView txin;
+    std::memcpy(txin.prevout.hash.begin(), m_inputs.Take(32).data(), 32);
+    txin.prevout.n = m_inputs.ReadLE32();
+    txin.scriptSig = m_inputs.ReadBytes();
+    txin.nSequence = m_inputs.ReadLE32();
+    if (m_has_witness) {
+        const size_t count = m_witnesses.ReadCompactSize();
+        const std::byte* const items_begin = m_witnesses.data();
+        for (size_t i = 0; i < count; ++i) m_witnesses.ReadBytes();
+        txin.scriptWitness = CScriptWitnessView({items_begin, m_witnesses.data()}, count);
+    }
+    return txin;
+}
+
+CTxOutView CTransactionView::OutputParser::Next()
+{
+    CTxOutView txout;
+    txout.nValue = CAmount(m_outputs.ReadLE64());
+    txout.scriptPubKey = m_outputs.ReadBytes();
+    return txout;
+}
+
+CTransactionView::CTransactionView(Span<const std::byte> data)
+{
+    SpanReader reader(data);
+    Parse(reader);
+    if (!reader.empty()) {
+        throw std::ios_base::failure("CTransactionView: trailing data");
+    }
+}
+
+void CTransactionView::Parse(SpanReader& reader)
+{
+    // Mirrors UnserializeTransaction() with witness allowed; see there.
+    const std::byte* const start = reader.data();
+    const auto offset = [&] { return size_t(reader.data() - start); };
+
+    m_version = int32_t(reader.ReadLE32());
+    m_vin_offset = offset();
+    m_vin_count = reader.ReadCompactSize();
+    uint8_t flags = 0;
+    bool read_outputs = true;
+    if (m_vin_count == 0) {
+        /* We read a dummy or an empty vin. */
+        flags = reader.ReadU8();
+        if (flags != 0) {
+            m_vin_offset = offset();
+            m_vin_count = reader.ReadCompactSize();
+        } else {
+            // The flag byte was the empty vout.
+            read_outputs = false;
+        }
+    }
+
+    m_inputs_offset = offset();
+    for (size_t i = 0; i < m_vin_count; ++i) {
+        reader.Take(36);
+        reader.ReadBytes();
+        reader.ReadLE32();
+    }
+    if (read_outputs) {
+        m_vout_count = reader.ReadCompactSize();
+    }
+    m_outputs_offset = offset();
+    for (size_t i = 0; i < m_vout_count; ++i) {
+        reader.ReadLE64();
+        reader.ReadBytes();
+    }
+
+    m_witness_offset = offset();
+    if (flags & 1) {
+        /* The witness flag is present. */
+        flags ^= 1;
+        bool any_witness = false;
+        for (size_t i = 0; i < m_vin_count; ++i) {
+            const size_t count = reader.ReadCompactSize();
+            any_witness |= count != 0;
+            for (size_t j = 0; j < count; ++j) reader.ReadBytes();
+        }
+        if (!any_witness) {
+            /* It's illegal to encode witnesses when all witness stacks are empty. */
+            throw std::ios_base::failure("Superfluous witness record");
+        }
+        m_has_witness = true;
+    }
+    if (flags) {
+        /* Unknown flag in the serialization */
+        throw std::ios_base::failure("Unknown transaction optional data");
+    }
+    m_lock_time = reader.ReadLE32();
+    m_data = {start, reader.data()};
+
+    if (m_vin_count == 1) {
+        const CTxInView first = *Inputs().begin();
+        m_is_coinbase = first.prevout.IsNull();
+    }
+}
+
+ParsedRange<CTransactionView::input_iterator> CTransactionView::Inputs() const
+{
+    InputParser parser;
+    parser.m_inputs = SpanReader(m_data.subspan(m_inputs_offset, m_outputs_offset - m_inputs_offset));
+    parser.m_witnesses = SpanReader(m_data.subspan(m_witness_offset, m_data.size() - 4 - m_witness_offset));
+    parser.m_has_witness = m_has_witness;
+    return {input_iterator(parser, m_vin_count), m_vin_count};
+}
+
+ParsedRange<CTransactionView::output_iterator> CTransactionView::Outputs() const
+{
+    OutputParser parser;
+    parser.m_outputs = SpanReader(m_data.subspan(m_outputs_offset, m_witness_offset - m_outputs_offset));
+    return {output_iterator(parser, m_vout_count), m_vout_count};
+}
+
+std::array<Span<const std::byte>, 3> CTransactionView::GetStrippedSegments() const
+{
+    return {m_data.first(4), m_data.subspan(m_vin_offset, m_witness_offset - m_vin_offset), m_data.last(4)};
+}
+
+uint256 CTransactionView::GetHash() const
+{
+    CHash256 hasher;
+    for (const auto& segment : GetStrippedSegments()) {
+        hasher.Write(UCharSpan(segment));
+    }
+    uint256 hash;
+    hasher.Finalize(hash);
+    return hash;
+}
+
+uint256 CTransactionView::GetWitnessHash() const
+{
+    if (!m_has_witness) {
+        return GetHash();
+    }
+    uint256 hash;
+    CHash256().Write(UCharSpan(m_data)).Finalize(hash);
+    return hash;
+}
+
+CAmount CTransactionView::GetValueOut() const
+{
+    CAmount nValueOut = 0;
+    for (const auto& tx_out : Outputs()) {
+        if (!MoneyRange(tx_out.nValue) || !MoneyRange(nValueOut + tx_out.nValue))
+            throw std::runtime_error(std::string(__func__) + ": value out of range");
+        nValueOut += tx_out.nValue;
+    }
+    return nValueOut;
+}
+
+CMutableTransaction CTransactionView::ToMutableTransaction() const
+{
+    CMutableTransaction mtx;
+    mtx.nVersion = m_version;
+    mtx.nLockTime = m_lock_time;
+    mtx.vin.reserve(m_vin_count);
+    for (const auto& txin : Inputs()) {
+        mtx.vin.push_back(txin.ToTxIn());
+    }
+    mtx.vout.reserve(m_vout_count);
+    for (const auto& txout : Outputs()) {
+        mtx.vout.push_back(txout.ToTxOut());
+    }
+    return mtx;
+}
+
+CTransactionRef CTransactionView::ToTransaction() const
+{
+    return std::make_shared<const CTransaction>(ToMutableTransaction(), GetHash(), GetWitnessHash());
+}
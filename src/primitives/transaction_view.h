@@ -0,0 +1,260 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_PRIMITIVES_TRANSACTION_VIEW_H
+#define chymera_PRIMITIVES_TRANSACTION_VIEW_H
+
+#include <amount.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <span.h>
+#include <uint256.h>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+
+/**
+ * Read-only views of serialized transactions.
+ *
+ * Deserializing a CTransaction allocates a vector for its inputs and outputs,
+ * a prevector for every script and a vector for every witness item. The
+ * classes here instead parse a transaction in place, over a span of its
+ * serialization (with witness), and hand out spans into it. The serialized
+ * data must outlive the view.
+ *
+ * A view accepts exactly the encodings that deserializing a CTransaction
+ * (with witness) accepts, and throws std::ios_base::failure where that would.
+ * Once constructed, none of its accessors can fail.
+ */
+
+/** Cursor over serialized data that throws std::ios_base::failure when reading past its end. */
+class SpanReader
+{
+    Span<const std::byte> m_data;
+
+public:
+    SpanReader() = default;
+    explicit SpanReader(Span<const std::byte> data) : m_data(data) {}
+
+    const std::byte* data() const { return m_data.data(); }
+    size_t size() const { return m_data.size(); }
+    bool empty() const { return m_data.empty(); }
+
+    Span<const std::byte> Take(size_t n);
+    uint8_t ReadU8() { return uint8_t(Take(1)[0]); }
+    uint32_t ReadLE32();
+    uint64_t ReadLE64();
+    /** Read a compact size with the checks of ReadCompactSize(Stream&). */
+    uint64_t ReadCompactSize();
+    /** Read a compact size prefixed byte string, like a CScript or a witness item. */
+    Span<const unsigned char> ReadBytes();
+};
+
+/** The items of a witness stack, as spans of the serialized data. */
+class CScriptWitnessView
+{
+    Span<const std::byte> m_items;
+    size_t m_count{0};
+
+public:
+    class const_iterator
+    {
+        SpanReader m_reader;
+        size_t m_remaining{0};
+        Span<const unsigned char> m_current;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Span<const unsigned char> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef const value_type& reference;
+
+        const_iterator() = default;
+        const_iterator(SpanReader reader, size_t count) : m_reader(reader), m_remaining(count)
+        {
+            if (m_remaining) m_current = m_reader.ReadBytes();
+        }
+        reference operator*() const { return m_current; }
+        pointer operator->() const { return &m_current; }
+        const_iterator& operator++()
+        {
+            if (--m_remaining) m_current = m_reader.ReadBytes();
+            return *this;
+        }
+        bool operator==(const const_iterator& other) const { return m_remaining == other.m_remaining; }
+        bool operator!=(const const_iterator& other) const { return m_remaining != other.m_remaining; }
+    };
+
+    CScriptWitnessView() = default;
+    CScriptWitnessView(Span<const std::byte> items, size_t count) : m_items(items), m_count(count) {}
+
+    bool IsNull() const { return m_count == 0; }
+    size_t size() const { return m_count; }
+    const_iterator begin() const { return const_iterator(SpanReader(m_items), m_count); }
+    const_iterator end() const { return const_iterator(); }
+
+    CScriptWitness ToScriptWitness() const;
+};
+
+/** An input of a serialized transaction. See CTxIn. */
+class CTxInView
+{
+public:
+    COutPoint prevout;
+    Span<const unsigned char> scriptSig;
+    uint32_t nSequence{0};
+    CScriptWitnessView scriptWitness;
+
+    CTxIn ToTxIn() const;
+};
+
+/** An output of a serialized transaction. See CTxOut. */
+class CTxOutView
+{
+public:
+    CAmount nValue{0};
+    Span<const unsigned char> scriptPubKey;
+
+    CTxOut ToTxOut() const;
+};
+
+/** Forward iterator over items that are parsed one at a time from serialized data. */
+template <typename Item, typename Parser>
+class ParsingIterator
+{
+    Parser m_parser;
+    size_t m_remaining{0};
+    Item m_current;
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Item value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Item* pointer;
+    typedef const Item& reference;
+
+    ParsingIterator() = default;
+    ParsingIterator(Parser parser, size_t count) : m_parser(parser), m_remaining(count)
+    {
+        if (m_remaining) m_current = m_parser.Next();
+    }
+    reference operator*() const { return m_current; }
+    pointer operator->() const { return &m_current; }
+    ParsingIterator& operator++()
+    {
+        if (--m_remaining) m_current = m_parser.Next();
+        return *this;
+    }
+    //! Only meaningful between iterators of the same range.
+    bool operator==(const ParsingIterator& other) const { return m_remaining == other.m_remaining; }
+    bool operator!=(const ParsingIterator& other) const { return m_remaining != other.m_remaining; }
+};
+
+/** A range of ParsingIterators, standing in for the vin and vout vectors of a CTransaction. */
+template <typename Iterator>
+class ParsedRange
+{
+    Iterator m_begin;
+    size_t m_size;
+
+public:
+    ParsedRange(Iterator begin, size_t size) : m_begin(begin), m_size(size) {}
+    Iterator begin() const { return m_begin; }
+    Iterator end() const { return Iterator(); }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+};
+
+/** A serialized transaction, parsed in place. See CTransaction. */
+class CTransactionView
+{
+    /** Reads the inputs, taking their witnesses from the separate witness section. */
+    struct InputParser {
+        SpanReader m_inputs;
+        SpanReader m_witnesses;
+        bool m_has_witness{false};
+        CTxInView Next();
+    };
+    /** Reads the outputs. */
+    struct OutputParser {
+        SpanReader m_outputs;
+        CTxOutView Next();
+    };
+
+    //! The whole serialization, with witness if the transaction has one.
+    Span<const std::byte> m_data;
+    int32_t m_version{0};
+    uint32_t m_lock_time{0};
+    size_t m_vin_count{0};
+    size_t m_vout_count{0};
+    //! Offset of the input count (after the marker and flag, if any).
+    size_t m_vin_offset{0};
+    //! Offset of the first input, output and witness stack.
+    size_t m_inputs_offset{0};
+    size_t m_outputs_offset{0};
+    size_t m_witness_offset{0};
+    bool m_has_witness{false};
+    bool m_is_coinbase{false};
+
+    void Parse(SpanReader& reader);
+
+public:
+    typedef ParsingIterator<CTxInView, InputParser> input_iterator;
+    typedef ParsingIterator<CTxOutView, OutputParser> output_iterator;
+
+    /** Parse the transaction at the start of reader, and advance past it. */
+    explicit CTransactionView(SpanReader& reader) { Parse(reader); }
+    /** Parse data, which must hold exactly one transaction. */
+    explicit CTransactionView(Span<const std::byte> data);
+
+    int32_t GetVersion() const { return m_version; }
+    uint32_t GetLockTime() const { return m_lock_time; }
+
+    ParsedRange<input_iterator> Inputs() const;
+    ParsedRange<output_iterator> Outputs() const;
+
+    bool IsNull() const { return m_vin_count == 0 && m_vout_count == 0; }
+    bool IsCoinBase() const { return m_is_coinbase; }
+    bool HasWitness() const { return m_has_witness; }
+
+    /**
+     * The parts of the serialization that make up the serialization without
+     * witness: the version, everything from the input count to the witness
+     * stacks, and the lock time.
+     */
+    std::array<Span<const std::byte>, 3> GetStrippedSegments() const;
+
+    /** The serialization, with witness if there is one. */
+    Span<const std::byte> GetSerialization() const { return m_data; }
+
+    /** Unlike CTransaction's, these hash the transaction on every call. */
+    uint256 GetHash() const;
+    uint256 GetWitnessHash() const;
+
+    // Return sum of txouts; throws if out of range, like CTransaction::GetValueOut().
+    CAmount GetValueOut() const;
+
+    unsigned int GetTotalSize() const { return m_data.size(); }
+    unsigned int GetStrippedSize() const { return 8 + m_witness_offset - m_vin_offset; }
+
+    /** Deserialize into a CTransaction, for code that needs one. */
+    CMutableTransaction ToMutableTransaction() const;
+    CTransactionRef ToTransaction() const;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        if (s.GetVersion() & SERIALIZE_TRANSACTION_NO_WITNESS) {
+            for (const auto& segment : GetStrippedSegments()) {
+                s.write(reinterpret_cast<const char*>(segment.data()), segment.size());
+            }
+        } else {
+            s.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+        }
+    }
+};
+
+#endif // chymera_PRIMITIVES_TRANSACTION_VIEW_H
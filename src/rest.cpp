@@ -11,25 +11,37 @@
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/jsonwriter.h>
 #include <rpc/protocol.h>
+#include <rpc/responsecache.h>
 #include <rpc/server.h>
 #include <streams.h>
 #include <sync.h>
 #include <txmempool.h>
+#include <undo.h>
 #include <util/check.h>
+#include <util/strencodings.h>
+#include <util/string.h>
 #include <util/system.h>
 #include <validation.h>
 #include <version.h>
 
 #include <any>
+#include <optional>
 
 #include <boost/algorithm/string.hpp>
 
 #include <univalue.h>
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const size_t MAX_REST_TXS = 1000; //allow a max of 1000 transactions to be queried at once
+static const int MAX_REST_BLOCKS = 1000; //allow a max of 1000 consecutive blocks to be streamed at once
+static const int MAX_REST_HEADERS_BY_HEIGHT = 100000; //allow a max of 100000 consecutive headers to be streamed at once
+//! Number of headers serialized per chunk of a streamed reply
+static const size_t REST_HEADERS_PER_CHUNK = 1000;
 
 enum class RetFormat {
     UNDEF,
@@ -257,10 +269,166 @@ static bool rest_headers(const std::any& context,
     }
 }
 
+/** Parse a <start_height>/<count> range with at most max_count elements. */
+static bool ParseHeightRange(HTTPRequest* req, const std::string& param, const std::string& usage, int max_count, int& start_height, int& count)
+{
+    std::vector<std::string> path;
+    boost::split(path, param, boost::is_any_of("/"));
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No height range specified. Use " + usage + ".");
+    if (!ParseInt32(path[0], &start_height) || start_height < 0)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + SanitizeString(path[0]));
+    if (!ParseInt32(path[1], &count) || count < 1 || count > max_count)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Count out of range: " + SanitizeString(path[1]));
+    return true;
+}
+
+/** Send binary data as the next part of a chunked reply, hex-encoded for the hex format. */
+static bool WriteRESTChunk(HTTPRequest* req, RetFormat rf, Span<const uint8_t> data)
+{
+    if (rf == RetFormat::HEX) {
+        const std::string hex = HexStr(data);
+        return req->WriteReplyChunk(hex);
+    }
+    return req->WriteReplyChunk(Span<const char>(reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+static bool rest_headers_by_height(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    int start_height;
+    int count;
+    if (!ParseHeightRange(req, param, "/rest/headersbyheight/<start_height>/<count>.<ext>", MAX_REST_HEADERS_BY_HEIGHT, start_height, count))
+        return false;
+    if (rf != RetFormat::BINARY && rf != RetFormat::HEX && rf != RetFormat::JSON)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex, .json)");
+
+    const CBlockIndex* tip = nullptr;
+    std::vector<const CBlockIndex*> headers;
+    {
+        ChainstateManager* maybe_chainman = GetChainman(context, req);
+        if (!maybe_chainman) return false;
+        ChainstateManager& chainman = *maybe_chainman;
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        if (start_height > active_chain.Height()) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range");
+        }
+        tip = active_chain.Tip();
+        headers.reserve(std::min(count, active_chain.Height() - start_height + 1));
+        for (int height = start_height; height <= active_chain.Height() && headers.size() < size_t(count); ++height) {
+            headers.push_back(active_chain[height]);
+        }
+    }
+
+    // Block index entries are never deleted, so the headers can be sent without holding cs_main.
+    req->WriteHeader("X-Block-Count", ToString(headers.size()));
+    if (rf == RetFormat::JSON) {
+        req->WriteHeader("Content-Type", "application/json");
+        req->StartChunkedReply(HTTP_OK);
+        bool connected = true;
+        JSONWriter writer([req, &connected](Span<const char> chunk) {
+            if (connected) connected = req->WriteReplyChunk(chunk);
+        });
+        writer.BeginArray();
+        for (size_t i = 0; i < headers.size() && connected; ++i) {
+            writer.Value(blockheaderToJSON(tip, headers[i]));
+        }
+        writer.EndArray();
+        writer.Flush();
+        req->WriteReplyChunk(MakeSpan("\n").first(1));
+        req->EndChunkedReply();
+        return true;
+    }
+    req->WriteHeader("Content-Type", rf == RetFormat::BINARY ? "application/octet-stream" : "text/plain");
+    req->StartChunkedReply(HTTP_OK);
+    for (size_t i = 0; i < headers.size(); i += REST_HEADERS_PER_CHUNK) {
+        CDataStream ssHeaders(SER_NETWORK, PROTOCOL_VERSION);
+        for (size_t j = i; j < std::min(headers.size(), i + REST_HEADERS_PER_CHUNK); ++j) {
+            ssHeaders << headers[j]->GetBlockHeader();
+        }
+        if (!WriteRESTChunk(req, rf, MakeUCharSpan(ssHeaders))) break;
+    }
+    if (rf == RetFormat::HEX) req->WriteReplyChunk(MakeSpan("\n").first(1));
+    req->EndChunkedReply();
+    return true;
+}
+
+static bool rest_blocks(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+    int start_height;
+    int count;
+    if (!ParseHeightRange(req, param, "/rest/blocks/<start_height>/<count>.<ext>", MAX_REST_BLOCKS, start_height, count))
+        return false;
+    if (rf != RetFormat::BINARY && rf != RetFormat::HEX)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+
+    // The blocks up to the tip, or to the first whose data is not available.
+    std::vector<const CBlockIndex*> blocks;
+    {
+        ChainstateManager* maybe_chainman = GetChainman(context, req);
+        if (!maybe_chainman) return false;
+        ChainstateManager& chainman = *maybe_chainman;
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        if (start_height > active_chain.Height()) {
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range");
+        }
+        for (int height = start_height; height <= active_chain.Height() && blocks.size() < size_t(count); ++height) {
+            const CBlockIndex* pindex = active_chain[height];
+            if (!(pindex->nStatus & BLOCK_HAVE_DATA)) break;
+            blocks.push_back(pindex);
+        }
+    }
+    if (blocks.empty()) {
+        return RESTERR(req, HTTP_NOT_FOUND, strprintf("Block at height %d not available (pruned data)", start_height));
+    }
+
+    req->WriteHeader("Content-Type", rf == RetFormat::BINARY ? "application/octet-stream" : "text/plain");
+    req->WriteHeader("X-Block-Count", ToString(blocks.size()));
+    req->StartChunkedReply(HTTP_OK);
+    const int ser_flags = RPCSerializationFlags();
+    std::vector<uint8_t> block_data;
+    std::optional<CBlockView> block_view;
+    for (const CBlockIndex* pindex : blocks) {
+        // Blocks are stored as they are sent by default, with witness.
+        bool read;
+        if (ser_flags == 0) {
+            read = ReadRawBlockFromDisk(block_data, pindex, Params().MessageStart());
+        } else {
+            read = ReadBlockViewFromDisk(block_data, block_view, pindex, Params());
+            if (read) {
+                CDataStream ssBlock(non_secret, SER_NETWORK, PROTOCOL_VERSION | ser_flags);
+                ssBlock.ReserveFor(*block_view);
+                ssBlock << *block_view;
+                block_data.assign(UCharCast(ssBlock.data()), UCharCast(ssBlock.data() + ssBlock.size()));
+            }
+        }
+        if (!read) {
+            // Pruned since the range was determined. Fail the reply rather
+            // than send fewer blocks than announced.
+            LogPrintf("REST: block %s no longer available, aborting reply\n", pindex->GetBlockHash().ToString());
+            req->EndChunkedReply(false);
+            return false;
+        }
+        if (!WriteRESTChunk(req, rf, block_data)) break;
+    }
+    if (rf == RetFormat::HEX) req->WriteReplyChunk(MakeSpan("\n").first(1));
+    req->EndChunkedReply();
+    return true;
+}
+
 static bool rest_block(const std::any& context,
                        HTTPRequest* req,
                        const std::string& strURIPart,
-                       bool showTxDetails)
+                       TxVerbosity tx_verbosity)
 {
     if (!CheckWarmup(req))
         return false;
@@ -271,9 +439,15 @@ static bool rest_block(const std::any& context,
     if (!ParseHashStr(hashStr, hash))
         return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
 
+    // Only the JSON format needs the transactions deserialized; the raw
+    // formats are written from a view of the block as it is on disk.
     CBlock block;
+    std::vector<uint8_t> block_data;
+    std::optional<CBlockView> block_view;
     CBlockIndex* pblockindex = nullptr;
     CBlockIndex* tip = nullptr;
+    std::optional<ResponseCache::Key> cache_key;
+    std::shared_ptr<const std::string> cached_reply;
     {
         ChainstateManager* maybe_chainman = GetChainman(context, req);
         if (!maybe_chainman) return false;
@@ -285,36 +459,68 @@ static bool rest_block(const std::any& context,
             return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
         }
 
-        if (IsBlockPruned(pblockindex))
-            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+        if (g_response_cache && rf != RetFormat::UNDEF) {
+            // The JSON format includes the number of confirmations.
+            const char* method = tx_verbosity == TxVerbosity::SHOW_TXID ? "/rest/block/notxdetails/" :
+                                 tx_verbosity == TxVerbosity::SHOW_DETAILS_AND_PREVOUT ? "/rest/block/prevouts/" : "/rest/block/";
+            cache_key = g_response_cache->MakeKey(method, strURIPart,
+                                                  rf == RetFormat::JSON ? ResponseCache::Scope::TIP : ResponseCache::Scope::CHAIN, tip->GetBlockHash());
+            cached_reply = g_response_cache->Get(*cache_key);
+        }
+
+        if (!cached_reply) {
+            if (IsBlockPruned(pblockindex))
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
 
-        if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            if (rf == RetFormat::JSON) {
+                if (!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+                    return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            } else if (!ReadBlockViewFromDisk(block_data, block_view, pblockindex, Params())) {
+                return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+            }
+        }
     }
 
     switch (rf) {
     case RetFormat::BINARY: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string binaryBlock = ssBlock.str();
         req->WriteHeader("Content-Type", "application/octet-stream");
+        if (cached_reply) {
+            req->WriteReply(HTTP_OK, *cached_reply);
+            return true;
+        }
+        CDataStream ssBlock(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssBlock.ReserveFor(*block_view);
+        ssBlock << *block_view;
+        std::string binaryBlock = ssBlock.str();
+        if (cache_key) g_response_cache->Put(*cache_key, binaryBlock);
         req->WriteReply(HTTP_OK, binaryBlock);
         return true;
     }
 
     case RetFormat::HEX: {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock) + "\n";
         req->WriteHeader("Content-Type", "text/plain");
+        if (cached_reply) {
+            req->WriteReply(HTTP_OK, *cached_reply);
+            return true;
+        }
+        CDataStream ssBlock(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssBlock.ReserveFor(*block_view);
+        ssBlock << *block_view;
+        std::string strHex = HexStr(ssBlock) + "\n";
+        if (cache_key) g_response_cache->Put(*cache_key, strHex);
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
 
     case RetFormat::JSON: {
-        UniValue objBlock = blockToJSON(block, tip, pblockindex, showTxDetails);
-        std::string strJSON = objBlock.write() + "\n";
         req->WriteHeader("Content-Type", "application/json");
+        if (cached_reply) {
+            req->WriteReply(HTTP_OK, *cached_reply);
+            return true;
+        }
+        UniValue objBlock = blockToJSON(block, tip, pblockindex, tx_verbosity);
+        std::string strJSON = objBlock.write() + "\n";
+        if (cache_key) g_response_cache->Put(*cache_key, strJSON);
         req->WriteReply(HTTP_OK, strJSON);
         return true;
     }
@@ -327,12 +533,102 @@ static bool rest_block(const std::any& context,
 
 static bool rest_block_extended(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
 {
-    return rest_block(context, req, strURIPart, true);
+    return rest_block(context, req, strURIPart, TxVerbosity::SHOW_DETAILS);
+}
+
+static bool rest_block_prevouts(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    return rest_block(context, req, strURIPart, TxVerbosity::SHOW_DETAILS_AND_PREVOUT);
 }
 
 static bool rest_block_notxdetails(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
 {
-    return rest_block(context, req, strURIPart, false);
+    return rest_block(context, req, strURIPart, TxVerbosity::SHOW_TXID);
+}
+
+static bool rest_spent_txouts(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RetFormat rf = ParseDataFormat(hashStr, strURIPart);
+
+    uint256 hash;
+    if (!ParseHashStr(hashStr, hash))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+
+    const CBlockIndex* pblockindex = nullptr;
+    {
+        ChainstateManager* maybe_chainman = GetChainman(context, req);
+        if (!maybe_chainman) return false;
+        ChainstateManager& chainman = *maybe_chainman;
+        LOCK(cs_main);
+        pblockindex = chainman.m_blockman.LookupBlockIndex(hash);
+        if (!pblockindex) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
+        }
+    }
+
+    // Only the undo data is read, not the block itself. The genesis block
+    // spends nothing.
+    CBlockUndo blockUndo;
+    if (pblockindex->nHeight > 0 && !GetBlockUndo(pblockindex, /* block */ nullptr, blockUndo)) {
+        return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not available (pruned data)");
+    }
+
+    // The outputs spent by each transaction but the coinbase, in the order of its inputs
+    std::vector<std::vector<CCoin>> spent(blockUndo.vtxundo.size());
+    for (size_t i = 0; i < blockUndo.vtxundo.size(); ++i) {
+        spent[i].reserve(blockUndo.vtxundo[i].vprevout.size());
+        for (Coin& coin : blockUndo.vtxundo[i].vprevout) {
+            spent[i].emplace_back(std::move(coin));
+        }
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        CDataStream ssSpent(SER_NETWORK, PROTOCOL_VERSION);
+        ssSpent << spent;
+        std::string binarySpent = ssSpent.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binarySpent);
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        CDataStream ssSpent(SER_NETWORK, PROTOCOL_VERSION);
+        ssSpent << spent;
+        std::string strHex = HexStr(ssSpent) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue objSpent(UniValue::VARR);
+        for (const std::vector<CCoin>& tx_spent : spent) {
+            UniValue objTxSpent(UniValue::VARR);
+            for (const CCoin& coin : tx_spent) {
+                UniValue txout(UniValue::VOBJ);
+                txout.pushKV("height", (int32_t)coin.nHeight);
+                txout.pushKV("value", ValueFromAmount(coin.out.nValue));
+                UniValue o(UniValue::VOBJ);
+                ScriptPubKeyToUniv(coin.out.scriptPubKey, o, true);
+                txout.pushKV("scriptPubKey", o);
+                objTxSpent.push_back(txout);
+            }
+            objSpent.push_back(objTxSpent);
+        }
+        std::string strJSON = objSpent.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
 }
 
 // A bit of a hack - dependency on a function defined in rpc/blockchain.cpp
@@ -434,7 +730,8 @@ static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string
 
     switch (rf) {
     case RetFormat::BINARY: {
-        CDataStream ssTx(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        CDataStream ssTx(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssTx.ReserveFor(tx);
         ssTx << tx;
 
         std::string binaryTx = ssTx.str();
@@ -444,7 +741,8 @@ static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string
     }
 
     case RetFormat::HEX: {
-        CDataStream ssTx(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        CDataStream ssTx(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssTx.ReserveFor(tx);
         ssTx << tx;
 
         std::string strHex = HexStr(ssTx) + "\n";
@@ -468,6 +766,83 @@ static bool rest_tx(const std::any& context, HTTPRequest* req, const std::string
     }
 }
 
+static bool rest_txs(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RetFormat rf = ParseDataFormat(param, strURIPart);
+
+    //inputs are sent over URI scheme (/rest/txs/txid1/txid2/...)
+    std::vector<std::string> uriParts;
+    boost::split(uriParts, param, boost::is_any_of("/"));
+    if (param.empty() || uriParts.empty())
+        return RESTERR(req, HTTP_BAD_REQUEST, "Error: empty request");
+    if (uriParts.size() > MAX_REST_TXS)
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Error: max txs exceeded (max: %d, tried: %d)", MAX_REST_TXS, uriParts.size()));
+
+    std::vector<uint256> hashes(uriParts.size());
+    for (size_t i = 0; i < uriParts.size(); ++i) {
+        if (!ParseHashStr(uriParts[i], hashes[i]))
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + uriParts[i]);
+    }
+
+    if (g_txindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    const NodeContext* const node = GetNodeContext(context, req);
+    if (!node) return false;
+    std::vector<uint256> hashBlocks;
+    const std::vector<CTransactionRef> txs = GetTransactions(node->mempool.get(), hashes, hashBlocks);
+    for (size_t i = 0; i < txs.size(); ++i) {
+        if (!txs[i]) {
+            return RESTERR(req, HTTP_NOT_FOUND, uriParts[i] + " not found");
+        }
+    }
+
+    switch (rf) {
+    case RetFormat::BINARY: {
+        CDataStream ssTxs(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssTxs.ReserveFor(txs);
+        ssTxs << txs;
+
+        std::string binaryTxs = ssTxs.str();
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, binaryTxs);
+        return true;
+    }
+
+    case RetFormat::HEX: {
+        CDataStream ssTxs(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssTxs.ReserveFor(txs);
+        ssTxs << txs;
+
+        std::string strHex = HexStr(ssTxs) + "\n";
+        req->WriteHeader("Content-Type", "text/plain");
+        req->WriteReply(HTTP_OK, strHex);
+        return true;
+    }
+
+    case RetFormat::JSON: {
+        UniValue objTxs(UniValue::VARR);
+        for (size_t i = 0; i < txs.size(); ++i) {
+            UniValue objTx(UniValue::VOBJ);
+            TxToUniv(*txs[i], hashBlocks[i], objTx);
+            objTxs.push_back(objTx);
+        }
+        std::string strJSON = objTxs.write() + "\n";
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, strJSON);
+        return true;
+    }
+
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
+    }
+    }
+}
+
 static bool rest_getutxos(const std::any& context, HTTPRequest* req, const std::string& strURIPart)
 {
     if (!CheckWarmup(req))
@@ -712,12 +1087,17 @@ static const struct {
     bool (*handler)(const std::any& context, HTTPRequest* req, const std::string& strReq);
 } uri_prefixes[] = {
       {"/rest/tx/", rest_tx},
+      {"/rest/txs/", rest_txs},
       {"/rest/block/notxdetails/", rest_block_notxdetails},
+      {"/rest/block/prevouts/", rest_block_prevouts},
       {"/rest/block/", rest_block_extended},
+      {"/rest/blocks/", rest_blocks},
+      {"/rest/spenttxouts/", rest_spent_txouts},
       {"/rest/chaininfo", rest_chaininfo},
       {"/rest/mempool/info", rest_mempool_info},
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
+      {"/rest/headersbyheight/", rest_headers_by_height},
       {"/rest/getutxos", rest_getutxos},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
 };
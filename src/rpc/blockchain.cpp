@@ -13,8 +13,11 @@
 #include <consensus/validation.h>
 #include <core_io.h>
 #include <hash.h>
+#include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/blockstatsindex.h>
 #include <index/coinstatsindex.h>
+#include <index/prevoutindex.h>
 #include <node/blockstorage.h>
 #include <node/coinstats.h>
 #include <node/context.h>
@@ -23,7 +26,9 @@
 #include <policy/fees.h>
 #include <policy/policy.h>
 #include <policy/rbf.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
+#include <rpc/jsonwriter.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <script/descriptor.h>
@@ -46,6 +51,7 @@
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 struct CUpdatedBlock
 {
@@ -196,35 +202,87 @@ UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex
     return result;
 }
 
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails)
+/** Everything blockToJSON returns but the transactions. */
+static UniValue blockSummaryToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex)
 {
     UniValue result = blockheaderToJSON(tip, blockindex);
 
     result.pushKV("strippedsize", (int)::GetSerializeSize(block, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
     result.pushKV("size", (int)::GetSerializeSize(block, PROTOCOL_VERSION));
     result.pushKV("weight", (int)::GetBlockWeight(block));
-    UniValue txs(UniValue::VARR);
-    if (txDetails) {
+    return result;
+}
+
+bool GetBlockUndo(const CBlockIndex* blockindex, const CBlock* block, CBlockUndo& blockundo)
+{
+    if (!IsBlockPruned(blockindex) && UndoReadFromDisk(blockundo, blockindex)) return true;
+    if (blockindex->nHeight == 0 || !g_prevout_index || !g_prevout_index->BlockUntilSyncedToCurrentChain()) return false;
+
+    // The undo data could not be read, but the prevout index can still
+    // reconstruct it for a block in the indexed chain. The index is not
+    // available with -prune, so the block itself can be read.
+    CBlock read_block;
+    if (!block) {
+        if (!ReadBlockFromDisk(read_block, blockindex, Params().GetConsensus())) return false;
+        block = &read_block;
+    }
+    blockundo.vtxundo.clear();
+    blockundo.vtxundo.resize(block->vtx.size() - 1);
+    for (size_t i = 1; i < block->vtx.size(); ++i) {
+        if (!g_prevout_index->FindPrevouts(*block->vtx[i], blockundo.vtxundo[i - 1])) return false;
+    }
+    return true;
+}
+
+/** Call fn with the JSON of each transaction of the block, as blockToJSON lists them. */
+static void blockTxsToJSON(const CBlock& block, const CBlockIndex* blockindex, TxVerbosity verbosity, const std::function<void(const UniValue&)>& fn)
+{
+    switch (verbosity) {
+    case TxVerbosity::SHOW_TXID:
+        for (const CTransactionRef& tx : block.vtx) {
+            fn(tx->GetHash().GetHex());
+        }
+        break;
+
+    case TxVerbosity::SHOW_DETAILS:
+    case TxVerbosity::SHOW_DETAILS_AND_PREVOUT: {
         CBlockUndo blockUndo;
-        const bool have_undo = !IsBlockPruned(blockindex) && UndoReadFromDisk(blockUndo, blockindex);
+        const bool have_undo = GetBlockUndo(blockindex, &block, blockUndo);
         for (size_t i = 0; i < block.vtx.size(); ++i) {
             const CTransactionRef& tx = block.vtx.at(i);
             // coinbase transaction (i == 0) doesn't have undo data
             const CTxUndo* txundo = (have_undo && i) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
             UniValue objTx(UniValue::VOBJ);
-            TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags(), txundo);
-            txs.push_back(objTx);
-        }
-    } else {
-        for (const CTransactionRef& tx : block.vtx) {
-            txs.push_back(tx->GetHash().GetHex());
+            TxToUniv(*tx, uint256(), objTx, true, RPCSerializationFlags(), txundo, verbosity);
+            fn(objTx);
         }
+        break;
+    }
     }
+}
+
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    UniValue result = blockSummaryToJSON(block, tip, blockindex);
+    UniValue txs(UniValue::VARR);
+    blockTxsToJSON(block, blockindex, verbosity, [&](const UniValue& tx) { txs.push_back(tx); });
     result.pushKV("tx", txs);
 
     return result;
 }
 
+/** Write what blockToJSON returns, building one transaction at a time. */
+static void WriteBlockJSON(JSONWriter& writer, const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity)
+{
+    writer.BeginObject();
+    writer.Members(blockSummaryToJSON(block, tip, blockindex));
+    writer.Key("tx");
+    writer.BeginArray();
+    blockTxsToJSON(block, blockindex, verbosity, [&](const UniValue& tx) { writer.Value(tx); });
+    writer.EndArray();
+    writer.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{"getblockcount",
@@ -302,6 +360,7 @@ static RPCHelpMan waitfornewblock()
 
     CUpdatedBlock block;
     {
+        HTTPWorkerParkScope park;
         WAIT_LOCK(cs_blockchange, lock);
         block = latestblock;
         if(timeout)
@@ -348,6 +407,7 @@ static RPCHelpMan waitforblock()
 
     CUpdatedBlock block;
     {
+        HTTPWorkerParkScope park;
         WAIT_LOCK(cs_blockchange, lock);
         if(timeout)
             cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&hash]() EXCLUSIVE_LOCKS_REQUIRED(cs_blockchange) {return latestblock.hash == hash || !IsRPCRunning();});
@@ -395,6 +455,7 @@ static RPCHelpMan waitforblockheight()
 
     CUpdatedBlock block;
     {
+        HTTPWorkerParkScope park;
         WAIT_LOCK(cs_blockchange, lock);
         if(timeout)
             cond_blockchange.wait_for(lock, std::chrono::milliseconds(timeout), [&height]() EXCLUSIVE_LOCKS_REQUIRED(cs_blockchange) {return latestblock.height >= height || !IsRPCRunning();});
@@ -580,6 +641,29 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+/**
+ * Write what MempoolToJSON returns when verbose. The entries are rendered to
+ * text under the mempool lock, instead of into one UniValue, and sent after it
+ * is released, so that a slow client does not hold up the mempool.
+ */
+static void WriteMempoolJSON(JSONRPCResultStream& stream, const CTxMemPool& pool)
+{
+    std::string entries;
+    {
+        JSONWriter writer([&](Span<const char> chunk) { entries.append(chunk.begin(), chunk.end()); });
+        LOCK(pool.cs);
+        writer.BeginObject();
+        for (const CTxMemPoolEntry& e : pool.mapTx) {
+            UniValue info(UniValue::VOBJ);
+            entryToJSON(pool, info, e);
+            writer.Pair(e.GetTx().GetHash().ToString(), info);
+        }
+        writer.EndObject();
+        writer.Flush();
+    }
+    stream.Begin().RawValue(entries);
+}
+
 static RPCHelpMan getrawmempool()
 {
     return RPCHelpMan{"getrawmempool",
@@ -625,7 +709,12 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
-    return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose, include_mempool_sequence);
+    const CTxMemPool& mempool = EnsureAnyMemPool(request.context);
+    if (fVerbose && !include_mempool_sequence && request.result_stream) {
+        WriteMempoolJSON(*request.result_stream, mempool);
+        return NullUniValue;
+    }
+    return MempoolToJSON(mempool, fVerbose, include_mempool_sequence);
 },
     };
 }
@@ -908,6 +997,21 @@ static CBlock GetBlockChecked(const CBlockIndex* pblockindex)
     return block;
 }
 
+/** Like GetBlockChecked(), without deserializing the transactions. The view refers to block_data. */
+static CBlockView GetBlockViewChecked(const CBlockIndex* pblockindex, std::vector<uint8_t>& block_data)
+{
+    if (IsBlockPruned(pblockindex)) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not available (pruned data)");
+    }
+
+    std::optional<CBlockView> block;
+    if (!ReadBlockViewFromDisk(block_data, block, pblockindex, Params())) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+    }
+
+    return *block;
+}
+
 static CBlockUndo GetUndoChecked(const CBlockIndex* pblockindex)
 {
     CBlockUndo blockUndo;
@@ -927,10 +1031,11 @@ static RPCHelpMan getblock()
     return RPCHelpMan{"getblock",
                 "\nIf verbosity is 0, returns a string that is serialized, hex-encoded data for block 'hash'.\n"
                 "If verbosity is 1, returns an Object with information about block <hash>.\n"
-                "If verbosity is 2, returns an Object with information about block <hash> and information about each transaction. \n",
+                "If verbosity is 2, returns an Object with information about block <hash> and information about each transaction.\n"
+                "If verbosity is 3, returns an Object with information about block <hash> and information about each transaction, including prevout information for inputs (only for unpruned blocks in the current best chain).\n",
                 {
                     {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The block hash"},
-                    {"verbosity|verbose", RPCArg::Type::NUM, RPCArg::Default{1}, "0 for hex-encoded data, 1 for a json object, and 2 for json object with transaction data"},
+                    {"verbosity|verbose", RPCArg::Type::NUM, RPCArg::Default{1}, "0 for hex-encoded data, 1 for a json object, 2 for json object with transaction data, and 3 for json object with transaction data including prevout information for inputs"},
                 },
                 {
                     RPCResult{"for verbosity = 0",
@@ -972,6 +1077,37 @@ static RPCHelpMan getblock()
                         }},
                     }},
                 }},
+                    RPCResult{"for verbosity = 3",
+                RPCResult::Type::OBJ, "", "",
+                {
+                    {RPCResult::Type::ELISION, "", "Same output as verbosity = 2"},
+                    {RPCResult::Type::ARR, "tx", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::ARR, "vin", "",
+                            {
+                                {RPCResult::Type::OBJ, "", "",
+                                {
+                                    {RPCResult::Type::ELISION, "", "The same output as verbosity = 2"},
+                                    {RPCResult::Type::OBJ, "prevout", "(Only if undo information is available)",
+                                    {
+                                        {RPCResult::Type::BOOL, "generated", "Coinbase or not"},
+                                        {RPCResult::Type::NUM, "height", "The height of the prevout"},
+                                        {RPCResult::Type::STR_AMOUNT, "value", "The value in " + CURRENCY_UNIT},
+                                        {RPCResult::Type::OBJ, "scriptPubKey", "",
+                                        {
+                                            {RPCResult::Type::STR, "asm", "The asm"},
+                                            {RPCResult::Type::STR, "hex", "The hex"},
+                                            {RPCResult::Type::STR, "address", /* optional */ true, "The chymera address (only if a well-defined address exists)"},
+                                            {RPCResult::Type::STR, "type", "The type, eg 'pubkeyhash'"},
+                                        }},
+                                    }},
+                                }},
+                            }},
+                        }},
+                    }},
+                }},
         },
                 RPCExamples{
                     HelpExampleCli("getblock", "\"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09\"")
@@ -991,6 +1127,8 @@ static RPCHelpMan getblock()
     }
 
     CBlock block;
+    std::vector<uint8_t> block_data;
+    std::optional<CBlockView> block_view;
     const CBlockIndex* pblockindex;
     const CBlockIndex* tip;
     {
@@ -1003,18 +1141,37 @@ static RPCHelpMan getblock()
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
         }
 
-        block = GetBlockChecked(pblockindex);
+        if (verbosity <= 0) {
+            block_view.emplace(GetBlockViewChecked(pblockindex, block_data));
+        } else {
+            block = GetBlockChecked(pblockindex);
+        }
     }
 
     if (verbosity <= 0)
     {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-        ssBlock << block;
+        CDataStream ssBlock(non_secret, SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+        ssBlock.ReserveFor(*block_view);
+        ssBlock << *block_view;
         std::string strHex = HexStr(ssBlock);
         return strHex;
     }
 
-    return blockToJSON(block, tip, pblockindex, verbosity >= 2);
+    TxVerbosity tx_verbosity;
+    if (verbosity == 1) {
+        tx_verbosity = TxVerbosity::SHOW_TXID;
+    } else if (verbosity == 2) {
+        tx_verbosity = TxVerbosity::SHOW_DETAILS;
+    } else {
+        tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
+    }
+
+    if (request.result_stream && tx_verbosity != TxVerbosity::SHOW_TXID) {
+        // With the transactions' details, the result is large enough to stream.
+        WriteBlockJSON(request.result_stream->Begin(), block, tip, pblockindex, tx_verbosity);
+        return NullUniValue;
+    }
+    return blockToJSON(block, tip, pblockindex, tx_verbosity);
 },
     };
 }
@@ -1879,77 +2036,150 @@ static RPCHelpMan getchaintxstats()
     };
 }
 
-template<typename T>
-static T CalculateTruncatedMedian(std::vector<T>& scores)
+void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex)
 {
-    size_t size = scores.size();
-    if (size == 0) {
-        return 0;
-    }
-
-    std::sort(scores.begin(), scores.end());
-    if (size % 2 == 0) {
-        return (scores[size / 2 - 1] + scores[size / 2]) / 2;
-    } else {
-        return scores[size / 2];
-    }
+    ScriptPubKeyToUniv(scriptPubKey, out, fIncludeHex, IsDeprecatedRPCEnabled("addresses"));
 }
 
-void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight)
+void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex, int serialize_flags, const CTxUndo* txundo, TxVerbosity verbosity)
 {
-    if (scores.empty()) {
-        return;
-    }
+    TxToUniv(tx, hashBlock, IsDeprecatedRPCEnabled("addresses"), entry, include_hex, serialize_flags, txundo, verbosity);
+}
 
-    std::sort(scores.begin(), scores.end());
+//! Maximum number of blocks getblockstatsrange reports at once
+static const int MAX_BLOCKSTATS_RANGE = 10000;
 
-    // 10th, 25th, 50th, 75th, and 90th percentile weight units.
-    const double weights[NUM_GETBLOCKSTATS_PERCENTILES] = {
-        total_weight / 10.0, total_weight / 4.0, total_weight / 2.0, (total_weight * 3.0) / 4.0, (total_weight * 9.0) / 10.0
-    };
+static std::vector<RPCResult> BlockStatsDescription() { return {
+    RPCResult{RPCResult::Type::NUM, "avgfee", "Average fee in the block"},
+    RPCResult{RPCResult::Type::NUM, "avgfeerate", "Average feerate (in satoshis per virtual byte)"},
+    RPCResult{RPCResult::Type::NUM, "avgtxsize", "Average transaction size"},
+    RPCResult{RPCResult::Type::STR_HEX, "blockhash", "The block hash (to check for potential reorgs)"},
+    RPCResult{RPCResult::Type::ARR_FIXED, "feerate_percentiles", "Feerates at the 10th, 25th, 50th, 75th, and 90th percentile weight unit (in satoshis per virtual byte)",
+        {
+            RPCResult{RPCResult::Type::NUM, "10th_percentile_feerate", "The 10th percentile feerate"},
+            RPCResult{RPCResult::Type::NUM, "25th_percentile_feerate", "The 25th percentile feerate"},
+            RPCResult{RPCResult::Type::NUM, "50th_percentile_feerate", "The 50th percentile feerate"},
+            RPCResult{RPCResult::Type::NUM, "75th_percentile_feerate", "The 75th percentile feerate"},
+            RPCResult{RPCResult::Type::NUM, "90th_percentile_feerate", "The 90th percentile feerate"},
+        }},
+    RPCResult{RPCResult::Type::NUM, "height", "The height of the block"},
+    RPCResult{RPCResult::Type::NUM, "ins", "The number of inputs (excluding coinbase)"},
+    RPCResult{RPCResult::Type::NUM, "maxfee", "Maximum fee in the block"},
+    RPCResult{RPCResult::Type::NUM, "maxfeerate", "Maximum feerate (in satoshis per virtual byte)"},
+    RPCResult{RPCResult::Type::NUM, "maxtxsize", "Maximum transaction size"},
+    RPCResult{RPCResult::Type::NUM, "medianfee", "Truncated median fee in the block"},
+    RPCResult{RPCResult::Type::NUM, "mediantime", "The block median time past"},
+    RPCResult{RPCResult::Type::NUM, "mediantxsize", "Truncated median transaction size"},
+    RPCResult{RPCResult::Type::NUM, "minfee", "Minimum fee in the block"},
+    RPCResult{RPCResult::Type::NUM, "minfeerate", "Minimum feerate (in satoshis per virtual byte)"},
+    RPCResult{RPCResult::Type::NUM, "mintxsize", "Minimum transaction size"},
+    RPCResult{RPCResult::Type::NUM, "outs", "The number of outputs"},
+    RPCResult{RPCResult::Type::NUM, "subsidy", "The block subsidy"},
+    RPCResult{RPCResult::Type::NUM, "swtotal_size", "Total size of all segwit transactions"},
+    RPCResult{RPCResult::Type::NUM, "swtotal_weight", "Total weight of all segwit transactions"},
+    RPCResult{RPCResult::Type::NUM, "swtxs", "The number of segwit transactions"},
+    RPCResult{RPCResult::Type::NUM, "time", "The block time"},
+    RPCResult{RPCResult::Type::NUM, "total_out", "Total amount in all outputs (excluding coinbase and thus reward [ie subsidy + totalfee])"},
+    RPCResult{RPCResult::Type::NUM, "total_size", "Total size of all non-coinbase transactions"},
+    RPCResult{RPCResult::Type::NUM, "total_weight", "Total weight of all non-coinbase transactions"},
+    RPCResult{RPCResult::Type::NUM, "totalfee", "The fee total"},
+    RPCResult{RPCResult::Type::NUM, "txs", "The number of transactions (including coinbase)"},
+    RPCResult{RPCResult::Type::NUM, "utxo_increase", "The increase/decrease in the number of unspent outputs"},
+    RPCResult{RPCResult::Type::NUM, "utxo_size_inc", "The increase/decrease in size for the utxo index (not discounting op_return and similar)"},
+};}
 
-    int64_t next_percentile_index = 0;
-    int64_t cumulative_weight = 0;
-    for (const auto& element : scores) {
-        cumulative_weight += element.second;
-        while (next_percentile_index < NUM_GETBLOCKSTATS_PERCENTILES && cumulative_weight >= weights[next_percentile_index]) {
-            result[next_percentile_index] = element.first;
-            ++next_percentile_index;
-        }
+/** The statistics of a block, from the block stats index if it has them, or else from the block and its undo data. */
+static CBlockStats GetBlockStatsChecked(const CBlockIndex* pindex)
+{
+    CBlockStats stats;
+    if (g_block_stats_index && g_block_stats_index->LookUpStats(pindex, stats)) {
+        return stats;
     }
 
-    // Fill any remaining percentiles with the last value.
-    for (int64_t i = next_percentile_index; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
-        result[i] = scores.back().first;
-    }
+    LOCK(cs_main);
+    const CBlock block = GetBlockChecked(pindex);
+    const CBlockUndo blockUndo = GetUndoChecked(pindex);
+    CHECK_NONFATAL(ComputeBlockStats(block, blockUndo, stats));
+    return stats;
 }
 
-void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex)
+static UniValue BlockStatsToJSON(const CBlockIndex* pindex, const CBlockStats& stats)
 {
-    ScriptPubKeyToUniv(scriptPubKey, out, fIncludeHex, IsDeprecatedRPCEnabled("addresses"));
+    UniValue feerates_res(UniValue::VARR);
+    for (int64_t i = 0; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
+        feerates_res.push_back(stats.feerate_percentiles[i]);
+    }
+
+    UniValue ret_all(UniValue::VOBJ);
+    ret_all.pushKV("avgfee", (stats.txs > 1) ? stats.totalfee / (stats.txs - 1) : 0);
+    ret_all.pushKV("avgfeerate", stats.total_weight ? (stats.totalfee * WITNESS_SCALE_FACTOR) / stats.total_weight : 0); // Unit: sat/vbyte
+    ret_all.pushKV("avgtxsize", (stats.txs > 1) ? stats.total_size / (stats.txs - 1) : 0);
+    ret_all.pushKV("blockhash", pindex->GetBlockHash().GetHex());
+    ret_all.pushKV("feerate_percentiles", feerates_res);
+    ret_all.pushKV("height", (int64_t)pindex->nHeight);
+    ret_all.pushKV("ins", stats.ins);
+    ret_all.pushKV("maxfee", stats.maxfee);
+    ret_all.pushKV("maxfeerate", stats.maxfeerate);
+    ret_all.pushKV("maxtxsize", stats.maxtxsize);
+    ret_all.pushKV("medianfee", stats.medianfee);
+    ret_all.pushKV("mediantime", pindex->GetMedianTimePast());
+    ret_all.pushKV("mediantxsize", stats.mediantxsize);
+    ret_all.pushKV("minfee", stats.minfee);
+    ret_all.pushKV("minfeerate", stats.minfeerate);
+    ret_all.pushKV("mintxsize", stats.mintxsize);
+    ret_all.pushKV("outs", stats.outs);
+    ret_all.pushKV("subsidy", GetBlockSubsidy(pindex->nHeight, Params().GetConsensus()));
+    ret_all.pushKV("swtotal_size", stats.swtotal_size);
+    ret_all.pushKV("swtotal_weight", stats.swtotal_weight);
+    ret_all.pushKV("swtxs", stats.swtxs);
+    ret_all.pushKV("time", pindex->GetBlockTime());
+    ret_all.pushKV("total_out", stats.total_out);
+    ret_all.pushKV("total_size", stats.total_size);
+    ret_all.pushKV("total_weight", stats.total_weight);
+    ret_all.pushKV("totalfee", stats.totalfee);
+    ret_all.pushKV("txs", stats.txs);
+    ret_all.pushKV("utxo_increase", stats.outs - stats.ins);
+    ret_all.pushKV("utxo_size_inc", stats.utxo_size_inc);
+    return ret_all;
 }
 
-void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex, int serialize_flags, const CTxUndo* txundo)
+static std::set<std::string> ParseSelectedStats(const UniValue& param)
 {
-    TxToUniv(tx, hashBlock, IsDeprecatedRPCEnabled("addresses"), entry, include_hex, serialize_flags, txundo);
+    std::set<std::string> stats;
+    if (!param.isNull()) {
+        const UniValue stats_univalue = param.get_array();
+        for (unsigned int i = 0; i < stats_univalue.size(); i++) {
+            const std::string stat = stats_univalue[i].get_str();
+            stats.insert(stat);
+        }
+    }
+    return stats;
 }
 
-template<typename T>
-static inline bool SetHasKeys(const std::set<T>& set) {return false;}
-template<typename T, typename Tk, typename... Args>
-static inline bool SetHasKeys(const std::set<T>& set, const Tk& key, const Args&... args)
+/** The selected statistics out of all those of a block, or all of them if none are selected. */
+static UniValue SelectBlockStats(UniValue ret_all, const std::set<std::string>& stats)
 {
-    return (set.count(key) != 0) || SetHasKeys(set, args...);
-}
+    if (stats.empty()) {
+        return ret_all;
+    }
 
-// outpoint (needed for the utxo index) + nHeight + fCoinBase
-static constexpr size_t PER_UTXO_OVERHEAD = sizeof(COutPoint) + sizeof(uint32_t) + sizeof(bool);
+    UniValue ret(UniValue::VOBJ);
+    for (const std::string& stat : stats) {
+        const UniValue& value = ret_all[stat];
+        if (value.isNull()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid selected statistic %s", stat));
+        }
+        ret.pushKV(stat, value);
+    }
+    return ret;
+}
 
 static RPCHelpMan getblockstats()
 {
     return RPCHelpMan{"getblockstats",
                 "\nCompute per block statistics for a given window. All amounts are in satoshis.\n"
-                "It won't work for some heights with pruning.\n",
+                "It won't work for some heights with pruning.\n"
+                "With -blockstatsindex, the statistics of blocks in the active chain are looked up instead.\n",
                 {
                     {"hash_or_height", RPCArg::Type::NUM, RPCArg::Optional::NO, "The block hash or height of the target block", "", {"", "string or numeric"}},
                     {"stats", RPCArg::Type::ARR, RPCArg::DefaultHint{"all values"}, "Values to plot (see result below)",
@@ -1960,45 +2190,7 @@ static RPCHelpMan getblockstats()
                         "stats"},
                 },
                 RPCResult{
-            RPCResult::Type::OBJ, "", "",
-            {
-                {RPCResult::Type::NUM, "avgfee", "Average fee in the block"},
-                {RPCResult::Type::NUM, "avgfeerate", "Average feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "avgtxsize", "Average transaction size"},
-                {RPCResult::Type::STR_HEX, "blockhash", "The block hash (to check for potential reorgs)"},
-                {RPCResult::Type::ARR_FIXED, "feerate_percentiles", "Feerates at the 10th, 25th, 50th, 75th, and 90th percentile weight unit (in satoshis per virtual byte)",
-                {
-                    {RPCResult::Type::NUM, "10th_percentile_feerate", "The 10th percentile feerate"},
-                    {RPCResult::Type::NUM, "25th_percentile_feerate", "The 25th percentile feerate"},
-                    {RPCResult::Type::NUM, "50th_percentile_feerate", "The 50th percentile feerate"},
-                    {RPCResult::Type::NUM, "75th_percentile_feerate", "The 75th percentile feerate"},
-                    {RPCResult::Type::NUM, "90th_percentile_feerate", "The 90th percentile feerate"},
-                }},
-                {RPCResult::Type::NUM, "height", "The height of the block"},
-                {RPCResult::Type::NUM, "ins", "The number of inputs (excluding coinbase)"},
-                {RPCResult::Type::NUM, "maxfee", "Maximum fee in the block"},
-                {RPCResult::Type::NUM, "maxfeerate", "Maximum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "maxtxsize", "Maximum transaction size"},
-                {RPCResult::Type::NUM, "medianfee", "Truncated median fee in the block"},
-                {RPCResult::Type::NUM, "mediantime", "The block median time past"},
-                {RPCResult::Type::NUM, "mediantxsize", "Truncated median transaction size"},
-                {RPCResult::Type::NUM, "minfee", "Minimum fee in the block"},
-                {RPCResult::Type::NUM, "minfeerate", "Minimum feerate (in satoshis per virtual byte)"},
-                {RPCResult::Type::NUM, "mintxsize", "Minimum transaction size"},
-                {RPCResult::Type::NUM, "outs", "The number of outputs"},
-                {RPCResult::Type::NUM, "subsidy", "The block subsidy"},
-                {RPCResult::Type::NUM, "swtotal_size", "Total size of all segwit transactions"},
-                {RPCResult::Type::NUM, "swtotal_weight", "Total weight of all segwit transactions"},
-                {RPCResult::Type::NUM, "swtxs", "The number of segwit transactions"},
-                {RPCResult::Type::NUM, "time", "The block time"},
-                {RPCResult::Type::NUM, "total_out", "Total amount in all outputs (excluding coinbase and thus reward [ie subsidy + totalfee])"},
-                {RPCResult::Type::NUM, "total_size", "Total size of all non-coinbase transactions"},
-                {RPCResult::Type::NUM, "total_weight", "Total weight of all non-coinbase transactions"},
-                {RPCResult::Type::NUM, "totalfee", "The fee total"},
-                {RPCResult::Type::NUM, "txs", "The number of transactions (including coinbase)"},
-                {RPCResult::Type::NUM, "utxo_increase", "The increase/decrease in the number of unspent outputs"},
-                {RPCResult::Type::NUM, "utxo_size_inc", "The increase/decrease in size for the utxo index (not discounting op_return and similar)"},
-            }},
+                    RPCResult::Type::OBJ, "", "", BlockStatsDescription()},
                 RPCExamples{
                     HelpExampleCli("getblockstats", R"('"00000000c937983704a73af28acdec37b049d214adbda81d7e2a3dd146f6ed09"' '["minfeerate","avgfeerate"]')") +
                     HelpExampleCli("getblockstats", R"(1000 '["minfeerate","avgfeerate"]')") +
@@ -2008,176 +2200,93 @@ static RPCHelpMan getblockstats()
         [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
 {
     ChainstateManager& chainman = EnsureAnyChainman(request.context);
-    LOCK(cs_main);
-    CBlockIndex* pindex{ParseHashOrHeight(request.params[0], chainman)};
+    const CBlockIndex* pindex{ParseHashOrHeight(request.params[0], chainman)};
     CHECK_NONFATAL(pindex != nullptr);
 
-    std::set<std::string> stats;
-    if (!request.params[1].isNull()) {
-        const UniValue stats_univalue = request.params[1].get_array();
-        for (unsigned int i = 0; i < stats_univalue.size(); i++) {
-            const std::string stat = stats_univalue[i].get_str();
-            stats.insert(stat);
-        }
-    }
+    const std::set<std::string> stats = ParseSelectedStats(request.params[1]);
 
-    const CBlock block = GetBlockChecked(pindex);
-    const CBlockUndo blockUndo = GetUndoChecked(pindex);
-
-    const bool do_all = stats.size() == 0; // Calculate everything if nothing selected (default)
-    const bool do_mediantxsize = do_all || stats.count("mediantxsize") != 0;
-    const bool do_medianfee = do_all || stats.count("medianfee") != 0;
-    const bool do_feerate_percentiles = do_all || stats.count("feerate_percentiles") != 0;
-    const bool loop_inputs = do_all || do_medianfee || do_feerate_percentiles ||
-        SetHasKeys(stats, "utxo_size_inc", "totalfee", "avgfee", "avgfeerate", "minfee", "maxfee", "minfeerate", "maxfeerate");
-    const bool loop_outputs = do_all || loop_inputs || stats.count("total_out");
-    const bool do_calculate_size = do_mediantxsize ||
-        SetHasKeys(stats, "total_size", "avgtxsize", "mintxsize", "maxtxsize", "swtotal_size");
-    const bool do_calculate_weight = do_all || SetHasKeys(stats, "total_weight", "avgfeerate", "swtotal_weight", "avgfeerate", "feerate_percentiles", "minfeerate", "maxfeerate");
-    const bool do_calculate_sw = do_all || SetHasKeys(stats, "swtxs", "swtotal_size", "swtotal_weight");
-
-    CAmount maxfee = 0;
-    CAmount maxfeerate = 0;
-    CAmount minfee = MAX_MONEY;
-    CAmount minfeerate = MAX_MONEY;
-    CAmount total_out = 0;
-    CAmount totalfee = 0;
-    int64_t inputs = 0;
-    int64_t maxtxsize = 0;
-    int64_t mintxsize = MAX_BLOCK_SERIALIZED_SIZE;
-    int64_t outputs = 0;
-    int64_t swtotal_size = 0;
-    int64_t swtotal_weight = 0;
-    int64_t swtxs = 0;
-    int64_t total_size = 0;
-    int64_t total_weight = 0;
-    int64_t utxo_size_inc = 0;
-    std::vector<CAmount> fee_array;
-    std::vector<std::pair<CAmount, int64_t>> feerate_array;
-    std::vector<int64_t> txsize_array;
-
-    for (size_t i = 0; i < block.vtx.size(); ++i) {
-        const auto& tx = block.vtx.at(i);
-        outputs += tx->vout.size();
-
-        CAmount tx_total_out = 0;
-        if (loop_outputs) {
-            for (const CTxOut& out : tx->vout) {
-                tx_total_out += out.nValue;
-                utxo_size_inc += GetSerializeSize(out, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
-            }
-        }
-
-        if (tx->IsCoinBase()) {
-            continue;
-        }
-
-        inputs += tx->vin.size(); // Don't count coinbase's fake input
-        total_out += tx_total_out; // Don't count coinbase reward
-
-        int64_t tx_size = 0;
-        if (do_calculate_size) {
+    return SelectBlockStats(BlockStatsToJSON(pindex, GetBlockStatsChecked(pindex)), stats);
+},
+    };
+}
 
-            tx_size = tx->GetTotalSize();
-            if (do_mediantxsize) {
-                txsize_array.push_back(tx_size);
-            }
-            maxtxsize = std::max(maxtxsize, tx_size);
-            mintxsize = std::min(mintxsize, tx_size);
-            total_size += tx_size;
-        }
+static RPCHelpMan getblockstatsrange()
+{
+    return RPCHelpMan{"getblockstatsrange",
+                "\nCompute per block statistics for a range of heights in the active chain, as getblockstats does for one block.\n"
+                "All amounts are in satoshis. It won't work for some heights with pruning.\n"
+                "With -blockstatsindex, the statistics are looked up instead.\n",
+                {
+                    {"start_height", RPCArg::Type::NUM, RPCArg::Optional::NO, "The height of the first block"},
+                    {"count", RPCArg::Type::NUM, RPCArg::Optional::NO, strprintf("The number of blocks, at most %d", MAX_BLOCKSTATS_RANGE)},
+                    {"stats", RPCArg::Type::ARR, RPCArg::DefaultHint{"all values"}, "Values to plot (see getblockstats)",
+                        {
+                            {"height", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Selected statistic"},
+                            {"time", RPCArg::Type::STR, RPCArg::Optional::OMITTED, "Selected statistic"},
+                        },
+                        "stats"},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "The statistics of each block, in order of height",
+                    {
+                        {RPCResult::Type::OBJ, "", "", BlockStatsDescription()},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("getblockstatsrange", R"(1000 144 '["minfeerate","avgfeerate"]')") +
+                    HelpExampleRpc("getblockstatsrange", R"(1000, 144, ["minfeerate","avgfeerate"])")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const int start_height{request.params[0].get_int()};
+    const int count{request.params[1].get_int()};
+    if (start_height < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target block height %d is negative", start_height));
+    }
+    if (count < 1 || count > MAX_BLOCKSTATS_RANGE) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Count must be between 1 and %d", MAX_BLOCKSTATS_RANGE));
+    }
 
-        int64_t weight = 0;
-        if (do_calculate_weight) {
-            weight = GetTransactionWeight(*tx);
-            total_weight += weight;
-        }
+    const std::set<std::string> selected = ParseSelectedStats(request.params[2]);
 
-        if (do_calculate_sw && tx->HasWitness()) {
-            ++swtxs;
-            swtotal_size += tx_size;
-            swtotal_weight += weight;
+    std::vector<const CBlockIndex*> blocks;
+    {
+        ChainstateManager& chainman = EnsureAnyChainman(request.context);
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        // Compared before adding, so that start_height + count cannot overflow.
+        if (start_height > active_chain.Height() - count + 1) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Target block height %d after current tip %d", int64_t{start_height} + count - 1, active_chain.Height()));
         }
-
-        if (loop_inputs) {
-            CAmount tx_total_in = 0;
-            const auto& txundo = blockUndo.vtxundo.at(i - 1);
-            for (const Coin& coin: txundo.vprevout) {
-                const CTxOut& prevoutput = coin.out;
-
-                tx_total_in += prevoutput.nValue;
-                utxo_size_inc -= GetSerializeSize(prevoutput, PROTOCOL_VERSION) + PER_UTXO_OVERHEAD;
-            }
-
-            CAmount txfee = tx_total_in - tx_total_out;
-            CHECK_NONFATAL(MoneyRange(txfee));
-            if (do_medianfee) {
-                fee_array.push_back(txfee);
-            }
-            maxfee = std::max(maxfee, txfee);
-            minfee = std::min(minfee, txfee);
-            totalfee += txfee;
-
-            // New feerate uses satoshis per virtual byte instead of per serialized byte
-            CAmount feerate = weight ? (txfee * WITNESS_SCALE_FACTOR) / weight : 0;
-            if (do_feerate_percentiles) {
-                feerate_array.emplace_back(std::make_pair(feerate, weight));
-            }
-            maxfeerate = std::max(maxfeerate, feerate);
-            minfeerate = std::min(minfeerate, feerate);
+        const int stop_height{start_height + count - 1};
+        blocks.reserve(count);
+        for (int height = start_height; height <= stop_height; ++height) {
+            blocks.push_back(active_chain[height]);
         }
     }
 
-    CAmount feerate_percentiles[NUM_GETBLOCKSTATS_PERCENTILES] = { 0 };
-    CalculatePercentilesByWeight(feerate_percentiles, feerate_array, total_weight);
-
-    UniValue feerates_res(UniValue::VARR);
-    for (int64_t i = 0; i < NUM_GETBLOCKSTATS_PERCENTILES; i++) {
-        feerates_res.push_back(feerate_percentiles[i]);
+    // Everything that may fail is done before the reply is started.
+    std::vector<CBlockStats> stats;
+    stats.reserve(blocks.size());
+    for (const CBlockIndex* pindex : blocks) {
+        stats.push_back(GetBlockStatsChecked(pindex));
     }
+    UniValue first = SelectBlockStats(BlockStatsToJSON(blocks.front(), stats.front()), selected);
 
-    UniValue ret_all(UniValue::VOBJ);
-    ret_all.pushKV("avgfee", (block.vtx.size() > 1) ? totalfee / (block.vtx.size() - 1) : 0);
-    ret_all.pushKV("avgfeerate", total_weight ? (totalfee * WITNESS_SCALE_FACTOR) / total_weight : 0); // Unit: sat/vbyte
-    ret_all.pushKV("avgtxsize", (block.vtx.size() > 1) ? total_size / (block.vtx.size() - 1) : 0);
-    ret_all.pushKV("blockhash", pindex->GetBlockHash().GetHex());
-    ret_all.pushKV("feerate_percentiles", feerates_res);
-    ret_all.pushKV("height", (int64_t)pindex->nHeight);
-    ret_all.pushKV("ins", inputs);
-    ret_all.pushKV("maxfee", maxfee);
-    ret_all.pushKV("maxfeerate", maxfeerate);
-    ret_all.pushKV("maxtxsize", maxtxsize);
-    ret_all.pushKV("medianfee", CalculateTruncatedMedian(fee_array));
-    ret_all.pushKV("mediantime", pindex->GetMedianTimePast());
-    ret_all.pushKV("mediantxsize", CalculateTruncatedMedian(txsize_array));
-    ret_all.pushKV("minfee", (minfee == MAX_MONEY) ? 0 : minfee);
-    ret_all.pushKV("minfeerate", (minfeerate == MAX_MONEY) ? 0 : minfeerate);
-    ret_all.pushKV("mintxsize", mintxsize == MAX_BLOCK_SERIALIZED_SIZE ? 0 : mintxsize);
-    ret_all.pushKV("outs", outputs);
-    ret_all.pushKV("subsidy", GetBlockSubsidy(pindex->nHeight, Params().GetConsensus()));
-    ret_all.pushKV("swtotal_size", swtotal_size);
-    ret_all.pushKV("swtotal_weight", swtotal_weight);
-    ret_all.pushKV("swtxs", swtxs);
-    ret_all.pushKV("time", pindex->GetBlockTime());
-    ret_all.pushKV("total_out", total_out);
-    ret_all.pushKV("total_size", total_size);
-    ret_all.pushKV("total_weight", total_weight);
-    ret_all.pushKV("totalfee", totalfee);
-    ret_all.pushKV("txs", (int64_t)block.vtx.size());
-    ret_all.pushKV("utxo_increase", outputs - inputs);
-    ret_all.pushKV("utxo_size_inc", utxo_size_inc);
-
-    if (do_all) {
-        return ret_all;
+    if (request.result_stream) {
+        JSONWriter& writer = request.result_stream->Begin();
+        writer.BeginArray();
+        writer.Value(first);
+        for (size_t i = 1; i < blocks.size(); ++i) {
+            writer.Value(SelectBlockStats(BlockStatsToJSON(blocks[i], stats[i]), selected));
+        }
+        writer.EndArray();
+        return NullUniValue;
     }
 
-    UniValue ret(UniValue::VOBJ);
-    for (const std::string& stat : stats) {
-        const UniValue& value = ret_all[stat];
-        if (value.isNull()) {
-            throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid selected statistic %s", stat));
-        }
-        ret.pushKV(stat, value);
+    UniValue ret(UniValue::VARR);
+    ret.push_back(std::move(first));
+    for (size_t i = 1; i < blocks.size(); ++i) {
+        ret.push_back(SelectBlockStats(BlockStatsToJSON(blocks[i], stats[i]), selected));
     }
     return ret;
 },
@@ -2403,13 +2512,8 @@ static RPCHelpMan scantxoutset()
         result.pushKV("height", tip->nHeight);
         result.pushKV("bestblock", tip->GetBlockHash().GetHex());
 
-        for (const auto& it : coins) {
-            const COutPoint& outpoint = it.first;
-            const Coin& coin = it.second;
+        const auto unspent_to_json = [&](const COutPoint& outpoint, const Coin& coin) {
             const CTxOut& txo = coin.out;
-            input_txos.push_back(txo);
-            total_in += txo.nValue;
-
             UniValue unspent(UniValue::VOBJ);
             unspent.pushKV("txid", outpoint.hash.GetHex());
             unspent.pushKV("vout", (int32_t)outpoint.n);
@@ -2417,8 +2521,34 @@ static RPCHelpMan scantxoutset()
             unspent.pushKV("desc", descriptors[txo.scriptPubKey]);
             unspent.pushKV("amount", ValueFromAmount(txo.nValue));
             unspent.pushKV("height", (int32_t)coin.nHeight);
+            return unspent;
+        };
+
+        if (request.result_stream) {
+            // Wide descriptor ranges can match many outputs.
+            JSONWriter& writer = request.result_stream->Begin();
+            writer.BeginObject();
+            writer.Members(result);
+            writer.Key("unspents");
+            writer.BeginArray();
+            for (const auto& [outpoint, coin] : coins) {
+                total_in += coin.out.nValue;
+                writer.Value(unspent_to_json(outpoint, coin));
+            }
+            writer.EndArray();
+            writer.Pair("total_amount", ValueFromAmount(total_in));
+            writer.EndObject();
+            return NullUniValue;
+        }
 
-            unspents.push_back(unspent);
+        for (const auto& it : coins) {
+            const COutPoint& outpoint = it.first;
+            const Coin& coin = it.second;
+            const CTxOut& txo = coin.out;
+            input_txos.push_back(txo);
+            total_in += txo.nValue;
+
+            unspents.push_back(unspent_to_json(outpoint, coin));
         }
         result.pushKV("unspents", unspents);
         result.pushKV("total_amount", ValueFromAmount(total_in));
@@ -2509,6 +2639,96 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+static RPCHelpMan matchblockfilters()
+{
+    return RPCHelpMan{"matchblockfilters",
+                "\nMatch a set of scripts against the BIP 157 content filters of a range of blocks in the active chain.\n"
+                "Filters are decoded and matched in parallel; blocks whose filter may contain any of the scripts are returned.\n"
+                "As with any BIP 158 filter, matches may be false positives and the blocks must be checked by the caller.\n",
+                {
+                    {"scripts", RPCArg::Type::ARR, RPCArg::Optional::NO, "The scripts to match",
+                        {
+                            {"script", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A hex-encoded scriptPubKey"},
+                        },
+                    },
+                    {"start_height", RPCArg::Type::NUM, RPCArg::Default{0}, "The height of the first block to match"},
+                    {"stop_height", RPCArg::Type::NUM, RPCArg::DefaultHint{"the chain tip"}, "The height of the last block to match"},
+                    {"filtertype", RPCArg::Type::STR, RPCArg::Default{"basic"}, "The type name of the filter"},
+                },
+                RPCResult{
+                    RPCResult::Type::ARR, "", "",
+                    {
+                        {RPCResult::Type::OBJ, "", "",
+                        {
+                            {RPCResult::Type::NUM, "height", "The height of a matching block"},
+                            {RPCResult::Type::STR_HEX, "hash", "The hash of a matching block"},
+                        }},
+                    }},
+                RPCExamples{
+                    HelpExampleCli("matchblockfilters", "'[\"0014751e76e8199196d454941c45d1b3a323f1433bd6\"]' 600000") +
+                    HelpExampleRpc("matchblockfilters", "[\"0014751e76e8199196d454941c45d1b3a323f1433bd6\"], 600000")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    GCSFilter::ElementSet elements;
+    const UniValue& scripts = request.params[0].get_array();
+    for (size_t i = 0; i < scripts.size(); ++i) {
+        std::vector<unsigned char> script = ParseHexV(scripts[i], strprintf("scripts[%u]", i));
+        if (!script.empty()) elements.insert(std::move(script));
+    }
+
+    std::string filtertype_name = "basic";
+    if (!request.params[3].isNull()) {
+        filtertype_name = request.params[3].get_str();
+    }
+
+    BlockFilterType filtertype;
+    if (!BlockFilterTypeByName(filtertype_name, filtertype)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown filtertype");
+    }
+
+    BlockFilterIndex* index = GetBlockFilterIndex(filtertype);
+    if (!index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Index is not enabled for filtertype " + filtertype_name);
+    }
+
+    if (!index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Block filters are still in the process of being indexed.");
+    }
+
+    const int start_height = request.params[1].isNull() ? 0 : request.params[1].get_int();
+    const CBlockIndex* stop_index;
+    {
+        ChainstateManager& chainman = EnsureAnyChainman(request.context);
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        const int stop_height = request.params[2].isNull() ? active_chain.Height() : request.params[2].get_int();
+        if (stop_height < 0 || stop_height > active_chain.Height()) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Stop height out of range");
+        }
+        if (start_height < 0 || start_height > stop_height) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Start height out of range");
+        }
+        stop_index = active_chain[stop_height];
+    }
+
+    std::vector<int> heights;
+    if (!index->MatchFilterRange(start_height, stop_index, elements, heights)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Failed to read filters. This error is unexpected and indicates index corruption.");
+    }
+
+    UniValue ret(UniValue::VARR);
+    for (const int height : heights) {
+        UniValue match(UniValue::VOBJ);
+        match.pushKV("height", height);
+        match.pushKV("hash", stop_index->GetAncestor(height)->GetBlockHash().GetHex());
+        ret.push_back(match);
+    }
+    return ret;
+},
+    };
+}
+
 /**
  * Serialize the UTXO set to a file for loading elsewhere.
  *
@@ -2634,6 +2854,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         &getblockchaininfo,                  },
     { "blockchain",         &getchaintxstats,                    },
     { "blockchain",         &getblockstats,                      },
+    { "blockchain",         &getblockstatsrange,                 },
     { "blockchain",         &getbestblockhash,                   },
     { "blockchain",         &getblockcount,                      },
     { "blockchain",         &getblock,                           },
@@ -2655,6 +2876,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         &preciousblock,                      },
     { "blockchain",         &scantxoutset,                       },
     { "blockchain",         &getblockfilter,                     },
+    { "blockchain",         &matchblockfilters,                  },
 
     /* Not shown in help */
     { "hidden",              &invalidateblock,                   },
@@ -7,6 +7,7 @@
 
 #include <amount.h>
 #include <core_io.h>
+#include <node/blockstats.h>
 #include <streams.h>
 #include <sync.h>
 
@@ -17,6 +18,7 @@
 extern RecursiveMutex cs_main;
 
 class CBlock;
+class CBlockUndo;
 class CBlockIndex;
 class CBlockPolicyEstimator;
 class CChainState;
@@ -25,8 +27,6 @@ class ChainstateManager;
 class UniValue;
 struct NodeContext;
 
-static constexpr int NUM_GETBLOCKSTATS_PERCENTILES = 5;
-
 /**
  * Get the difficulty of the net wrt to the given block index.
  *
@@ -39,7 +39,15 @@ double GetDifficulty(const CBlockIndex* blockindex);
 void RPCNotifyBlockChange(const CBlockIndex*);
 
 /** Block description to JSON */
-UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, bool txDetails = false) LOCKS_EXCLUDED(cs_main);
+UniValue blockToJSON(const CBlock& block, const CBlockIndex* tip, const CBlockIndex* blockindex, TxVerbosity verbosity) LOCKS_EXCLUDED(cs_main);
+
+/**
+ * Get the outputs spent by the transactions of a block, from its undo data or,
+ * where that is not available, from the prevout index.
+ * @param[in] block  the block of blockindex if the caller has it, read from disk when it is needed otherwise
+ * @returns false if neither has them, as for the genesis block
+ */
+bool GetBlockUndo(const CBlockIndex* blockindex, const CBlock* block, CBlockUndo& blockundo);
 
 /** Mempool information to JSON */
 UniValue MempoolInfoToJSON(const CTxMemPool& pool);
@@ -50,11 +58,8 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose = false, bool includ
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex* tip, const CBlockIndex* blockindex) LOCKS_EXCLUDED(cs_main);
 
-/** Used by getblockstats to get feerates at different percentiles by weight  */
-void CalculatePercentilesByWeight(CAmount result[NUM_GETBLOCKSTATS_PERCENTILES], std::vector<std::pair<CAmount, int64_t>>& scores, int64_t total_weight);
-
 void ScriptPubKeyToUniv(const CScript& scriptPubKey, UniValue& out, bool fIncludeHex);
-void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex = true, int serialize_flags = 0, const CTxUndo* txundo = nullptr);
+void TxToUniv(const CTransaction& tx, const uint256& hashBlock, UniValue& entry, bool include_hex = true, int serialize_flags = 0, const CTxUndo* txundo = nullptr, TxVerbosity verbosity = TxVerbosity::SHOW_DETAILS);
 
 NodeContext& EnsureAnyNodeContext(const std::any& context);
 CTxMemPool& EnsureMemPool(const NodeContext& node);
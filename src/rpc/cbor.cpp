@@ -0,0 +1,513 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/cbor.h>
+
+#include <rpc/util.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/algorithm/string/split.hpp>
+
+namespace {
+
+//! Major types of data items
+enum : uint8_t {
+    CBOR_UINT = 0,
+    CBOR_NEGINT = 1,
+    CBOR_BYTES = 2,
+    CBOR_TEXT = 3,
+    CBOR_ARRAY = 4,
+    CBOR_MAP = 5,
+    CBOR_TAG = 6,
+    CBOR_SIMPLE = 7,
+};
+
+//! Additional information of the simple values and floats used
+enum : uint8_t {
+    CBOR_FALSE = 20,
+    CBOR_TRUE = 21,
+    CBOR_NULL = 22,
+    CBOR_UNDEFINED = 23,
+    CBOR_FLOAT16 = 25,
+    CBOR_FLOAT32 = 26,
+    CBOR_FLOAT64 = 27,
+};
+
+//! Tag of decimal fractions: an array of a base 10 exponent and a mantissa
+const uint64_t CBOR_TAG_DECIMAL_FRACTION = 4;
+
+//! Limit on the nesting of decoded arrays and maps, as for JSON
+const int MAX_CBOR_DEPTH = 512;
+
+//! Limit on the exponent of decoded decimal fractions
+const int64_t MAX_DECIMAL_EXPONENT = 100;
+
+//! Results that may describe a value
+using Candidates = std::vector<const RPCResult*>;
+
+/** Whether bytes are well-formed UTF-8, without overlong forms, surrogates or code points beyond U+10FFFF */
+bool IsValidUTF8(Span<const unsigned char> bytes)
+{
+    size_t i = 0;
+    while (i < bytes.size()) {
+        const unsigned char c = bytes[i];
+        size_t len;
+        uint32_t code_point;
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if ((c & 0xe0) == 0xc0) {
+            len = 2;
+            code_point = c & 0x1f;
+        } else if ((c & 0xf0) == 0xe0) {
+            len = 3;
+            code_point = c & 0x0f;
+        } else if ((c & 0xf8) == 0xf0) {
+            len = 4;
+            code_point = c & 0x07;
+        } else {
+            return false;
+        }
+        if (bytes.size() - i < len) return false;
+        for (size_t j = 1; j < len; ++j) {
+            if ((bytes[i + j] & 0xc0) != 0x80) return false;
+            code_point = code_point << 6 | (bytes[i + j] & 0x3f);
+        }
+        static const uint32_t MIN_CODE_POINT[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (code_point < MIN_CODE_POINT[len] || code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff)) return false;
+        i += len;
+    }
+    return true;
+}
+
+/** Parse a quality value of an Accept header, in thousandths. */
+bool ParseQuality(const std::string& str, int& quality)
+{
+    // qvalue = ( "0" [ "." 0*3DIGIT ] ) / ( "1" [ "." 0*3("0") ] )
+    if (str.empty() || (str[0] != '0' && str[0] != '1')) return false;
+    quality = (str[0] - '0') * 1000;
+    if (str.size() == 1) return true;
+    if (str[1] != '.' || str.size() > 5) return false;
+    int scale = 100;
+    for (size_t i = 2; i < str.size(); ++i, scale /= 10) {
+        if (!IsDigit(str[i])) return false;
+        quality += (str[i] - '0') * scale;
+    }
+    return quality <= 1000;
+}
+
+void WriteHead(std::string& out, uint8_t major, uint64_t arg)
+{
+    const char type = major << 5;
+    int bytes;
+    if (arg < 24) {
+        out += char(type | arg);
+        return;
+    } else if (arg <= 0xff) {
+        out += char(type | 24);
+        bytes = 1;
+    } else if (arg <= 0xffff) {
+        out += char(type | 25);
+        bytes = 2;
+    } else if (arg <= 0xffffffff) {
+        out += char(type | 26);
+        bytes = 4;
+    } else {
+        out += char(type | 27);
+        bytes = 8;
+    }
+    for (int i = bytes - 1; i >= 0; --i) {
+        out += char(arg >> (8 * i));
+    }
+}
+
+void WriteInteger(std::string& out, bool negative, uint64_t magnitude)
+{
+    if (negative && magnitude > 0) {
+        WriteHead(out, CBOR_NEGINT, magnitude - 1);
+    } else {
+        WriteHead(out, CBOR_UINT, magnitude);
+    }
+}
+
+void WriteDouble(std::string& out, double d)
+{
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(d));
+    std::memcpy(&bits, &d, sizeof(bits));
+    out += char(CBOR_SIMPLE << 5 | CBOR_FLOAT64);
+    for (int i = 7; i >= 0; --i) {
+        out += char(bits >> (8 * i));
+    }
+}
+
+/** Write the text of a JSON number, exactly where possible. */
+void WriteNumber(std::string& out, const std::string& num)
+{
+    size_t pos = 0;
+    const bool negative = pos < num.size() && num[pos] == '-';
+    if (negative) ++pos;
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    bool overflow = false;
+    bool fraction = false;
+    for (; pos < num.size(); ++pos) {
+        const char c = num[pos];
+        if (c == '.') {
+            fraction = true;
+        } else if (IsDigit(c)) {
+            if (mantissa > (std::numeric_limits<uint64_t>::max() - (c - '0')) / 10) overflow = true;
+            mantissa = mantissa * 10 + (c - '0');
+            if (fraction) --exponent;
+        } else {
+            break;
+        }
+    }
+    if (pos < num.size()) {
+        // Exponent part, as in the output of doubles
+        int64_t e = 0;
+        if (!ParseInt64(num.substr(pos + 1), &e) || e > MAX_DECIMAL_EXPONENT || e < -MAX_DECIMAL_EXPONENT) overflow = true;
+        exponent += e;
+    }
+    while (!overflow && exponent > 0 && mantissa <= std::numeric_limits<uint64_t>::max() / 10) {
+        mantissa *= 10;
+        --exponent;
+    }
+    if (overflow || exponent > 0 || exponent < -MAX_DECIMAL_EXPONENT) {
+        std::istringstream stream(num);
+        stream.imbue(std::locale::classic());
+        double d = 0;
+        stream >> d;
+        WriteDouble(out, d);
+    } else if (exponent == 0) {
+        WriteInteger(out, negative, mantissa);
+    } else {
+        WriteHead(out, CBOR_TAG, CBOR_TAG_DECIMAL_FRACTION);
+        WriteHead(out, CBOR_ARRAY, 2);
+        WriteInteger(out, true, -exponent);
+        WriteInteger(out, negative, mantissa);
+    }
+}
+
+void WriteValue(std::string& out, const UniValue& value, const Candidates& candidates)
+{
+    // Only those describing values of this type may describe the value.
+    Candidates matching;
+    for (const RPCResult* result : candidates) {
+        if (result->MatchesType(value)) matching.push_back(result);
+    }
+
+    switch (value.getType()) {
+    case UniValue::VNULL:
+        out += char(CBOR_SIMPLE << 5 | CBOR_NULL);
+        return;
+    case UniValue::VBOOL:
+        out += char(CBOR_SIMPLE << 5 | (value.isTrue() ? CBOR_TRUE : CBOR_FALSE));
+        return;
+    case UniValue::VNUM:
+        WriteNumber(out, value.getValStr());
+        return;
+    case UniValue::VSTR: {
+        const std::string& str = value.get_str();
+        const bool hex = std::any_of(matching.begin(), matching.end(), [](const RPCResult* result) { return result->m_type == RPCResult::Type::STR_HEX; });
+        if (hex && (str.empty() || IsHex(str))) {
+            const std::vector<unsigned char> bytes = ParseHex(str);
+            WriteHead(out, CBOR_BYTES, bytes.size());
+            out.append(bytes.begin(), bytes.end());
+        } else {
+            WriteHead(out, CBOR_TEXT, str.size());
+            out += str;
+        }
+        return;
+    }
+    case UniValue::VARR: {
+        WriteHead(out, CBOR_ARRAY, value.size());
+        const std::vector<UniValue>& values = value.getValues();
+        for (size_t i = 0; i < values.size(); ++i) {
+            Candidates inner;
+            for (const RPCResult* result : matching) {
+                if (result->m_type == RPCResult::Type::ARR) {
+                    for (const RPCResult& element : result->m_inner) inner.push_back(&element);
+                } else if (result->m_type == RPCResult::Type::ARR_FIXED && i < result->m_inner.size()) {
+                    inner.push_back(&result->m_inner[i]);
+                }
+            }
+            WriteValue(out, values[i], inner);
+        }
+        return;
+    }
+    case UniValue::VOBJ: {
+        WriteHead(out, CBOR_MAP, value.size());
+        const std::vector<std::string>& keys = value.getKeys();
+        const std::vector<UniValue>& values = value.getValues();
+        for (size_t i = 0; i < keys.size(); ++i) {
+            Candidates inner;
+            for (const RPCResult* result : matching) {
+                for (const RPCResult& member : result->m_inner) {
+                    if (result->m_type == RPCResult::Type::OBJ_DYN || (result->m_type == RPCResult::Type::OBJ && member.m_key_name == keys[i])) {
+                        inner.push_back(&member);
+                    }
+                }
+            }
+            WriteHead(out, CBOR_TEXT, keys[i].size());
+            out += keys[i];
+            WriteValue(out, values[i], inner);
+        }
+        return;
+    }
+    }
+}
+
+Candidates CandidatesOf(const RPCResults* results)
+{
+    Candidates candidates;
+    if (results) {
+        for (const RPCResult& result : results->m_results) candidates.push_back(&result);
+    }
+    return candidates;
+}
+
+void WriteReply(std::string& out, const UniValue& reply, const RPCResults* results)
+{
+    if (!reply.isObject()) {
+        WriteValue(out, reply, {});
+        return;
+    }
+    WriteHead(out, CBOR_MAP, reply.size());
+    const std::vector<std::string>& keys = reply.getKeys();
+    const std::vector<UniValue>& values = reply.getValues();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        WriteHead(out, CBOR_TEXT, keys[i].size());
+        out += keys[i];
+        WriteValue(out, values[i], keys[i] == "result" ? CandidatesOf(results) : Candidates{});
+    }
+}
+
+class CBORReader
+{
+public:
+    explicit CBORReader(Span<const unsigned char> data) : m_data(data) {}
+
+    bool Done() const { return m_data.empty(); }
+
+    bool ReadValue(UniValue& value, int depth)
+    {
+        uint8_t major;
+        uint8_t info;
+        uint64_t arg;
+        if (!ReadHead(major, info, arg)) return false;
+        switch (major) {
+        case CBOR_UINT:
+            value = UniValue(arg);
+            return true;
+        case CBOR_NEGINT:
+            if (arg <= uint64_t(std::numeric_limits<int64_t>::max())) {
+                value = UniValue(-1 - int64_t(arg));
+            } else {
+                // Beyond int64_t, down to -2^64
+                value = UniValue(UniValue::VNUM, arg == std::numeric_limits<uint64_t>::max() ? "-18446744073709551616" : "-" + ToString(arg + 1));
+            }
+            return true;
+        case CBOR_BYTES:
+        case CBOR_TEXT: {
+            if (arg > m_data.size()) return false;
+            const Span<const unsigned char> bytes = m_data.first(arg);
+            m_data = m_data.subspan(arg);
+            if (major == CBOR_TEXT && !IsValidUTF8(bytes)) return false;
+            value = major == CBOR_BYTES ? UniValue(HexStr(bytes)) : UniValue(std::string(bytes.begin(), bytes.end()));
+            return true;
+        }
+        case CBOR_ARRAY: {
+            // Each element takes at least a byte.
+            if (depth >= MAX_CBOR_DEPTH || arg > m_data.size()) return false;
+            value = UniValue(UniValue::VARR);
+            for (uint64_t i = 0; i < arg; ++i) {
+                UniValue element;
+                if (!ReadValue(element, depth + 1)) return false;
+                value.push_back(std::move(element));
+            }
+            return true;
+        }
+        case CBOR_MAP: {
+            if (depth >= MAX_CBOR_DEPTH || arg > m_data.size() / 2) return false;
+            value = UniValue(UniValue::VOBJ);
+            for (uint64_t i = 0; i < arg; ++i) {
+                UniValue key;
+                UniValue member;
+                if (!ReadValue(key, depth + 1) || !key.isStr() || !ReadValue(member, depth + 1)) return false;
+                value.pushKV(key.get_str(), std::move(member));
+            }
+            return true;
+        }
+        case CBOR_TAG:
+            if (arg == CBOR_TAG_DECIMAL_FRACTION) return ReadDecimalFraction(value, depth);
+            // Other tags only add meaning to the item.
+            return depth < MAX_CBOR_DEPTH && ReadValue(value, depth + 1);
+        case CBOR_SIMPLE:
+            return ReadSimple(info, arg, value);
+        }
+        return false;
+    }
+
+private:
+    Span<const unsigned char> m_data;
+
+    bool ReadHead(uint8_t& major, uint8_t& info, uint64_t& arg)
+    {
+        if (m_data.empty()) return false;
+        major = m_data[0] >> 5;
+        info = m_data[0] & 0x1f;
+        m_data = m_data.subspan(1);
+        if (info < 24) {
+            arg = info;
+            return true;
+        }
+        // Indefinite lengths (31) and reserved values are not supported.
+        if (info > 27) return false;
+        const size_t bytes = size_t{1} << (info - 24);
+        if (m_data.size() < bytes) return false;
+        arg = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            arg = arg << 8 | m_data[i];
+        }
+        m_data = m_data.subspan(bytes);
+        return true;
+    }
+
+    bool ReadDecimalFraction(UniValue& value, int depth)
+    {
+        UniValue parts;
+        if (depth >= MAX_CBOR_DEPTH || !ReadValue(parts, depth + 1) || !parts.isArray() || parts.size() != 2) return false;
+        // Decoded integers are integral JSON numbers.
+        int64_t exponent;
+        if (!parts[0].isNum() || !ParseInt64(parts[0].getValStr(), &exponent)) return false;
+        if (!parts[1].isNum() || parts[1].getValStr().find_first_of(".eE") != std::string::npos) return false;
+        if (exponent > MAX_DECIMAL_EXPONENT || exponent < -MAX_DECIMAL_EXPONENT) return false;
+        std::string digits = parts[1].getValStr();
+        const bool negative = digits[0] == '-';
+        if (negative) digits.erase(0, 1);
+        if (exponent >= 0) {
+            digits.append(exponent, '0');
+        } else {
+            if (digits.size() <= size_t(-exponent)) digits.insert(0, -exponent - digits.size() + 1, '0');
+            digits.insert(digits.size() + exponent, 1, '.');
+        }
+        value = UniValue(UniValue::VNUM, negative ? "-" + digits : digits);
+        return true;
+    }
+
+    bool ReadSimple(uint8_t info, uint64_t arg, UniValue& value)
+    {
+        double d;
+        switch (info) {
+        case CBOR_FALSE:
+        case CBOR_TRUE:
+            value = UniValue(info == CBOR_TRUE);
+            return true;
+        case CBOR_NULL:
+        case CBOR_UNDEFINED:
+            value = NullUniValue;
+            return true;
+        case CBOR_FLOAT16: {
+            const int exponent = (arg >> 10) & 0x1f;
+            const int mantissa = arg & 0x3ff;
+            if (exponent == 0x1f) return false;
+            d = exponent == 0 ? std::ldexp(mantissa, -24) : std::ldexp(mantissa + 1024, exponent - 25);
+            if (arg & 0x8000) d = -d;
+            break;
+        }
+        case CBOR_FLOAT32: {
+            const uint32_t bits = arg;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            d = f;
+            break;
+        }
+        case CBOR_FLOAT64:
+            std::memcpy(&d, &arg, sizeof(d));
+            break;
+        default:
+            return false;
+        }
+        if (!std::isfinite(d)) return false;
+        value = UniValue(d);
+        return true;
+    }
+};
+
+} // namespace
+
+std::string EncodeCBOR(const UniValue& value, const RPCResults* results)
+{
+    std::string out;
+    WriteValue(out, value, CandidatesOf(results));
+    return out;
+}
+
+std::string EncodeCBORReply(const UniValue& reply, const RPCResults* results)
+{
+    std::string out;
+    WriteReply(out, reply, results);
+    return out;
+}
+
+std::string EncodeCBORBatchReply(const UniValue& replies, const std::vector<const RPCResults*>& results)
+{
+    std::string out;
+    WriteHead(out, CBOR_ARRAY, replies.size());
+    for (size_t i = 0; i < replies.size(); ++i) {
+        WriteReply(out, replies[i], i < results.size() ? results[i] : nullptr);
+    }
+    return out;
+}
+
+bool DecodeCBOR(Span<const unsigned char> data, UniValue& value)
+{
+    CBORReader reader(data);
+    return reader.ReadValue(value, 0) && reader.Done();
+}
+
+bool IsCBORContentType(const std::string& content_type)
+{
+    // Parameters, like a charset, follow the media type.
+    return ToLower(TrimString(content_type.substr(0, content_type.find(';')))) == CBOR_CONTENT_TYPE;
+}
+
+bool AcceptsCBOR(const std::string& accept)
+{
+    int cbor_quality = 0;
+    int json_quality = 0;
+    std::vector<std::string> ranges;
+    boost::split(ranges, accept, boost::is_any_of(","));
+    for (const std::string& range : ranges) {
+        std::vector<std::string> parts;
+        boost::split(parts, range, boost::is_any_of(";"));
+        const std::string type = ToLower(TrimString(parts[0]));
+        int quality = 1000;
+        bool valid = true;
+        for (size_t i = 1; i < parts.size(); ++i) {
+            const std::string param = ToLower(TrimString(parts[i]));
+            if (param.rfind("q=", 0) == 0) valid = ParseQuality(param.substr(2), quality);
+        }
+        if (!valid) continue;
+        if (type == CBOR_CONTENT_TYPE) {
+            cbor_quality = std::max(cbor_quality, quality);
+        } else if (type == "application/json" || type == "application/*" || type == "*/*") {
+            json_quality = std::max(json_quality, quality);
+        }
+    }
+    return cbor_quality > 0 && cbor_quality >= json_quality;
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_RPC_CBOR_H
+#define chymera_RPC_CBOR_H
+
+#include <span.h>
+
+#include <string>
+#include <vector>
+
+class UniValue;
+struct RPCResults;
+
+/** Media type of CBOR (RFC 8949) encoded RPC requests and replies */
+static const char* const CBOR_CONTENT_TYPE = "application/cbor";
+
+/**
+ * Encode a value as CBOR. Objects become maps. Numbers become integers if
+ * they have no fractional part, and decimal fractions (tag 4) otherwise, so
+ * that amounts stay exact. Strings that results describes as hex (STR_HEX)
+ * become byte strings with the bytes that the hex stands for, in the order
+ * in which it shows them.
+ *
+ * The value is the one the JSON reply would be written from, so hex and
+ * amounts have already been formatted as text and are parsed back here.
+ * Encoding CBOR makes replies smaller than JSON, not cheaper to produce.
+ */
+std::string EncodeCBOR(const UniValue& value, const RPCResults* results = nullptr);
+
+/** Encode a JSON-RPC reply object, whose result is described by results. */
+std::string EncodeCBORReply(const UniValue& reply, const RPCResults* results);
+
+/** Encode the replies to a batch, each result described by the same element of results. */
+std::string EncodeCBORBatchReply(const UniValue& replies, const std::vector<const RPCResults*>& results);
+
+/**
+ * Decode a single CBOR data item. Byte strings become hex strings, decimal
+ * fractions numbers and maps objects, whose keys must be text strings.
+ * Text strings must be valid UTF-8. Indefinite-length items are not supported.
+ * @returns false if data is not exactly one well-formed item of these kinds
+ */
+bool DecodeCBOR(Span<const unsigned char> data, UniValue& value);
+
+/** Whether the media type of a Content-Type header value is CBOR. */
+bool IsCBORContentType(const std::string& content_type);
+
+/**
+ * Whether a reply in CBOR is acceptable according to an Accept header value,
+ * and preferred to JSON: CBOR is listed with a nonzero quality (q), which is
+ * not below that of JSON or the wildcards matching it.
+ */
+bool AcceptsCBOR(const std::string& accept);
+
+#endif // chymera_RPC_CBOR_H
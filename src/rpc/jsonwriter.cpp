@@ -0,0 +1,110 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonwriter.h>
+
+#include <univalue.h>
+
+#include <algorithm>
+#include <cassert>
+
+JSONWriter::JSONWriter(Sink sink) : m_sink(std::move(sink))
+{
+    m_buffer.reserve(CHUNK_SIZE);
+}
+
+void JSONWriter::Separate()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (m_nonempty.empty()) return;
+    if (m_nonempty.back()) m_buffer += ',';
+    m_nonempty.back() = true;
+}
+
+void JSONWriter::MaybeFlush()
+{
+    if (m_buffer.size() >= CHUNK_SIZE) Flush();
+}
+
+void JSONWriter::BeginObject()
+{
+    Separate();
+    m_buffer += '{';
+    m_nonempty.push_back(false);
+}
+
+void JSONWriter::EndObject()
+{
+    assert(!m_nonempty.empty() && !m_after_key);
+    m_nonempty.pop_back();
+    m_buffer += '}';
+    MaybeFlush();
+}
+
+void JSONWriter::BeginArray()
+{
+    Separate();
+    m_buffer += '[';
+    m_nonempty.push_back(false);
+}
+
+void JSONWriter::EndArray()
+{
+    assert(!m_nonempty.empty() && !m_after_key);
+    m_nonempty.pop_back();
+    m_buffer += ']';
+    MaybeFlush();
+}
+
+void JSONWriter::Key(const std::string& key)
+{
+    assert(!m_nonempty.empty() && !m_after_key);
+    Separate();
+    m_buffer += UniValue(key).write();
+    m_buffer += ':';
+    m_after_key = true;
+}
+
+void JSONWriter::Value(const UniValue& value)
+{
+    Separate();
+    m_buffer += value.write();
+    MaybeFlush();
+}
+
+void JSONWriter::Members(const UniValue& object)
+{
+    assert(object.isObject());
+    const std::vector<std::string>& keys = object.getKeys();
+    const std::vector<UniValue>& values = object.getValues();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        Pair(keys[i], values[i]);
+    }
+}
+
+void JSONWriter::RawValuePart(Span<const char> json, bool first)
+{
+    if (first) Separate();
+    if (m_buffer.size() + json.size() < CHUNK_SIZE) {
+        m_buffer.append(json.begin(), json.end());
+        return;
+    }
+    // Pass large values on without copying them into the buffer.
+    Flush();
+    while (!json.empty()) {
+        const size_t size = std::min(json.size(), CHUNK_SIZE);
+        m_sink(json.first(size));
+        json = json.subspan(size);
+    }
+}
+
+void JSONWriter::Flush()
+{
+    if (m_buffer.empty()) return;
+    m_sink(m_buffer);
+    m_buffer.clear();
+}
@@ -0,0 +1,72 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_RPC_JSONWRITER_H
+#define chymera_RPC_JSONWRITER_H
+
+#include <span.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class UniValue;
+
+/**
+ * Writes JSON text incrementally, for results too large to build as one
+ * UniValue first. The caller opens and closes the containers, and writes
+ * each element as a UniValue of its own, so that only one element at a time
+ * needs to be held in memory. The text is the same as UniValue::write()
+ * produces for the whole, and is handed to the sink in chunks of about
+ * CHUNK_SIZE bytes.
+ */
+class JSONWriter
+{
+public:
+    using Sink = std::function<void(Span<const char>)>;
+
+    static constexpr size_t CHUNK_SIZE{64 << 10};
+
+    explicit JSONWriter(Sink sink);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Write an object key. Must be followed by a value or container. */
+    void Key(const std::string& key);
+    void Value(const UniValue& value);
+    void Pair(const std::string& key, const UniValue& value)
+    {
+        Key(key);
+        Value(value);
+    }
+    /** Write the members of an object value into the open object. */
+    void Members(const UniValue& object);
+    /** Write a value that is already JSON text. */
+    void RawValue(Span<const char> json) { RawValuePart(json, /* first */ true); }
+    /**
+     * Write a value that is already JSON text in parts, such as the chunks of
+     * another writer. Only the first part is separated from the previous value.
+     */
+    void RawValuePart(Span<const char> json, bool first);
+
+    /** Pass everything written so far to the sink. */
+    void Flush();
+
+private:
+    const Sink m_sink;
+    std::string m_buffer;
+    //! For each open container, whether anything was written to it yet.
+    std::vector<bool> m_nonempty;
+    //! A key was written and its value is next.
+    bool m_after_key{false};
+
+    //! Start a value or key: separate it from the previous one.
+    void Separate();
+    void MaybeFlush();
+};
+
+#endif // chymera_RPC_JSONWRITER_H
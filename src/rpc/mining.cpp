@@ -10,6 +10,7 @@
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <httpserver.h>
 #include <key_io.h>
 #include <miner.h>
 #include <net.h>
@@ -712,6 +713,7 @@ static RPCHelpMan getblocktemplate()
         {
             checktxtime = std::chrono::steady_clock::now() + std::chrono::minutes(1);
 
+            HTTPWorkerParkScope park;
             WAIT_LOCK(g_best_block_mutex, lock);
             while (g_best_block == hashWatchedChain && IsRPCRunning())
             {
@@ -5,7 +5,9 @@
 
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
+#include <index/blockstatsindex.h>
 #include <index/coinstatsindex.h>
+#include <index/prevoutindex.h>
 #include <index/txindex.h>
 #include <interfaces/chain.h>
 #include <interfaces/echo.h>
@@ -15,6 +17,7 @@
 #include <node/context.h>
 #include <outputtype.h>
 #include <rpc/blockchain.h>
+#include <rpc/responsecache.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 #include <scheduler.h>
@@ -452,6 +455,20 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCResponseCacheInfo(const ResponseCache& cache)
+{
+    const ResponseCache::Stats stats = cache.GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("entries", uint64_t(stats.entries));
+    obj.pushKV("used", uint64_t(stats.bytes));
+    obj.pushKV("max", uint64_t(stats.max_bytes));
+    obj.pushKV("hits", stats.hits);
+    obj.pushKV("misses", stats.misses);
+    const uint64_t requests = stats.hits + stats.misses;
+    obj.pushKV("hit_ratio", requests ? double(stats.hits) / requests : 0.0);
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -496,6 +513,15 @@ static RPCHelpMan getmemoryinfo()
                                 {RPCResult::Type::NUM, "chunks_used", "Number allocated chunks"},
                                 {RPCResult::Type::NUM, "chunks_free", "Number unused chunks"},
                             }},
+                            {RPCResult::Type::OBJ, "response_cache", /* optional */ true, "Information about the replies kept for repeated requests, if enabled (-rpccachesize)",
+                            {
+                                {RPCResult::Type::NUM, "entries", "Number of replies"},
+                                {RPCResult::Type::NUM, "used", "Number of bytes used"},
+                                {RPCResult::Type::NUM, "max", "Number of bytes that may be used"},
+                                {RPCResult::Type::NUM, "hits", "Number of requests answered from it"},
+                                {RPCResult::Type::NUM, "misses", "Number of requests it could have answered but did not"},
+                                {RPCResult::Type::NUM, "hit_ratio", "Share of hits among these requests"},
+                            }},
                         }
                     },
                     RPCResult{"mode \"mallocinfo\"",
@@ -512,6 +538,7 @@ static RPCHelpMan getmemoryinfo()
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.pushKV("locked", RPCLockedMemoryInfo());
+        if (g_response_cache) obj.pushKV("response_cache", RPCResponseCacheInfo(*g_response_cache));
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -734,6 +761,14 @@ static RPCHelpMan getindexinfo()
         result.pushKVs(SummaryToJSON(g_coin_stats_index->GetSummary(), index_name));
     }
 
+    if (g_prevout_index) {
+        result.pushKVs(SummaryToJSON(g_prevout_index->GetSummary(), index_name));
+    }
+
+    if (g_block_stats_index) {
+        result.pushKVs(SummaryToJSON(g_block_stats_index->GetSummary(), index_name));
+    }
+
     ForEachBlockFilterIndex([&result, &index_name](const BlockFilterIndex& index) {
         result.pushKVs(SummaryToJSON(index.GetSummary(), index_name));
     });
@@ -7,6 +7,7 @@
 #include <coins.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <index/prevoutindex.h>
 #include <index/txindex.h>
 #include <key_io.h>
 #include <merkleblock.h>
@@ -42,14 +43,14 @@
 
 #include <univalue.h>
 
-static void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry, CChainState& active_chainstate)
+static void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry, CChainState& active_chainstate, const CTxUndo* txundo = nullptr, TxVerbosity verbosity = TxVerbosity::SHOW_DETAILS)
 {
     // Call into TxToUniv() in chymera-common to decode the transaction hex.
     //
     // Blockchain contextual information (confirmations and blocktime) is not
     // available to code in chymera-common, so we query them here and push the
     // data into the returned UniValue.
-    TxToUniv(tx, uint256(), entry, true, RPCSerializationFlags());
+    TxToUniv(tx, uint256(), entry, true, RPCSerializationFlags(), txundo, verbosity);
 
     if (!hashBlock.IsNull()) {
         LOCK(cs_main);
@@ -82,18 +83,20 @@ static RPCHelpMan getrawtransaction()
 
                 "\nHint: Use gettransaction for wallet transactions.\n"
 
-                "\nIf verbose is 'true', returns an Object with information about 'txid'.\n"
-                "If verbose is 'false' or omitted, returns a string that is serialized, hex-encoded data for 'txid'.\n",
+                "\nIf verbose is 1 or 'true', returns an Object with information about 'txid'.\n"
+                "If verbose is 0, 'false' or omitted, returns a string that is serialized, hex-encoded data for 'txid'.\n"
+                "With -prevoutindex enabled, the Object of a confirmed transaction includes its fee, and if verbose\n"
+                "is 2, prevout information for each input.\n",
                 {
                     {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::NO, "The transaction id"},
-                    {"verbose", RPCArg::Type::BOOL, RPCArg::Default{false}, "If false, return a string, otherwise return a json object"},
+                    {"verbose", RPCArg::Type::NUM, RPCArg::Default{0}, "0 (or false) for hex-encoded data, 1 (or true) for a json object, and 2 for a json object with prevout information for inputs", "", {"", "numeric or boolean"}},
                     {"blockhash", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED_NAMED_ARG, "The block in which to look for the transaction"},
                 },
                 {
-                    RPCResult{"if verbose is not set or set to false",
+                    RPCResult{"if verbose is not set or set to 0 or false",
                          RPCResult::Type::STR, "data", "The serialized, hex-encoded data for 'txid'"
                      },
-                     RPCResult{"if verbose is set to true",
+                     RPCResult{"if verbose is set to 1, true or 2",
                          RPCResult::Type::OBJ, "", "",
                          {
                              {RPCResult::Type::BOOL, "in_active_chain", "Whether specified block is in the active chain or not (only present with explicit \"blockhash\" argument)"},
@@ -143,6 +146,7 @@ static RPCHelpMan getrawtransaction()
                                      }},
                                  }},
                              }},
+                             {RPCResult::Type::NUM, "fee", /* optional */ true, "The transaction fee in " + CURRENCY_UNIT + " (only for confirmed transactions with -prevoutindex)"},
                              {RPCResult::Type::STR_HEX, "blockhash", "the block hash"},
                              {RPCResult::Type::NUM, "confirmations", "The confirmations"},
                              {RPCResult::Type::NUM_TIME, "blocktime", "The block time expressed in " + UNIX_EPOCH_TIME},
@@ -173,8 +177,10 @@ static RPCHelpMan getrawtransaction()
 
     // Accept either a bool (true) or a num (>=1) to indicate verbose output.
     bool fVerbose = false;
+    bool show_prevouts = false;
     if (!request.params[1].isNull()) {
         fVerbose = request.params[1].isNum() ? (request.params[1].get_int() != 0) : request.params[1].get_bool();
+        show_prevouts = request.params[1].isNum() && request.params[1].get_int() >= 2;
     }
 
     if (!request.params[2].isNull()) {
@@ -216,9 +222,18 @@ static RPCHelpMan getrawtransaction()
         return EncodeHexTx(*tx, RPCSerializationFlags());
     }
 
+    // A confirmed transaction's spent outputs can be recovered from the prevout
+    // index in one lookup per input, without going through txindex.
+    CTxUndo txundo;
+    bool have_undo = false;
+    if (g_prevout_index && !hash_block.IsNull() && !tx->IsCoinBase() && g_prevout_index->BlockUntilSyncedToCurrentChain()) {
+        have_undo = g_prevout_index->FindPrevouts(*tx, txundo);
+    }
+
     UniValue result(UniValue::VOBJ);
     if (blockindex) result.pushKV("in_active_chain", in_active_chain);
-    TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate());
+    TxToJSON(*tx, hash_block, result, chainman.ActiveChainstate(), have_undo ? &txundo : nullptr,
+             show_prevouts ? TxVerbosity::SHOW_DETAILS_AND_PREVOUT : TxVerbosity::SHOW_DETAILS);
     return result;
 },
     };
@@ -373,6 +388,87 @@ static RPCHelpMan verifytxoutproof()
     };
 }
 
+static RPCHelpMan getrawtransactions()
+{
+    return RPCHelpMan{
+                "getrawtransactions",
+                "\nReturn the raw transaction data for a list of transactions.\n"
+
+                "\nThis is the array form of getrawtransaction. Each transaction is looked up in the mempool first and\n"
+                "then, if -txindex is enabled, in the blockchain. Index lookups are batched so that every block file\n"
+                "is read once, in order, no matter how many of the requested transactions it contains.\n"
+
+                "\nIf verbose is 'true', each entry is an Object with information about the transaction, in the format\n"
+                "of getrawtransaction. Otherwise each entry is the serialized, hex-encoded data of the transaction.\n"
+                "Entries for transactions that are not found are null.\n",
+                {
+                    {"txids", RPCArg::Type::ARR, RPCArg::Optional::NO, "The transaction ids",
+                        {
+                            {"txid", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "A transaction id"},
+                        },
+                    },
+                    {"verbose", RPCArg::Type::BOOL, RPCArg::Default{false}, "If false, return strings, otherwise return json objects"},
+                },
+                {
+                    RPCResult{"if verbose is not set or set to false",
+                        RPCResult::Type::ARR, "", "",
+                        {
+                            {RPCResult::Type::STR_HEX, "data", "The serialized, hex-encoded data of the transaction, or null if not found"},
+                        }
+                    },
+                    RPCResult{"if verbose is set to true",
+                        RPCResult::Type::ARR, "", "",
+                        {
+                            {RPCResult::Type::OBJ, "", "",
+                            {
+                                {RPCResult::Type::ELISION, "", "The same output as getrawtransaction with verbose = true, or null if not found"},
+                            }},
+                        }
+                    },
+                },
+                RPCExamples{
+                    HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]'")
+            + HelpExampleCli("getrawtransactions", "'[\"mytxid\",\"mytxid2\"]' true")
+            + HelpExampleRpc("getrawtransactions", "[\"mytxid\",\"mytxid2\"], true")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const NodeContext& node = EnsureAnyNodeContext(request.context);
+    ChainstateManager& chainman = EnsureChainman(node);
+
+    const UniValue& txids = request.params[0].get_array();
+    const bool fVerbose = request.params[1].isNull() ? false : request.params[1].get_bool();
+
+    std::vector<uint256> hashes;
+    hashes.reserve(txids.size());
+    for (size_t i = 0; i < txids.size(); ++i) {
+        hashes.push_back(ParseHashV(txids[i], strprintf("txids[%u]", i)));
+    }
+
+    if (g_txindex) {
+        g_txindex->BlockUntilSyncedToCurrentChain();
+    }
+
+    std::vector<uint256> block_hashes;
+    const std::vector<CTransactionRef> txs = GetTransactions(node.mempool.get(), hashes, block_hashes);
+
+    UniValue result(UniValue::VARR);
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        if (!txs[i]) {
+            result.push_back(NullUniValue);
+        } else if (!fVerbose) {
+            result.push_back(EncodeHexTx(*txs[i], RPCSerializationFlags()));
+        } else {
+            UniValue entry(UniValue::VOBJ);
+            TxToJSON(*txs[i], block_hashes[i], entry, chainman.ActiveChainstate());
+            result.push_back(entry);
+        }
+    }
+    return result;
+},
+    };
+}
+
 static RPCHelpMan createrawtransaction()
 {
     return RPCHelpMan{"createrawtransaction",
@@ -1900,6 +1996,7 @@ static const CRPCCommand commands[] =
 { //  category               actor (function)
   //  ---------------------  -----------------------
     { "rawtransactions",     &getrawtransaction,          },
+    { "rawtransactions",     &getrawtransactions,         },
     { "rawtransactions",     &createrawtransaction,       },
     { "rawtransactions",     &decoderawtransaction,       },
     { "rawtransactions",     &decodescript,               },
@@ -11,6 +11,8 @@
 
 #include <univalue.h>
 
+class JSONWriter;
+
 UniValue JSONRPCRequestObj(const std::string& strMethod, const UniValue& params, const UniValue& id);
 UniValue JSONRPCReplyObj(const UniValue& result, const UniValue& error, const UniValue& id);
 std::string JSONRPCReply(const UniValue& result, const UniValue& error, const UniValue& id);
@@ -25,6 +27,27 @@ void DeleteAuthCookie();
 /** Parse JSON-RPC batch reply into a vector */
 std::vector<UniValue> JSONRPCProcessBatchReply(const UniValue& in);
 
+/**
+ * Lets an RPC method write its result as it is produced, instead of returning
+ * it as one UniValue. Offered by transports that can send a reply in parts
+ * (the HTTP server, for requests that are not part of a batch).
+ */
+class JSONRPCResultStream
+{
+public:
+    virtual ~JSONRPCResultStream() = default;
+
+    /**
+     * Start the reply and return the writer for the result, which must be
+     * written as exactly one JSON value. The method then returns NullUniValue.
+     *
+     * @note The reply is committed at this point: errors thrown later can only
+     * cut it short, so do everything that may fail for the caller's input first.
+     */
+    virtual JSONWriter& Begin() = 0;
+    virtual bool Started() const = 0;
+};
+
 class JSONRPCRequest
 {
 public:
@@ -36,6 +59,8 @@ public:
     std::string authUser;
     std::string peerAddr;
     std::any context;
+    //! Set when the result may be streamed, see JSONRPCResultStream.
+    JSONRPCResultStream* result_stream{nullptr};
 
     void parse(const UniValue& valRequest);
 };
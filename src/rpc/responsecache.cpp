@@ -0,0 +1,95 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/responsecache.h>
+
+#include <chain.h>
+
+#include <iterator>
+
+std::unique_ptr<ResponseCache> g_response_cache;
+
+ResponseCache::ResponseCache(size_t max_bytes) : m_max_bytes(max_bytes) {}
+
+ResponseCache::Key ResponseCache::MakeKey(const std::string& method, const std::string& params, Scope scope, const uint256& tip) const
+{
+    Key key;
+    key.key = method;
+    key.key += '\0';
+    key.key += params;
+    key.scope = scope;
+    if (scope == Scope::TIP) {
+        key.tip = tip;
+        key.key += '\0';
+        key.key += tip.ToString();
+    }
+    key.generation = WITH_LOCK(m_mutex, return m_generation);
+    return key;
+}
+
+std::shared_ptr<const std::string> ResponseCache::Get(const Key& key)
+{
+    LOCK(m_mutex);
+    const auto it = m_index.find(key.key);
+    if (it == m_index.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->reply;
+}
+
+void ResponseCache::Put(const Key& key, std::string reply)
+{
+    Entry entry{key.key, std::make_shared<const std::string>(std::move(reply)), key.scope, key.tip};
+    const size_t usage = Usage(entry);
+    if (usage > MaxReplySize()) return;
+
+    LOCK(m_mutex);
+    // The reply may have been computed from blocks that are no longer in the chain.
+    if (key.generation != m_generation) return;
+    const auto it = m_index.find(key.key);
+    if (it != m_index.end()) Erase(it->second);
+    while (!m_entries.empty() && m_bytes + usage > m_max_bytes) {
+        Erase(std::prev(m_entries.end()));
+    }
+    m_entries.push_front(std::move(entry));
+    m_index.emplace(m_entries.front().key, m_entries.begin());
+    m_bytes += usage;
+}
+
+void ResponseCache::Erase(std::list<Entry>::iterator it)
+{
+    AssertLockHeld(m_mutex);
+    m_bytes -= Usage(*it);
+    m_index.erase(it->key);
+    m_entries.erase(it);
+}
+
+ResponseCache::Stats ResponseCache::GetStats() const
+{
+    LOCK(m_mutex);
+    return Stats{m_entries.size(), m_bytes, m_max_bytes, m_hits, m_misses};
+}
+
+void ResponseCache::UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload)
+{
+    const uint256 tip = pindexNew->GetBlockHash();
+    LOCK(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        const auto next = std::next(it);
+        if (it->scope == Scope::TIP && it->tip != tip) Erase(it);
+        it = next;
+    }
+}
+
+void ResponseCache::BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex)
+{
+    LOCK(m_mutex);
+    ++m_generation;
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
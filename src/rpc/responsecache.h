@@ -0,0 +1,105 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef chymera_RPC_RESPONSECACHE_H
+#define chymera_RPC_RESPONSECACHE_H
+
+#include <sync.h>
+#include <uint256.h>
+#include <validationinterface.h>
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+//! Default for -rpccachesize, in MiB
+static const int64_t DEFAULT_RPC_CACHE_SIZE = 16;
+
+/**
+ * Keeps the replies to RPC and REST requests for block data, such as
+ * getblock, so that repeats are answered without reading the block again
+ * and rendering it once more. Replies are kept as their text, least recently
+ * used first out, within a bound on memory.
+ *
+ * A reply is kept as long as what it depends on besides the request stays
+ * the same: the blocks of the active chain, and for some also the tip.
+ */
+class ResponseCache : public CValidationInterface
+{
+public:
+    enum class Scope {
+        CHAIN, //!< Dropped when a block is disconnected
+        TIP,   //!< Dropped when the tip changes too, e.g. for confirmations
+    };
+
+    struct Key {
+        std::string key;
+        Scope scope;
+        uint256 tip;
+        //! Number of disconnections when the key was made
+        uint64_t generation;
+    };
+
+    struct Stats {
+        size_t entries;
+        size_t bytes;
+        size_t max_bytes;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    //! Memory accounted for each reply on top of its key and text
+    static constexpr size_t ENTRY_OVERHEAD{160};
+
+    explicit ResponseCache(size_t max_bytes);
+
+    /**
+     * Make the key of a request, before computing its reply.
+     * @param[in] tip  the current tip, for Scope::TIP
+     */
+    Key MakeKey(const std::string& method, const std::string& params, Scope scope, const uint256& tip = uint256()) const;
+
+    /** Get the reply to a request, or nullptr. */
+    std::shared_ptr<const std::string> Get(const Key& key);
+
+    /** Keep the reply to a request, unless a block was disconnected since the key was made. */
+    void Put(const Key& key, std::string reply);
+
+    /** Replies larger than this are not kept, so that one cannot evict all others. */
+    size_t MaxReplySize() const { return m_max_bytes / 8; }
+
+    Stats GetStats() const;
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex* pindexNew, const CBlockIndex* pindexFork, bool fInitialDownload) override;
+    void BlockDisconnected(const std::shared_ptr<const CBlock>& block, const CBlockIndex* pindex) override;
+
+private:
+    struct Entry {
+        std::string key;
+        std::shared_ptr<const std::string> reply;
+        Scope scope;
+        uint256 tip;
+    };
+
+    const size_t m_max_bytes;
+
+    mutable Mutex m_mutex;
+    //! Most recently used first
+    std::list<Entry> m_entries GUARDED_BY(m_mutex);
+    std::unordered_map<std::string, std::list<Entry>::iterator> m_index GUARDED_BY(m_mutex);
+    size_t m_bytes GUARDED_BY(m_mutex){0};
+    uint64_t m_generation GUARDED_BY(m_mutex){0};
+    uint64_t m_hits GUARDED_BY(m_mutex){0};
+    uint64_t m_misses GUARDED_BY(m_mutex){0};
+
+    static size_t Usage(const Entry& entry) { return ENTRY_OVERHEAD + entry.key.size() + entry.reply->size(); }
+    void Erase(std::list<Entry>::iterator it) EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+/** The response cache, if enabled (-rpccachesize) */
+extern std::unique_ptr<ResponseCache> g_response_cache;
+
+#endif // chymera_RPC_RESPONSECACHE_H
@@ -5,19 +5,31 @@
 
 #include <rpc/server.h>
 
+#include <httpserver.h>
+#include <rpc/blockchain.h>
+#include <rpc/jsonwriter.h>
+#include <rpc/responsecache.h>
 #include <rpc/util.h>
 #include <shutdown.h>
 #include <sync.h>
 #include <util/strencodings.h>
 #include <util/system.h>
+#include <util/threadnames.h>
+#include <validation.h>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/signals2/signal.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
 #include <memory> // for unique_ptr
 #include <mutex>
+#include <optional>
+#include <thread>
 #include <unordered_map>
 
 static Mutex g_rpc_warmup_mutex;
@@ -45,6 +57,21 @@ struct RPCServerInfo
 
 static RPCServerInfo g_rpc_server_info;
 
+/** Threads that execute elements of batch requests, alongside the thread that received the batch. */
+struct RPCBatchThreads
+{
+    Mutex mutex;
+    std::condition_variable cond GUARDED_BY(mutex);
+    //! Each task executes elements of one batch until none are left.
+    std::deque<std::function<void()>> queue GUARDED_BY(mutex);
+    bool running GUARDED_BY(mutex){false};
+    std::vector<std::thread> threads;
+    //! Maximum number of elements of one batch to execute at the same time.
+    int parallelism{1};
+};
+
+static RPCBatchThreads g_rpc_batch_threads;
+
 struct RPCCommandExecution
 {
     std::list<RPCCommandExecutionInfo>::iterator it;
@@ -220,6 +247,20 @@ static RPCHelpMan getrpcinfo()
                             }},
                         }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
+                        {RPCResult::Type::OBJ, "http_work_queue", /* optional */ true, "The queue of HTTP requests waiting for a worker, if the HTTP server is running",
+                        {
+                            {RPCResult::Type::NUM, "queued", "Number of queued requests"},
+                            {RPCResult::Type::NUM, "queued_bytes", "Memory counted for the queued requests"},
+                            {RPCResult::Type::NUM, "max_bytes", "Memory beyond which requests are rejected (-rpcworkqueuemem)"},
+                            {RPCResult::Type::NUM, "clients", "Number of clients with queued requests"},
+                            {RPCResult::Type::NUM, "active_workers", "Workers handling a request"},
+                            {RPCResult::Type::NUM, "parked_workers", "Workers waiting in a request, like waitfornewblock, whose place another worker took"},
+                            {RPCResult::Type::BOOL, "paused", "Whether new connections are not accepted until the queue drains"},
+                            {RPCResult::Type::NUM, "dispatched", "Requests passed to a worker since startup"},
+                            {RPCResult::Type::NUM, "rejected", "Requests rejected because the queue was full since startup"},
+                            {RPCResult::Type::NUM, "total_wait", "Time dispatched requests spent in the queue, in microseconds"},
+                            {RPCResult::Type::NUM, "max_wait", "Longest time a request spent in the queue, in microseconds"},
+                        }},
                     }
                 },
                 RPCExamples{
@@ -243,6 +284,22 @@ static RPCHelpMan getrpcinfo()
     UniValue log_path(UniValue::VSTR, path);
     result.pushKV("logpath", log_path);
 
+    if (const std::optional<HTTPWorkQueueStats> stats = GetHTTPWorkQueueStats()) {
+        UniValue queue(UniValue::VOBJ);
+        queue.pushKV("queued", (uint64_t)stats->queued);
+        queue.pushKV("queued_bytes", (uint64_t)stats->queued_bytes);
+        queue.pushKV("max_bytes", (uint64_t)stats->max_bytes);
+        queue.pushKV("clients", (uint64_t)stats->clients);
+        queue.pushKV("active_workers", stats->active);
+        queue.pushKV("parked_workers", stats->parked);
+        queue.pushKV("paused", stats->paused);
+        queue.pushKV("dispatched", stats->dispatched);
+        queue.pushKV("rejected", stats->rejected);
+        queue.pushKV("total_wait", count_microseconds(stats->total_wait));
+        queue.pushKV("max_wait", count_microseconds(stats->max_wait));
+        result.pushKV("http_work_queue", queue);
+    }
+
     return result;
 }
     };
@@ -287,10 +344,59 @@ bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
     return false;
 }
 
+static void RPCBatchThread(int thread_num)
+{
+    util::ThreadRename(strprintf("rpcbatch.%i", thread_num));
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(g_rpc_batch_threads.mutex, lock);
+            while (g_rpc_batch_threads.running && g_rpc_batch_threads.queue.empty()) {
+                g_rpc_batch_threads.cond.wait(lock);
+            }
+            // Tasks left in the queue have nothing left to do: the threads
+            // that received their batches execute all elements not yet taken.
+            if (!g_rpc_batch_threads.running) break;
+            task = std::move(g_rpc_batch_threads.queue.front());
+            g_rpc_batch_threads.queue.pop_front();
+        }
+        task();
+    }
+}
+
+void StartRPCBatchThreads(int threads, int parallelism)
+{
+    LOCK(g_rpc_batch_threads.mutex);
+    assert(!g_rpc_batch_threads.running && g_rpc_batch_threads.threads.empty());
+    if (threads <= 0 || parallelism <= 1) return;
+    LogPrint(BCLog::RPC, "Starting %d RPC batch threads, executing up to %d elements of a batch at the same time\n", threads, parallelism);
+    g_rpc_batch_threads.running = true;
+    g_rpc_batch_threads.parallelism = parallelism;
+    for (int i = 0; i < threads; ++i) {
+        g_rpc_batch_threads.threads.emplace_back(RPCBatchThread, i);
+    }
+}
+
+void StopRPCBatchThreads()
+{
+    {
+        LOCK(g_rpc_batch_threads.mutex);
+        g_rpc_batch_threads.running = false;
+        g_rpc_batch_threads.queue.clear();
+        g_rpc_batch_threads.cond.notify_all();
+    }
+    for (std::thread& thread : g_rpc_batch_threads.threads) {
+        thread.join();
+    }
+    g_rpc_batch_threads.threads.clear();
+}
+
 void StartRPC()
 {
     LogPrint(BCLog::RPC, "Starting RPC\n");
     g_rpc_running = true;
+    StartRPCBatchThreads(std::max<int64_t>(gArgs.GetArg("-rpcbatchthreads", DEFAULT_RPC_BATCH_THREADS), 0),
+                         std::max<int64_t>(gArgs.GetArg("-rpcbatchparallelism", DEFAULT_RPC_BATCH_PARALLELISM), 1));
     g_rpcSignals.Started();
 }
 
@@ -313,6 +419,7 @@ void StopRPC()
     std::call_once(g_rpc_stop_flag, []() {
         LogPrint(BCLog::RPC, "Stopping RPC\n");
         WITH_LOCK(g_deadline_timers_mutex, deadlineTimers.clear());
+        StopRPCBatchThreads();
         DeleteAuthCookie();
         g_rpcSignals.Stopped();
     });
@@ -379,13 +486,69 @@ static UniValue JSONRPCExecOne(JSONRPCRequest jreq, const UniValue& req)
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
+/** Progress of a batch whose elements are executed by several threads. */
+struct RPCBatch
+{
+    explicit RPCBatch(size_t size) : size(size), results(size) {}
+
+    const size_t size;
+    //! Index of the next element to execute.
+    std::atomic<size_t> next{0};
+    std::vector<UniValue> results;
+    Mutex mutex;
+    std::condition_variable cond GUARDED_BY(mutex);
+    size_t done GUARDED_BY(mutex){0};
+};
+
+UniValue JSONRPCExecBatchReplies(const JSONRPCRequest& jreq, const UniValue& vReq)
 {
+    auto batch = std::make_shared<RPCBatch>(vReq.size());
+    // Execute elements until none are left. jreq and vReq are only used for
+    // elements taken, which the receiving thread waits for below.
+    const auto execute = [batch, &jreq, &vReq] {
+        size_t executed = 0;
+        for (size_t i = batch->next++; i < batch->size; i = batch->next++) {
+            batch->results[i] = JSONRPCExecOne(jreq, vReq[i]);
+            ++executed;
+        }
+        if (executed == 0) return;
+        LOCK(batch->mutex);
+        batch->done += executed;
+        batch->cond.notify_all();
+    };
+
+    {
+        LOCK(g_rpc_batch_threads.mutex);
+        if (g_rpc_batch_threads.running) {
+            // Counting this thread. The per-batch limit keeps a single large
+            // batch from taking all the threads.
+            const size_t parallelism = std::min<size_t>({batch->size, size_t(g_rpc_batch_threads.parallelism), g_rpc_batch_threads.threads.size() + 1});
+            for (size_t i = 1; i < parallelism; ++i) {
+                g_rpc_batch_threads.queue.emplace_back(execute);
+            }
+            g_rpc_batch_threads.cond.notify_all();
+        }
+    }
+    // Execute elements here too, so that the batch completes even when all
+    // batch threads are busy with other batches.
+    execute();
+    {
+        WAIT_LOCK(batch->mutex, lock);
+        while (batch->done < batch->size) {
+            batch->cond.wait(lock);
+        }
+    }
+
     UniValue ret(UniValue::VARR);
-    for (unsigned int reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(jreq, vReq[reqIdx]));
+    for (const UniValue& result : batch->results) {
+        ret.push_back(result);
+    }
+    return ret;
+}
 
-    return ret.write() + "\n";
+std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq)
+{
+    return JSONRPCExecBatchReplies(jreq, vReq).write() + "\n";
 }
 
 /**
@@ -448,6 +611,103 @@ static bool ExecuteCommands(const std::vector<const CRPCCommand*>& commands, con
     return false;
 }
 
+/** Passes a streamed result on, keeping a copy of its text for the response cache. */
+class CopyingResultStream final : public JSONRPCResultStream
+{
+public:
+    CopyingResultStream(JSONRPCResultStream& stream, size_t max_size) : m_stream(stream), m_max_size(max_size) {}
+
+    JSONWriter& Begin() override
+    {
+        JSONWriter& writer = m_stream.Begin();
+        m_writer.emplace([this, &writer](Span<const char> chunk) {
+            if (m_copy && m_copy->size() + chunk.size() <= m_max_size) {
+                m_copy->append(chunk.begin(), chunk.end());
+            } else {
+                m_copy.reset();
+            }
+            writer.RawValuePart(chunk, m_first);
+            m_first = false;
+        });
+        return *m_writer;
+    }
+    bool Started() const override
+    {
+        return m_stream.Started();
+    }
+    /** Pass the rest of the result on, and return its text unless it was too large to copy. */
+    std::optional<std::string> Finish()
+    {
+        m_writer->Flush();
+        return std::move(m_copy);
+    }
+
+private:
+    JSONRPCResultStream& m_stream;
+    const size_t m_max_size;
+    std::optional<JSONWriter> m_writer;
+    std::optional<std::string> m_copy{std::string{}};
+    bool m_first{true};
+};
+
+/**
+ * The key under which the response cache may keep the result of a request:
+ * those about blocks, which only change with the chain, or with its tip for
+ * the number of confirmations and for blocks given by height.
+ */
+static std::optional<ResponseCache::Key> GetResponseCacheKey(const JSONRPCRequest& request)
+{
+    if (!g_response_cache || request.mode != JSONRPCRequest::EXECUTE) return std::nullopt;
+
+    bool by_tip;
+    if (request.strMethod == "getblockstats") {
+        // The block at a height changes as soon as it is disconnected, before
+        // the cache hears of it, so only a block given by hash is cached for
+        // the whole chain.
+        const UniValue& hash_or_height = request.params.isObject() ? find_value(request.params, "hash_or_height") : request.params[0];
+        by_tip = !hash_or_height.isStr();
+    } else if (request.strMethod == "getblockstatsrange" || request.strMethod == "getblock" || request.strMethod == "getblockheader") {
+        by_tip = true;
+    } else {
+        return std::nullopt;
+    }
+    if (!by_tip) {
+        return g_response_cache->MakeKey(request.strMethod, request.params.write(), ResponseCache::Scope::CHAIN);
+    }
+    const ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    const uint256 tip = WITH_LOCK(cs_main, return chainman.ActiveChain().Tip()->GetBlockHash());
+    return g_response_cache->MakeKey(request.strMethod, request.params.write(), ResponseCache::Scope::TIP, tip);
+}
+
+/** Like ExecuteCommands(), with the result from or to the response cache under key. */
+static bool ExecuteCommandsCached(const std::vector<const CRPCCommand*>& commands, const JSONRPCRequest& request, const ResponseCache::Key& key, UniValue& result)
+{
+    if (const std::shared_ptr<const std::string> reply = g_response_cache->Get(key)) {
+        if (request.result_stream) {
+            request.result_stream->Begin().RawValue(*reply);
+            result = NullUniValue;
+            return true;
+        }
+        if (result.read(*reply)) return true;
+    }
+
+    if (request.result_stream) {
+        JSONRPCRequest copying_request{request};
+        CopyingResultStream stream{*request.result_stream, g_response_cache->MaxReplySize()};
+        copying_request.result_stream = &stream;
+        if (!ExecuteCommands(commands, copying_request, result)) return false;
+        if (stream.Started()) {
+            std::optional<std::string> text = stream.Finish();
+            if (text) g_response_cache->Put(key, std::move(*text));
+            return true;
+        }
+    } else if (!ExecuteCommands(commands, request, result)) {
+        return false;
+    }
+    g_response_cache->Put(key, result.write());
+    return true;
+}
+
 UniValue CRPCTable::execute(const JSONRPCRequest &request) const
 {
     // Return immediately if in warmup
@@ -461,7 +721,8 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     auto it = mapCommands.find(request.strMethod);
     if (it != mapCommands.end()) {
         UniValue result;
-        if (ExecuteCommands(it->second, request, result)) {
+        const std::optional<ResponseCache::Key> cache_key = GetResponseCacheKey(request);
+        if (cache_key ? ExecuteCommandsCached(it->second, request, *cache_key, result) : ExecuteCommands(it->second, request, result)) {
             return result;
         }
     }
@@ -493,6 +754,16 @@ std::vector<std::string> CRPCTable::listCommands() const
     return commandList;
 }
 
+const RPCResults* CRPCTable::getResults(const std::string& name) const
+{
+    auto it = mapCommands.find(name);
+    if (it == mapCommands.end()) return nullptr;
+    for (const CRPCCommand* command : it->second) {
+        if (command->results) return command->results.get();
+    }
+    return nullptr;
+}
+
 UniValue CRPCTable::dumpArgMap(const JSONRPCRequest& args_request) const
 {
     JSONRPCRequest request = args_request;
@@ -12,12 +12,15 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <stdint.h>
 #include <string>
 
 #include <univalue.h>
 
 static const unsigned int DEFAULT_RPC_SERIALIZE_VERSION = 1;
+static const int DEFAULT_RPC_BATCH_THREADS = 4;
+static const int DEFAULT_RPC_BATCH_PARALLELISM = 1;
 
 class CRPCCommand;
 
@@ -96,9 +99,9 @@ public:
     using Actor = std::function<bool(const JSONRPCRequest& request, UniValue& result, bool last_handler)>;
 
     //! Constructor taking Actor callback supporting multiple handlers.
-    CRPCCommand(std::string category, std::string name, Actor actor, std::vector<std::string> args, intptr_t unique_id)
+    CRPCCommand(std::string category, std::string name, Actor actor, std::vector<std::string> args, intptr_t unique_id, std::shared_ptr<const RPCResults> results = nullptr)
         : category(std::move(category)), name(std::move(name)), actor(std::move(actor)), argNames(std::move(args)),
-          unique_id(unique_id)
+          unique_id(unique_id), results(std::move(results))
     {
     }
 
@@ -109,7 +112,8 @@ public:
               fn().m_name,
               [fn](const JSONRPCRequest& request, UniValue& result, bool) { result = fn().HandleRequest(request); return true; },
               fn().GetArgNames(),
-              intptr_t(fn))
+              intptr_t(fn),
+              std::make_shared<const RPCResults>(fn().GetResults()))
     {
     }
 
@@ -118,6 +122,8 @@ public:
     Actor actor;
     std::vector<std::string> argNames;
     intptr_t unique_id;
+    //! Description of the result, if known, for encodings that depend on it
+    std::shared_ptr<const RPCResults> results;
 };
 
 /**
@@ -145,6 +151,12 @@ public:
     */
     std::vector<std::string> listCommands() const;
 
+    /**
+     * Return the description of the result of a method, or nullptr if it is
+     * not known.
+     */
+    const RPCResults* getResults(const std::string& name) const;
+
     /**
      * Return all named arguments that need to be converted by the client from string to another JSON type
      */
@@ -173,7 +185,19 @@ extern CRPCTable tableRPC;
 void StartRPC();
 void InterruptRPC();
 void StopRPC();
+/**
+ * Start the threads that execute elements of batch requests in parallel,
+ * up to parallelism elements of one batch at a time. Called by StartRPC.
+ */
+void StartRPCBatchThreads(int threads, int parallelism);
+void StopRPCBatchThreads();
+/**
+ * Execute a batch request. The elements may be executed in parallel, as
+ * JSON-RPC 2.0 allows, but the replies are in the order of the requests.
+ */
 std::string JSONRPCExecBatch(const JSONRPCRequest& jreq, const UniValue& vReq);
+/** Execute a batch request like JSONRPCExecBatch, returning the array of replies. */
+UniValue JSONRPCExecBatchReplies(const JSONRPCRequest& jreq, const UniValue& vReq);
 
 // Retrieves any serialization flags requested in command line argument
 int RPCSerializationFlags();
@@ -356,6 +356,7 @@ public:
     /** If the supplied number of args is neither too small nor too high */
     bool IsValidNumArgs(size_t num_args) const;
     std::vector<std::string> GetArgNames() const;
+    const RPCResults& GetResults() const { return m_results; }
 
     const std::string m_name;
 
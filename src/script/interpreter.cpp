@@ -12,6 +12,9 @@
 #include <script/script.h>
 #include <uint256.h>
 
+#include <algorithm>
+#include <array>
+
 typedef std::vector<unsigned char> valtype;
 
 namespace {
@@ -225,7 +228,7 @@ bool static CheckPubKeyEncoding(const valtype &vchPubKey, unsigned int flags, co
     return true;
 }
 
-bool CheckMinimalPush(const valtype& data, opcodetype opcode) {
+bool CheckMinimalPush(Span<const unsigned char> data, opcodetype opcode) {
     // Excludes OP_1NEGATE, OP_1-16 since they are by definition minimal
     assert(0 <= opcode && opcode <= OP_PUSHDATA4);
     if (data.size() == 0) {
@@ -2075,6 +2078,208 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
     return set_success(serror);
 }
 
+namespace {
+
+//! Most pushes in the scriptSig of a template: the multisig dummy, up to 16 signatures, and the redeemScript.
+constexpr size_t MAX_TEMPLATE_PUSHES = 18;
+
+using TemplatePushes = std::array<Span<const unsigned char>, MAX_TEMPLATE_PUSHES>;
+
+/**
+ * Get the data pushed by a template scriptSig, as spans of the script. Fails if
+ * EvalScript could reject the script, or if it does anything but push data.
+ */
+bool GetTemplatePushes(const CScript& script, unsigned int flags, TemplatePushes& pushes, size_t& count)
+{
+    if (script.size() > MAX_SCRIPT_SIZE) return false;
+    count = 0;
+    CScript::const_iterator pc = script.begin();
+    while (pc < script.end()) {
+        const CScript::const_iterator op_begin = pc;
+        opcodetype opcode;
+        if (!script.GetOp(pc, opcode) || opcode > OP_PUSHDATA4 || count == pushes.size()) return false;
+        // The data follows the opcode and, for OP_PUSHDATAn, its size.
+        const size_t header = opcode < OP_PUSHDATA1 ? 1 : opcode == OP_PUSHDATA1 ? 2 : opcode == OP_PUSHDATA2 ? 3 : 5;
+        const Span<const unsigned char> data{&*op_begin + header, size_t(pc - op_begin) - header};
+        if (data.size() > MAX_SCRIPT_ELEMENT_SIZE) return false;
+        if ((flags & SCRIPT_VERIFY_MINIMALDATA) && !CheckMinimalPush(data, opcode)) return false;
+        pushes[count++] = data;
+    }
+    return true;
+}
+
+bool SpanEquals(Span<const unsigned char> a, Span<const unsigned char> b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+bool MatchesHash160(Span<const unsigned char> data, Span<const unsigned char> hash)
+{
+    uint160 data_hash;
+    CHash160().Write(data).Finalize(data_hash);
+    return SpanEquals(data_hash, hash);
+}
+
+bool IsP2PKH(const CScript& script)
+{
+    return script.size() == 25 && script[0] == OP_DUP && script[1] == OP_HASH160 && script[2] == 20 && script[23] == OP_EQUALVERIFY && script[24] == OP_CHECKSIG;
+}
+
+bool IsP2WPKH(Span<const unsigned char> script)
+{
+    return script.size() == 2 + WITNESS_V0_KEYHASH_SIZE && script[0] == OP_0 && script[1] == WITNESS_V0_KEYHASH_SIZE;
+}
+
+/**
+ * An OP_CHECKSIG that ends a template, as EvalChecksigPreTapscript does it,
+ * followed by the check that the script left true on the stack.
+ */
+TemplateResult CheckTemplateSignature(const valtype& sig, const valtype& pubkey, const CScript& script_code, SigVersion sigversion, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    if (!CheckSignatureEncoding(sig, flags, serror) || !CheckPubKeyEncoding(pubkey, flags, sigversion, serror)) {
+        // serror is set
+        return TemplateResult::INVALID;
+    }
+    if (checker.CheckECDSASignature(sig, pubkey, script_code, sigversion)) {
+        set_success(serror);
+        return TemplateResult::VALID;
+    }
+    set_error(serror, (flags & SCRIPT_VERIFY_NULLFAIL) && !sig.empty() ? SCRIPT_ERR_SIG_NULLFAIL : SCRIPT_ERR_EVAL_FALSE);
+    return TemplateResult::INVALID;
+}
+
+/** scriptSig: <sig> <pubkey>, scriptPubKey: OP_DUP OP_HASH160 <hash> OP_EQUALVERIFY OP_CHECKSIG */
+TemplateResult VerifyP2PKH(const TemplatePushes& pushes, size_t count, const CScript& scriptPubKey, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    if (count != 2) return TemplateResult::UNHANDLED;
+    const Span<const unsigned char> hash{scriptPubKey.data() + 3, 20};
+    if (!MatchesHash160(pushes[1], hash)) return TemplateResult::UNHANDLED;
+    // The whole scriptPubKey is the scriptCode. FindAndDelete would only
+    // change it if the signature were the same push as the hash.
+    if (SpanEquals(pushes[0], hash)) return TemplateResult::UNHANDLED;
+
+    const valtype sig(pushes[0].begin(), pushes[0].end());
+    const valtype pubkey(pushes[1].begin(), pushes[1].end());
+    return CheckTemplateSignature(sig, pubkey, scriptPubKey, SigVersion::BASE, flags, checker, serror);
+}
+
+/** witness: <sig> <pubkey>, program: <hash> */
+TemplateResult VerifyP2WPKH(const CScriptWitness& witness, Span<const unsigned char> program, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    if (witness.stack.size() != 2) return TemplateResult::UNHANDLED;
+    const valtype& sig = witness.stack[0];
+    const valtype& pubkey = witness.stack[1];
+    if (sig.size() > MAX_SCRIPT_ELEMENT_SIZE || pubkey.size() > MAX_SCRIPT_ELEMENT_SIZE) return TemplateResult::UNHANDLED;
+    if (!MatchesHash160(pubkey, program)) return TemplateResult::UNHANDLED;
+
+    // The implied P2PKH script, as in VerifyWitnessProgram.
+    CScript script_code;
+    script_code << OP_DUP << OP_HASH160;
+    script_code.push_back(WITNESS_V0_KEYHASH_SIZE);
+    script_code.insert(script_code.end(), program.begin(), program.end());
+    script_code << OP_EQUALVERIFY << OP_CHECKSIG;
+    return CheckTemplateSignature(sig, pubkey, script_code, SigVersion::WITNESS_V0, flags, checker, serror);
+}
+
+/** scriptSig: OP_0 <sig>... <redeemScript>, redeemScript: OP_m <pubkey>... OP_n OP_CHECKMULTISIG */
+TemplateResult VerifyP2SHMultisig(const TemplatePushes& pushes, size_t count, Span<const unsigned char> redeem, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    // Only keys of valid sizes, pushed directly, and counts from OP_1 to OP_16.
+    std::array<Span<const unsigned char>, 16> keys;
+    size_t n_keys = 0;
+    size_t pos = 1;
+    while (pos < redeem.size() && (redeem[pos] == CPubKey::COMPRESSED_SIZE || redeem[pos] == CPubKey::SIZE)) {
+        const size_t size = redeem[pos];
+        if (n_keys == keys.size() || pos + 1 + size > redeem.size()) return TemplateResult::UNHANDLED;
+        keys[n_keys++] = redeem.subspan(pos + 1, size);
+        pos += 1 + size;
+    }
+    if (redeem.size() < 3 || pos + 2 != redeem.size() || redeem.back() != OP_CHECKMULTISIG) return TemplateResult::UNHANDLED;
+    const opcodetype op_m = opcodetype(redeem[0]);
+    const opcodetype op_n = opcodetype(redeem[pos]);
+    if (op_m < OP_1 || op_m > OP_16 || op_n < OP_1 || op_n > OP_16) return TemplateResult::UNHANDLED;
+    const size_t n_sigs = CScript::DecodeOP_N(op_m);
+    if (size_t(CScript::DecodeOP_N(op_n)) != n_keys || n_sigs > n_keys) return TemplateResult::UNHANDLED;
+
+    // The dummy, the signatures and the redeemScript, so that nothing is left
+    // on the stack but the result. The dummy must be empty for NULLDUMMY.
+    if (count != n_sigs + 2 || !pushes[0].empty()) return TemplateResult::UNHANDLED;
+    const Span<const Span<const unsigned char>> sigs{pushes.data() + 1, n_sigs};
+    // The redeemScript is the scriptCode. FindAndDelete would only change it
+    // if a signature were the same push as a key.
+    for (const auto& sig : sigs) {
+        for (size_t i = 0; i < n_keys; ++i) {
+            if (SpanEquals(sig, keys[i])) return TemplateResult::UNHANDLED;
+        }
+    }
+    const CScript script_code(redeem.begin(), redeem.end());
+
+    // As OP_CHECKMULTISIG, matching signatures to keys from the last ones.
+    valtype sig, pubkey;
+    size_t sigs_left = n_sigs;
+    size_t keys_left = n_keys;
+    bool success = true;
+    while (success && sigs_left > 0) {
+        sig.assign(sigs[sigs_left - 1].begin(), sigs[sigs_left - 1].end());
+        pubkey.assign(keys[keys_left - 1].begin(), keys[keys_left - 1].end());
+        if (!CheckSignatureEncoding(sig, flags, serror) || !CheckPubKeyEncoding(pubkey, flags, SigVersion::BASE, serror)) {
+            // serror is set
+            return TemplateResult::INVALID;
+        }
+        if (checker.CheckECDSASignature(sig, pubkey, script_code, SigVersion::BASE)) {
+            --sigs_left;
+        }
+        --keys_left;
+        if (sigs_left > keys_left) success = false;
+    }
+    if (success) {
+        set_success(serror);
+        return TemplateResult::VALID;
+    }
+    const bool any_sig = std::any_of(sigs.begin(), sigs.end(), [](const auto& s) { return !s.empty(); });
+    set_error(serror, (flags & SCRIPT_VERIFY_NULLFAIL) && any_sig ? SCRIPT_ERR_SIG_NULLFAIL : SCRIPT_ERR_EVAL_FALSE);
+    return TemplateResult::INVALID;
+}
+
+} // namespace
+
+TemplateResult VerifyTemplateScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    const bool has_witness = witness != nullptr && !witness->IsNull();
+    // VerifyScript fails inputs of non-witness scripts that have a witness, after everything else.
+    const bool witness_unexpected = (flags & SCRIPT_VERIFY_WITNESS) && has_witness;
+
+    TemplatePushes pushes;
+    size_t count;
+
+    if (IsP2PKH(scriptPubKey)) {
+        if (witness_unexpected || !GetTemplatePushes(scriptSig, flags, pushes, count)) return TemplateResult::UNHANDLED;
+        return VerifyP2PKH(pushes, count, scriptPubKey, flags, checker, serror);
+    }
+
+    if (IsP2WPKH(scriptPubKey)) {
+        if (!(flags & SCRIPT_VERIFY_WITNESS) || !scriptSig.empty() || !has_witness) return TemplateResult::UNHANDLED;
+        return VerifyP2WPKH(*witness, Span<const unsigned char>{scriptPubKey.data() + 2, WITNESS_V0_KEYHASH_SIZE}, flags, checker, serror);
+    }
+
+    if (scriptPubKey.IsPayToScriptHash()) {
+        if (!(flags & SCRIPT_VERIFY_P2SH) || !GetTemplatePushes(scriptSig, flags, pushes, count) || count == 0) return TemplateResult::UNHANDLED;
+        const Span<const unsigned char> redeem = pushes[count - 1];
+        if (!MatchesHash160(redeem, Span<const unsigned char>{scriptPubKey.data() + 2, 20})) return TemplateResult::UNHANDLED;
+        if (IsP2WPKH(redeem)) {
+            // The scriptSig must be exactly a push of the redeemScript.
+            if (!(flags & SCRIPT_VERIFY_WITNESS) || scriptSig.size() != 1 + redeem.size() || scriptSig[0] != redeem.size() || !has_witness) {
+                return TemplateResult::UNHANDLED;
+            }
+            return VerifyP2WPKH(*witness, redeem.subspan(2), flags, checker, serror);
+        }
+        if (witness_unexpected) return TemplateResult::UNHANDLED;
+        return VerifyP2SHMultisig(pushes, count, redeem, flags, checker, serror);
+    }
+
+    return TemplateResult::UNHANDLED;
+}
+
 size_t static WitnessSigOps(int witversion, const std::vector<unsigned char>& witprogram, const CScriptWitness& witness)
 {
     if (witversion == 0) {
@@ -318,9 +318,32 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, unsigned int flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* error = nullptr);
 bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror = nullptr);
 
+/** Result of VerifyTemplateScript. */
+enum class TemplateResult {
+    //! Not a template, or a case left to VerifyScript: call it to get the result.
+    UNHANDLED,
+    //! VerifyScript would succeed.
+    VALID,
+    //! VerifyScript would fail, with the error that was set.
+    INVALID,
+};
+
+/**
+ * Verify the input types that make up most of the chain without running the
+ * script interpreter: P2PKH, P2WPKH (native and nested in P2SH) and P2SH
+ * multisig. The checks are those VerifyScript would make, in the same order,
+ * made directly on the scripts and witness instead of on a stack of copies.
+ *
+ * When it returns VALID or INVALID, VerifyScript would give the same result
+ * and error, and would have asked the checker about the same signatures. It
+ * returns UNHANDLED for anything else, including inputs that only look like a
+ * template, which VerifyScript has to decide.
+ */
+TemplateResult VerifyTemplateScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags, const BaseSignatureChecker& checker, ScriptError* serror = nullptr);
+
 size_t CountWitnessSigOps(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, unsigned int flags);
 
-bool CheckMinimalPush(const std::vector<unsigned char>& data, opcodetype opcode);
+bool CheckMinimalPush(Span<const unsigned char> data, opcodetype opcode);
 
 int FindAndDelete(CScript& script, const CScript& b);
 
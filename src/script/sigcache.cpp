@@ -5,50 +5,169 @@
 
 #include <script/sigcache.h>
 
+#include <clientversion.h>
+#include <crypto/common.h>
+#include <fs.h>
 #include <pubkey.h>
 #include <random.h>
+#include <streams.h>
 #include <uint256.h>
 #include <util/system.h>
+#include <util/time.h>
 
 #include <cuckoocache.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <mutex>
-#include <shared_mutex>
 #include <vector>
 
 namespace {
+/**
+ * A cache entry, SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature
+ * hash || public key || signature), stored as four relaxed atomic words.
+ *
+ * Lookups read entries without holding any lock while a writer of the same
+ * shard may be moving them around, so every word is an atomic. A torn read is
+ * possible and is detected by the shard's sequence counter (see
+ * CSignatureCache::Get).
+ */
+class SignatureCacheEntry
+{
+    std::array<std::atomic<uint64_t>, 4> m_words;
+
+public:
+    SignatureCacheEntry()
+    {
+        for (auto& word : m_words) word.store(0, std::memory_order_relaxed);
+    }
+
+    explicit SignatureCacheEntry(const uint256& hash)
+    {
+        for (int i = 0; i < 4; ++i) m_words[i].store(hash.GetUint64(i), std::memory_order_relaxed);
+    }
+
+    SignatureCacheEntry(const SignatureCacheEntry& other) { *this = other; }
+
+    SignatureCacheEntry& operator=(const SignatureCacheEntry& other)
+    {
+        for (int i = 0; i < 4; ++i) m_words[i].store(other.m_words[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool operator==(const SignatureCacheEntry& other) const
+    {
+        for (int i = 0; i < 4; ++i) {
+            if (m_words[i].load(std::memory_order_relaxed) != other.m_words[i].load(std::memory_order_relaxed)) return false;
+        }
+        return true;
+    }
+
+    uint256 ToUint256() const
+    {
+        uint256 hash;
+        for (int i = 0; i < 4; ++i) WriteLE64(hash.begin() + 8 * i, m_words[i].load(std::memory_order_relaxed));
+        return hash;
+    }
+
+    /**
+     * 32-bit word i of the entry. On little-endian hosts this is the word
+     * SignatureCacheHasher reads from the uint256; elsewhere it differs, which
+     * is harmless since the words only need to be uniformly distributed.
+     */
+    uint32_t Word(int i) const
+    {
+        return m_words[i / 2].load(std::memory_order_relaxed) >> (32 * (i & 1));
+    }
+};
+
+/** Cuckoo hashes of a SignatureCacheEntry: its 32-bit words, like SignatureCacheHasher. */
+class SignatureCacheEntryHasher
+{
+public:
+    template <uint8_t hash_select>
+    uint32_t operator()(const SignatureCacheEntry& entry) const
+    {
+        static_assert(hash_select < 8, "SignatureCacheEntryHasher only has 8 hashes available.");
+        return entry.Word(hash_select);
+    }
+};
+
 /**
  * Valid signature cache, to avoid doing expensive ECDSA signature checking
  * twice for every transaction (once when accepted into memory pool, and
  * again when accepted into the block chain)
+ *
+ * The cache is split into SIGCACHE_SHARDS independent cuckoo caches, each
+ * with its own writer lock, so inserts into different shards do not wait for
+ * each other. Lookups take no lock at all: each shard has a sequence counter
+ * that is odd while an insert is in progress, and a lookup that overlapped an
+ * insert is retried (seqlock). Script check threads therefore never block on
+ * each other during block validation, where the cache is only read.
  */
 class CSignatureCache
 {
 private:
-     //! Entries are SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature hash || public key || signature):
+    //! Number of shards, a power of two.
+    static constexpr size_t SIGCACHE_SHARDS = 16;
+    //! Optimistic lookups attempted before falling back to the shard's writer lock.
+    static constexpr int MAX_OPTIMISTIC_READS = 8;
+
+    typedef CuckooCache::cache<SignatureCacheEntry, SignatureCacheEntryHasher> map_type;
+
+    struct alignas(64) Shard {
+        map_type setValid;
+        //! Serializes inserts into this shard.
+        std::mutex m_write_mutex;
+        //! Incremented before and after every insert into this shard.
+        std::atomic<uint64_t> m_sequence{0};
+    };
+
+    //! Entries are SHA256(nonce || 'E' or 'S' || 31 zero bytes || signature hash || public key || signature):
+    uint256 m_nonce;
     CSHA256 m_salted_hasher_ecdsa;
     CSHA256 m_salted_hasher_schnorr;
-    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
-    map_type setValid;
-    std::shared_mutex cs_sigcache;
+    std::array<Shard, SIGCACHE_SHARDS> m_shards;
+
+    /**
+     * The shard is chosen by the low bits of the first 32-bit word of the
+     * entry. The cuckoo cache maps that word onto a bucket by its high bits,
+     * so the buckets within a shard stay uniformly used.
+     */
+    Shard& ShardFor(const SignatureCacheEntry& entry)
+    {
+        return m_shards[entry.Word(0) & (SIGCACHE_SHARDS - 1)];
+    }
 
 public:
     CSignatureCache()
     {
-        uint256 nonce = GetRandHash();
+        SetNonce(GetRandHash());
+    }
+
+    /**
+     * Salt the entries with nonce. Entries computed with a previous nonce can
+     * no longer be found, so this should only be done while the cache is empty
+     * and not in use by other threads.
+     */
+    void SetNonce(const uint256& nonce)
+    {
+        m_nonce = nonce;
         // We want the nonce to be 64 bytes long to force the hasher to process
         // this chunk, which makes later hash computations more efficient. We
         // just write our 32-byte entropy, and then pad with 'E' for ECDSA and
         // 'S' for Schnorr (followed by 0 bytes).
         static constexpr unsigned char PADDING_ECDSA[32] = {'E'};
         static constexpr unsigned char PADDING_SCHNORR[32] = {'S'};
-        m_salted_hasher_ecdsa.Write(nonce.begin(), 32);
+        m_salted_hasher_ecdsa.Reset().Write(nonce.begin(), 32);
         m_salted_hasher_ecdsa.Write(PADDING_ECDSA, 32);
-        m_salted_hasher_schnorr.Write(nonce.begin(), 32);
+        m_salted_hasher_schnorr.Reset().Write(nonce.begin(), 32);
         m_salted_hasher_schnorr.Write(PADDING_SCHNORR, 32);
     }
 
+    const uint256& GetNonce() const { return m_nonce; }
+
     void
     ComputeEntryECDSA(uint256& entry, const uint256 &hash, const std::vector<unsigned char>& vchSig, const CPubKey& pubkey) const
     {
@@ -64,20 +183,54 @@ public:
     }
 
     bool
-    Get(const uint256& entry, const bool erase)
+    Get(const uint256& hash, const bool erase)
     {
-        std::shared_lock<std::shared_mutex> lock(cs_sigcache);
-        return setValid.contains(entry, erase);
+        const SignatureCacheEntry entry{hash};
+        Shard& shard = ShardFor(entry);
+        for (int attempt = 0; attempt < MAX_OPTIMISTIC_READS; ++attempt) {
+            const uint64_t sequence = shard.m_sequence.load(std::memory_order_acquire);
+            if (sequence & 1) continue;
+            // An erase flag set on a slot that an overlapping insert just
+            // refilled only costs that other entry its place in the cache.
+            const bool found = shard.setValid.contains(entry, erase);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (shard.m_sequence.load(std::memory_order_relaxed) == sequence) return found;
+        }
+        // Inserts into this shard kept overlapping; wait for the current one.
+        std::lock_guard<std::mutex> lock(shard.m_write_mutex);
+        return shard.setValid.contains(entry, erase);
     }
 
-    void Set(const uint256& entry)
+    void Set(const uint256& hash)
     {
-        std::unique_lock<std::shared_mutex> lock(cs_sigcache);
-        setValid.insert(entry);
+        const SignatureCacheEntry entry{hash};
+        Shard& shard = ShardFor(entry);
+        std::lock_guard<std::mutex> lock(shard.m_write_mutex);
+        const uint64_t sequence = shard.m_sequence.load(std::memory_order_relaxed);
+        shard.m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        shard.setValid.insert(entry);
+        shard.m_sequence.store(sequence + 2, std::memory_order_release);
     }
+
+    //! Call fn with every entry that has not been erased, shard by shard.
+    template <typename Fn>
+    void ForEachEntry(Fn&& fn)
+    {
+        for (Shard& shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.m_write_mutex);
+            shard.setValid.for_each_element([&](const SignatureCacheEntry& entry) { fn(entry.ToUint256()); });
+        }
+    }
+
+    //! Split n bytes evenly between the shards; returns the total number of elements.
     uint32_t setup_bytes(size_t n)
     {
-        return setValid.setup_bytes(n);
+        uint32_t elems = 0;
+        for (Shard& shard : m_shards) {
+            elems += shard.setValid.setup_bytes(n / SIGCACHE_SHARDS);
+        }
+        return elems;
     }
 };
 
@@ -102,6 +255,79 @@ void InitSignatureCache()
             (nElems*sizeof(uint256)) >>20, (nMaxCacheSize*2)>>20, nElems);
 }
 
+static const uint64_t SIGCACHE_DUMP_VERSION = 1;
+
+bool DumpSignatureCache()
+{
+    int64_t start = GetTimeMillis();
+
+    std::vector<uint256> entries;
+    signatureCache.ForEachEntry([&](const uint256& entry) { entries.push_back(entry); });
+
+    try {
+        FILE* filestr{fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat.new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << SIGCACHE_DUMP_VERSION;
+        file << int{CLIENT_VERSION};
+        file << signatureCache.GetNonce();
+        file << entries;
+
+        if (!FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(gArgs.GetDataDirNet() / "sigcache.dat.new", gArgs.GetDataDirNet() / "sigcache.dat")) {
+            throw std::runtime_error("Rename failed");
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump signature cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    LogPrintf("Dumped %u signature cache entries in %dms\n", entries.size(), GetTimeMillis() - start);
+    return true;
+}
+
+bool LoadSignatureCache()
+{
+    int64_t start = GetTimeMillis();
+    FILE* filestr{fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat", "rb")};
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open signature cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    try {
+        uint64_t version;
+        int client_version;
+        uint256 nonce;
+        file >> version;
+        file >> client_version;
+        // A different release may validate differently; only trust entries
+        // written by this one.
+        if (version != SIGCACHE_DUMP_VERSION || client_version != CLIENT_VERSION) {
+            LogPrintf("Ignoring signature cache file written by another version.\n");
+            return false;
+        }
+        file >> nonce;
+        std::vector<uint256> entries;
+        file >> entries;
+
+        signatureCache.SetNonce(nonce);
+        for (const uint256& entry : entries) {
+            signatureCache.Set(entry);
+        }
+        LogPrintf("Imported %u signature cache entries from disk in %dms\n", entries.size(), GetTimeMillis() - start);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize signature cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
 bool CachingTransactionSignatureChecker::VerifyECDSASignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -18,6 +18,8 @@
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 // Maximum sig cache size allowed
 static const int64_t MAX_MAX_SIG_CACHE_SIZE = 16384;
+/** Default for -persistsigcache */
+static const bool DEFAULT_PERSIST_SIGCACHE = true;
 
 class CPubKey;
 
@@ -35,4 +37,16 @@ public:
 
 void InitSignatureCache();
 
+/**
+ * Save the signature cache, together with the salt its entries were computed
+ * with, to sigcache.dat in the data directory.
+ */
+bool DumpSignatureCache();
+/**
+ * Replace the (empty) signature cache by the one saved in sigcache.dat, if it
+ * was written by this client version. To be called after InitSignatureCache()
+ * and before any signature is checked.
+ */
+bool LoadSignatureCache();
+
 #endif // chymera_SCRIPT_SIGCACHE_H
@@ -18,6 +18,7 @@
 #include <set>
 #include <string>
 #include <string.h>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -606,9 +607,35 @@ struct VectorFormatter
 template<typename Stream, typename C> void Serialize(Stream& os, const std::basic_string<C>& str);
 template<typename Stream, typename C> void Unserialize(Stream& is, std::basic_string<C>& str);
 
+/**
+ * Whether the serialization of a T is its memory, so that vectors of T can be
+ * serialized with a single write or read. That holds for fixed-size integers
+ * on little-endian hosts, and for types that declare SERIALIZE_AS_BYTES (like
+ * uint256) because their Serialize writes their memory as is.
+ */
+template <typename T, typename = void>
+struct IsBulkSerializable
+{
+#if defined(WORDS_BIGENDIAN)
+    static constexpr bool value = false;
+#else
+    static constexpr bool value = std::is_same_v<T, int8_t> || std::is_same_v<T, char> ||
+                                  std::is_same_v<T, int16_t> || std::is_same_v<T, uint16_t> ||
+                                  std::is_same_v<T, int32_t> || std::is_same_v<T, uint32_t> ||
+                                  std::is_same_v<T, int64_t> || std::is_same_v<T, uint64_t>;
+#endif
+};
+template <typename T>
+struct IsBulkSerializable<T, std::enable_if_t<T::SERIALIZE_AS_BYTES && std::is_trivially_copyable_v<T>>>
+{
+    static constexpr bool value = true;
+};
+
 /**
  * prevector
  * prevectors of unsigned char are a special case and are intended to be serialized as a single opaque blob.
+ * So are prevectors of bulk serializable types (see IsBulkSerializable), which is the same on the wire as
+ * serializing their elements one by one.
  */
 template<typename Stream, unsigned int N, typename T> void Serialize_impl(Stream& os, const prevector<N, T>& v, const unsigned char&);
 template<typename Stream, unsigned int N, typename T, typename V> void Serialize_impl(Stream& os, const prevector<N, T>& v, const V&);
@@ -620,6 +647,7 @@ template<typename Stream, unsigned int N, typename T> inline void Unserialize(St
 /**
  * vector
  * vectors of unsigned char are a special case and are intended to be serialized as a single opaque blob.
+ * So are vectors of bulk serializable types, as for prevector.
  */
 template<typename Stream, typename T, typename A> void Serialize_impl(Stream& os, const std::vector<T, A>& v, const unsigned char&);
 template<typename Stream, typename T, typename A> void Serialize_impl(Stream& os, const std::vector<T, A>& v, const bool&);
@@ -730,7 +758,11 @@ void Serialize_impl(Stream& os, const prevector<N, T>& v, const unsigned char&)
 template<typename Stream, unsigned int N, typename T, typename V>
 void Serialize_impl(Stream& os, const prevector<N, T>& v, const V&)
 {
-    Serialize(os, Using<VectorFormatter<DefaultFormatter>>(v));
+    if constexpr (IsBulkSerializable<T>::value) {
+        Serialize_impl(os, v, (unsigned char)0);
+    } else {
+        Serialize(os, Using<VectorFormatter<DefaultFormatter>>(v));
+    }
 }
 
 template<typename Stream, unsigned int N, typename T>
@@ -759,7 +791,11 @@ void Unserialize_impl(Stream& is, prevector<N, T>& v, const unsigned char&)
 template<typename Stream, unsigned int N, typename T, typename V>
 void Unserialize_impl(Stream& is, prevector<N, T>& v, const V&)
 {
-    Unserialize(is, Using<VectorFormatter<DefaultFormatter>>(v));
+    if constexpr (IsBulkSerializable<T>::value) {
+        Unserialize_impl(is, v, (unsigned char)0);
+    } else {
+        Unserialize(is, Using<VectorFormatter<DefaultFormatter>>(v));
+    }
 }
 
 template<typename Stream, unsigned int N, typename T>
@@ -796,7 +832,11 @@ void Serialize_impl(Stream& os, const std::vector<T, A>& v, const bool&)
 template<typename Stream, typename T, typename A, typename V>
 void Serialize_impl(Stream& os, const std::vector<T, A>& v, const V&)
 {
-    Serialize(os, Using<VectorFormatter<DefaultFormatter>>(v));
+    if constexpr (IsBulkSerializable<T>::value) {
+        Serialize_impl(os, v, (unsigned char)0);
+    } else {
+        Serialize(os, Using<VectorFormatter<DefaultFormatter>>(v));
+    }
 }
 
 template<typename Stream, typename T, typename A>
@@ -825,7 +865,11 @@ void Unserialize_impl(Stream& is, std::vector<T, A>& v, const unsigned char&)
 template<typename Stream, typename T, typename A, typename V>
 void Unserialize_impl(Stream& is, std::vector<T, A>& v, const V&)
 {
-    Unserialize(is, Using<VectorFormatter<DefaultFormatter>>(v));
+    if constexpr (IsBulkSerializable<T>::value) {
+        Unserialize_impl(is, v, (unsigned char)0);
+    } else {
+        Unserialize(is, Using<VectorFormatter<DefaultFormatter>>(v));
+    }
 }
 
 template<typename Stream, typename T, typename A>
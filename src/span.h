@@ -248,4 +248,9 @@ template <typename T> constexpr auto UCharSpanCast(Span<T> s) -> Span<typename s
 /** Like MakeSpan, but for (const) unsigned char member types only. Only works for (un)signed char containers. */
 template <typename V> constexpr auto MakeUCharSpan(V&& v) -> decltype(UCharSpanCast(MakeSpan(std::forward<V>(v)))) { return UCharSpanCast(MakeSpan(std::forward<V>(v))); }
 
+/** View the memory of a Span as (const) bytes. */
+template <typename T> Span<const std::byte> AsBytes(Span<T> s) noexcept { return {reinterpret_cast<const std::byte*>(s.data()), s.size() * sizeof(T)}; }
+/** Like MakeSpan, but as const bytes, for parsing serialized data in place. */
+template <typename V> Span<const std::byte> MakeByteSpan(V&& v) noexcept { return AsBytes(MakeSpan(std::forward<V>(v))); }
+
 #endif
@@ -9,6 +9,7 @@
 #include <serialize.h>
 #include <span.h>
 #include <support/allocators/zeroafterfree.h>
+#include <support/cleanse.h>
 
 #include <algorithm>
 #include <assert.h>
@@ -19,6 +20,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -196,6 +198,57 @@ public:
     }
 };
 
+/**
+ * Allocator of CDataStream buffers. Like zero_after_free_allocator, it cleanses
+ * memory before freeing it, unless constructed with cleanse = false for streams
+ * that hold nothing secret, like blocks and transactions, where cleansing costs
+ * a pass over the old buffer every time the stream grows.
+ *
+ * All instances are interchangeable, and the setting travels with the buffer
+ * when a stream is copied, moved or swapped.
+ */
+template <typename T>
+class DataStreamAllocator
+{
+    template <typename U>
+    friend class DataStreamAllocator;
+
+    bool m_cleanse{true};
+
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+    typedef std::true_type is_always_equal;
+
+    DataStreamAllocator() noexcept = default;
+    explicit DataStreamAllocator(bool cleanse) noexcept : m_cleanse(cleanse) {}
+    template <typename U>
+    DataStreamAllocator(const DataStreamAllocator<U>& other) noexcept : m_cleanse(other.m_cleanse) {}
+
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        if (p != nullptr && m_cleanse) memory_cleanse(p, sizeof(T) * n);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    bool Cleanses() const { return m_cleanse; }
+
+    template <typename U>
+    bool operator==(const DataStreamAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const DataStreamAllocator<U>&) const noexcept { return false; }
+};
+
+/** Tag for constructing a CDataStream whose buffer is not cleansed when freed. */
+struct non_secret_t {
+    explicit non_secret_t() = default;
+};
+inline constexpr non_secret_t non_secret{};
+
 /** Double ended buffer combining vector and stream-like interfaces.
  *
  * >> and << read and write unformatted data using the above serialization templates.
@@ -204,7 +257,7 @@ public:
 class CDataStream
 {
 protected:
-    using vector_type = SerializeData;
+    using vector_type = std::vector<SerializeData::value_type, DataStreamAllocator<SerializeData::value_type>>;
     vector_type vch;
     unsigned int nReadPos{0};
 
@@ -231,6 +284,17 @@ public:
           nType{nTypeIn},
           nVersion{nVersionIn} {}
 
+    /** Streams for data that need not be cleansed from memory; see DataStreamAllocator. */
+    explicit CDataStream(non_secret_t, int nTypeIn, int nVersionIn)
+        : vch(allocator_type{/*cleanse=*/false}),
+          nType{nTypeIn},
+          nVersion{nVersionIn} {}
+
+    explicit CDataStream(non_secret_t, Span<const uint8_t> sp, int nTypeIn, int nVersionIn)
+        : vch(sp.data(), sp.data() + sp.size(), allocator_type{/*cleanse=*/false}),
+          nType{nTypeIn},
+          nVersion{nVersionIn} {}
+
     template <typename... Args>
     CDataStream(int nTypeIn, int nVersionIn, Args&&... args)
         : nType{nTypeIn},
@@ -256,6 +320,9 @@ public:
     bool empty() const                               { return vch.size() == nReadPos; }
     void resize(size_type n, value_type c=0)         { vch.resize(n + nReadPos, c); }
     void reserve(size_type n)                        { vch.reserve(n + nReadPos); }
+    //! Reserve room to serialize args after the current contents, so that doing so does not reallocate.
+    template <typename... Args>
+    void ReserveFor(const Args&... args)             { reserve(size() + GetSerializeSizeMany(nVersion, args...)); }
     const_reference operator[](size_type pos) const  { return vch[pos + nReadPos]; }
     reference operator[](size_type pos)              { return vch[pos + nReadPos]; }
     void clear()                                     { vch.clear(); nReadPos = 0; }
@@ -263,6 +330,7 @@ public:
     void insert(iterator it, size_type n, const uint8_t x) { vch.insert(it, n, x); }
     value_type* data()                               { return vch.data() + nReadPos; }
     const value_type* data() const                   { return vch.data() + nReadPos; }
+    allocator_type get_allocator() const             { return vch.get_allocator(); }
 
     void insert(iterator it, std::vector<uint8_t>::const_iterator first, std::vector<uint8_t>::const_iterator last)
     {
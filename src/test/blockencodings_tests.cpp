@@ -300,6 +300,40 @@ BOOST_AUTO_TEST_CASE(EmptyBlockRoundTripTest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(ShortIDBatchTest)
+{
+    CTxMemPool pool;
+    TestMemPoolEntryHelper entry;
+    CBlock block(BuildBlockTestCase());
+
+    // Enough transactions for their short IDs to be computed in several batches.
+    CMutableTransaction tx(*block.vtx[1]);
+    for (int i = 0; i < 150; i++) {
+        tx.vin[0].prevout.hash = InsecureRand256();
+        block.vtx.push_back(MakeTransactionRef(tx));
+    }
+
+    LOCK2(cs_main, pool.cs);
+    for (size_t i = 2; i < block.vtx.size(); i++) {
+        pool.addUnchecked(entry.FromTx(block.vtx[i]));
+    }
+
+    CBlockHeaderAndShortTxIDs shortIDs(block, true);
+    TestHeaderAndShortIDs test_ids(shortIDs);
+    BOOST_REQUIRE_EQUAL(test_ids.shorttxids.size(), block.vtx.size() - 1);
+    for (size_t i = 1; i < block.vtx.size(); i++) {
+        BOOST_CHECK_EQUAL(test_ids.shorttxids[i - 1], test_ids.GetShortID(block.vtx[i]->GetWitnessHash()));
+    }
+
+    // All transactions are found, in the mempool or in the extra transactions.
+    const std::vector<std::pair<uint256, CTransactionRef>> extra{{block.vtx[1]->GetWitnessHash(), block.vtx[1]}};
+    PartiallyDownloadedBlock partialBlock(&pool);
+    BOOST_CHECK(partialBlock.InitData(shortIDs, extra) == READ_STATUS_OK);
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        BOOST_CHECK(partialBlock.IsTxAvailable(i));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(TransactionsRequestSerializationTest) {
     BlockTransactionsRequest req1;
     req1.blockhash = InsecureRand256();
@@ -259,6 +259,40 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     BOOST_CHECK_EQUAL(filters.size(), tip->nHeight + 1U);
     BOOST_CHECK_EQUAL(filter_hashes.size(), tip->nHeight + 1U);
 
+    // A repeated range lookup is served from the in-memory caches and must agree with the index.
+    std::vector<BlockFilter> cached_filters;
+    BOOST_CHECK(filter_index.LookupFilterRange(0, tip, cached_filters));
+    BOOST_REQUIRE_EQUAL(cached_filters.size(), filters.size());
+    for (size_t i = 0; i < filters.size(); ++i) {
+        BOOST_CHECK_EQUAL(cached_filters[i].GetBlockHash(), filters[i].GetBlockHash());
+        BOOST_CHECK_EQUAL(cached_filters[i].GetHash(), filter_hashes[i]);
+    }
+
+    // Matching a range agrees with matching each filter of the range on its own. The four blocks
+    // of chain A at the tip pay to its coinbase script, chain B is no longer active.
+    const GCSFilter::ElementSet elements{
+        GCSFilter::Element(coinbase_script_pub_key_A.begin(), coinbase_script_pub_key_A.end()),
+        GCSFilter::Element(coinbase_script_pub_key_B.begin(), coinbase_script_pub_key_B.end()),
+        GCSFilter::Element(20, 0x42),
+    };
+    std::vector<int> heights;
+    BOOST_CHECK(filter_index.MatchFilterRange(1, tip, elements, heights));
+    std::vector<int> expected_heights;
+    for (int height = 1; height <= tip->nHeight; ++height) {
+        if (filters[height].GetFilter().MatchAny(elements)) expected_heights.push_back(height);
+    }
+    BOOST_CHECK(heights == expected_heights);
+    BOOST_CHECK(heights.size() >= 4U);
+    BOOST_CHECK_EQUAL(heights.back(), tip->nHeight);
+
+    // Matching again reuses the worker threads.
+    BOOST_CHECK(filter_index.MatchFilterRange(tip->nHeight, tip, elements, heights));
+    BOOST_CHECK(heights == std::vector<int>{tip->nHeight});
+
+    // Nothing matches an empty set of elements.
+    BOOST_CHECK(filter_index.MatchFilterRange(0, tip, {}, heights));
+    BOOST_CHECK(heights.empty());
+
     filters.clear();
     filter_hashes.clear();
 
@@ -10,8 +10,12 @@
 #include <serialize.h>
 #include <streams.h>
 #include <univalue.h>
+#include <util/golombrice.h>
 #include <util/strencodings.h>
 
+#include <algorithm>
+#include <limits>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_AUTO_TEST_SUITE(blockfilter_tests)
@@ -39,6 +43,42 @@ BOOST_AUTO_TEST_CASE(gcsfilter_test)
     }
 }
 
+BOOST_AUTO_TEST_CASE(golombrice_reader_test)
+{
+    // The word-at-a-time reader must decode exactly what the bitwise encoder
+    // wrote, including quotients longer than a 64-bit word and P > 56, which
+    // P = 57 combines. Quotients are kept within the 64 - P bits left to them.
+    for (const uint8_t P : {0, 1, 19, 20, 57, 63}) {
+        const uint64_t max_quotient = std::min<uint64_t>(199, std::numeric_limits<uint64_t>::max() >> P);
+        std::vector<uint64_t> values;
+        for (int i = 0; i < 500; ++i) {
+            const uint64_t quotient = i % 97 == 0 && max_quotient > 64 ? 65 + InsecureRandRange(max_quotient - 64) : InsecureRandRange(std::min<uint64_t>(4, max_quotient + 1));
+            values.push_back((quotient << P) | (P ? InsecureRandBits(P) : 0));
+        }
+
+        std::vector<unsigned char> encoded;
+        {
+            CVectorWriter stream(SER_NETWORK, 0, encoded, 0);
+            BitStreamWriter<CVectorWriter> bitwriter(stream);
+            for (const uint64_t value : values) {
+                GolombRiceEncode(bitwriter, P, value);
+            }
+            bitwriter.Flush();
+        }
+
+        GolombRiceReader reader(encoded);
+        for (const uint64_t value : values) {
+            BOOST_CHECK_EQUAL(reader.Decode(P), value);
+        }
+        BOOST_CHECK_EQUAL(reader.BytesConsumed(), encoded.size());
+    }
+
+    // Running off the end of the data throws, like BitStreamReader.
+    const std::vector<unsigned char> all_ones(4, 0xff);
+    GolombRiceReader reader(all_ones);
+    BOOST_CHECK_THROW(reader.Decode(19), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(gcsfilter_default_constructor)
 {
     GCSFilter filter;
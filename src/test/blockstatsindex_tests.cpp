@@ -0,0 +1,103 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <index/blockstatsindex.h>
+#include <node/blockstorage.h>
+#include <script/standard.h>
+#include <test/util/setup_common.h>
+#include <undo.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(blockstatsindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(blockstatsindex_initial_sync, TestChain100Setup)
+{
+    BlockStatsIndex block_stats_index{1 << 20, true};
+
+    // Mine a block with a transaction paying a fee of one coin.
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CMutableTransaction mtx = CreateValidMempoolTransaction(/* input_transaction */ m_coinbase_txns[0], /* vout */ 0,
+                                                                  /* input_height */ 1, /* input_signing_key */ coinbaseKey,
+                                                                  /* output_destination */ locking_script,
+                                                                  /* output_amount */ CAmount(49 * COIN), /* submit */ false);
+    const CTransaction spend_tx{mtx};
+    const CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    const CBlock block = CreateAndProcessBlock({mtx}, coinbase_script_pub_key);
+
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+    BOOST_REQUIRE(tip->GetBlockHash() == block.GetHash());
+    CBlockStats stats;
+
+    // The block should not be found in the index before it is started.
+    BOOST_CHECK(!block_stats_index.LookUpStats(tip, stats));
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!block_stats_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(block_stats_index.Start(::ChainstateActive()));
+
+    // Allow the index to catch up with the block index.
+    const auto timeout = GetTime<std::chrono::seconds>() + 120s;
+    while (!block_stats_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(timeout > GetTime<std::chrono::milliseconds>());
+        UninterruptibleSleep(100ms);
+    }
+
+    BOOST_REQUIRE(block_stats_index.LookUpStats(tip, stats));
+    BOOST_CHECK_EQUAL(stats.txs, 2);
+    BOOST_CHECK_EQUAL(stats.ins, 1);
+    BOOST_CHECK_EQUAL(stats.outs, int64_t(block.vtx[0]->vout.size() + spend_tx.vout.size()));
+    BOOST_CHECK_EQUAL(stats.total_out, 49 * COIN);
+    BOOST_CHECK_EQUAL(stats.totalfee, COIN);
+    BOOST_CHECK_EQUAL(stats.minfee, COIN);
+    BOOST_CHECK_EQUAL(stats.maxfee, COIN);
+    BOOST_CHECK_EQUAL(stats.medianfee, COIN);
+    BOOST_CHECK_EQUAL(stats.total_size, int64_t(spend_tx.GetTotalSize()));
+    BOOST_CHECK_EQUAL(stats.mediantxsize, stats.total_size);
+
+    // The indexed stats are those computed from the block and its undo data.
+    CBlockUndo block_undo;
+    BOOST_REQUIRE(UndoReadFromDisk(block_undo, tip));
+    CBlockStats computed;
+    BOOST_REQUIRE(ComputeBlockStats(block, block_undo, computed));
+    CDataStream indexed_ser(SER_DISK, PROTOCOL_VERSION);
+    indexed_ser << stats;
+    CDataStream computed_ser(SER_DISK, PROTOCOL_VERSION);
+    computed_ser << computed;
+    BOOST_CHECK(indexed_ser.str() == computed_ser.str());
+
+    // Blocks without fees have none reported.
+    BOOST_REQUIRE(block_stats_index.LookUpStats(tip->pprev, stats));
+    BOOST_CHECK_EQUAL(stats.txs, 1);
+    BOOST_CHECK_EQUAL(stats.totalfee, 0);
+    BOOST_CHECK_EQUAL(stats.minfee, 0);
+    BOOST_CHECK_EQUAL(stats.mintxsize, 0);
+
+    // The genesis block is not indexed, nor other blocks at an indexed height.
+    BOOST_CHECK(!block_stats_index.LookUpStats(tip->GetAncestor(0), stats));
+    uint256 other_hash{uint256S("01")};
+    CBlockIndex other{*tip};
+    other.phashBlock = &other_hash;
+    BOOST_CHECK(!block_stats_index.LookUpStats(&other, stats));
+
+    // Undo data which does not match the block is rejected.
+    block_undo.vtxundo.clear();
+    BOOST_CHECK(!ComputeBlockStats(block, block_undo, computed));
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    block_stats_index.Stop();
+
+    // Let scheduler events finish running to avoid accessing any memory related to the index after it is destructed
+    SyncWithValidationInterfaceQueue();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,222 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <core_io.h>
+#include <rpc/cbor.h>
+#include <rpc/util.h>
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+BOOST_FIXTURE_TEST_SUITE(cbor_tests, BasicTestingSetup)
+
+static std::string EncodeHex(const UniValue& value, const RPCResults* results = nullptr)
+{
+    return HexStr(MakeUCharSpan(EncodeCBOR(value, results)));
+}
+
+static UniValue Decode(const std::string& hex)
+{
+    const std::vector<unsigned char> data = ParseHex(hex);
+    UniValue value;
+    BOOST_CHECK(DecodeCBOR(data, value));
+    return value;
+}
+
+static bool Decodes(const std::string& hex)
+{
+    const std::vector<unsigned char> data = ParseHex(hex);
+    UniValue value;
+    return DecodeCBOR(data, value);
+}
+
+BOOST_AUTO_TEST_CASE(cbor_encode)
+{
+    // Examples of RFC 8949 appendix A
+    BOOST_CHECK_EQUAL(EncodeHex(0), "00");
+    BOOST_CHECK_EQUAL(EncodeHex(23), "17");
+    BOOST_CHECK_EQUAL(EncodeHex(24), "1818");
+    BOOST_CHECK_EQUAL(EncodeHex(1000), "1903e8");
+    BOOST_CHECK_EQUAL(EncodeHex(1000000), "1a000f4240");
+    BOOST_CHECK_EQUAL(EncodeHex(int64_t{1000000000000}), "1b000000e8d4a51000");
+    BOOST_CHECK_EQUAL(EncodeHex(uint64_t{18446744073709551615U}), "1bffffffffffffffff");
+    BOOST_CHECK_EQUAL(EncodeHex(-1), "20");
+    BOOST_CHECK_EQUAL(EncodeHex(-1000), "3903e7");
+    BOOST_CHECK_EQUAL(EncodeHex(UniValue(UniValue::VNUM, "273.15")), "c48221196ab3");
+    BOOST_CHECK_EQUAL(EncodeHex(false), "f4");
+    BOOST_CHECK_EQUAL(EncodeHex(true), "f5");
+    BOOST_CHECK_EQUAL(EncodeHex(NullUniValue), "f6");
+    BOOST_CHECK_EQUAL(EncodeHex(""), "60");
+    BOOST_CHECK_EQUAL(EncodeHex("IETF"), "6449455446");
+    BOOST_CHECK_EQUAL(EncodeHex(UniValue(UniValue::VARR)), "80");
+    UniValue array(UniValue::VARR);
+    array.push_back(2);
+    array.push_back(3);
+    UniValue object(UniValue::VOBJ);
+    object.pushKV("a", 1);
+    object.pushKV("b", array);
+    BOOST_CHECK_EQUAL(EncodeHex(object), "a26161016162820203");
+
+    // Amounts stay exact, numbers in exponent notation too where they can.
+    BOOST_CHECK_EQUAL(EncodeHex(ValueFromAmount(1)), "c4822701");
+    BOOST_CHECK_EQUAL(EncodeHex(ValueFromAmount(-2100000000000000)), "c482273b000775f05a073fff");
+    BOOST_CHECK_EQUAL(EncodeHex(UniValue(UniValue::VNUM, "1.5e-07")), "c482270f");
+    BOOST_CHECK_EQUAL(EncodeHex(UniValue(UniValue::VNUM, "1e+20")), "fb4415af1d78b58c40");
+}
+
+BOOST_AUTO_TEST_CASE(cbor_encode_hex_results)
+{
+    const RPCResults results{
+        RPCResult{RPCResult::Type::OBJ, "", "", {
+            {RPCResult::Type::STR_HEX, "hash", "a hash"},
+            {RPCResult::Type::STR, "label", "text"},
+            {RPCResult::Type::ARR, "tx", "", {{RPCResult::Type::STR_HEX, "", "a txid"}}},
+            {RPCResult::Type::ARR, "txs", "", {{RPCResult::Type::OBJ, "", "", {{RPCResult::Type::STR_HEX, "hex", "a transaction"}}}}},
+        }},
+        RPCResult{RPCResult::Type::STR_HEX, "", "the whole"},
+    };
+
+    UniValue txs(UniValue::VARR);
+    UniValue tx(UniValue::VOBJ);
+    tx.pushKV("hex", "");
+    tx.pushKV("other", "abcd");
+    txs.push_back(tx);
+    UniValue txids(UniValue::VARR);
+    txids.push_back("0102");
+    txids.push_back("not hex");
+    UniValue value(UniValue::VOBJ);
+    value.pushKV("hash", "00ff");
+    value.pushKV("label", "abcd");
+    value.pushKV("tx", txids);
+    value.pushKV("txs", txs);
+    value.pushKV("undocumented", "abcd");
+    // Hex strings where documented become byte strings, the rest stays text.
+    BOOST_CHECK_EQUAL(EncodeHex(value, &results),
+                      "a5" "6468617368" "4200ff"
+                      "656c6162656c" "6461626364"
+                      "627478" "82" "420102" "676e6f7420686578"
+                      "63747873" "81" "a2" "63686578" "40" "656f74686572" "6461626364"
+                      "6c756e646f63756d656e746564" "6461626364");
+    BOOST_CHECK_EQUAL(EncodeHex("abcd", &results), "42abcd");
+    BOOST_CHECK_EQUAL(EncodeHex("abcd"), "6461626364");
+
+    // Only the result of a reply is described.
+    UniValue reply(UniValue::VOBJ);
+    reply.pushKV("result", "abcd");
+    reply.pushKV("error", NullUniValue);
+    reply.pushKV("id", "abcd");
+    BOOST_CHECK_EQUAL(HexStr(MakeUCharSpan(EncodeCBORReply(reply, &results))), "a3" "66726573756c74" "42abcd" "656572726f72" "f6" "626964" "6461626364");
+    UniValue replies(UniValue::VARR);
+    replies.push_back(reply);
+    replies.push_back(reply);
+    BOOST_CHECK_EQUAL(HexStr(MakeUCharSpan(EncodeCBORBatchReply(replies, {nullptr, &results}))),
+                      "82" "a3" "66726573756c74" "6461626364" "656572726f72" "f6" "626964" "6461626364"
+                      "a3" "66726573756c74" "42abcd" "656572726f72" "f6" "626964" "6461626364");
+}
+
+BOOST_AUTO_TEST_CASE(cbor_decode)
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("str", "va\"lue");
+    inner.pushKV("num", -42);
+    inner.pushKV("big", uint64_t{18446744073709551615U});
+    inner.pushKV("amount", ValueFromAmount(123456789));
+    inner.pushKV("null", NullUniValue);
+    inner.pushKV("bool", true);
+    UniValue value(UniValue::VARR);
+    value.push_back(inner);
+    value.push_back(UniValue(UniValue::VARR));
+    value.push_back(UniValue(UniValue::VOBJ));
+    // What is encoded without descriptions decodes to the same.
+    UniValue decoded;
+    BOOST_CHECK(DecodeCBOR(MakeUCharSpan(EncodeCBOR(value)), decoded));
+    BOOST_CHECK_EQUAL(decoded.write(), value.write());
+
+    // Byte strings become hex.
+    BOOST_CHECK_EQUAL(Decode("4200ff").get_str(), "00ff");
+    BOOST_CHECK_EQUAL(Decode("40").get_str(), "");
+    // Decimal fractions become exact numbers.
+    BOOST_CHECK_EQUAL(Decode("c48221196ab3").getValStr(), "273.15");
+    BOOST_CHECK_EQUAL(Decode("c4822701").getValStr(), "0.00000001");
+    BOOST_CHECK_EQUAL(Decode("c4822720").getValStr(), "-0.00000001");
+    BOOST_CHECK_EQUAL(Decode("c4820203").getValStr(), "300");
+    // Floats
+    BOOST_CHECK_EQUAL(Decode("f93e00").get_real(), 1.5);
+    BOOST_CHECK_EQUAL(Decode("f90001").get_real(), std::ldexp(1.0, -24));
+    BOOST_CHECK_EQUAL(Decode("fa47c35000").get_real(), 100000.0);
+    BOOST_CHECK_EQUAL(Decode("fbc010666666666666").get_real(), -4.1);
+    // Other tags are ignored.
+    BOOST_CHECK_EQUAL(Decode("c11a514b67b0").get_int64(), 1363896240);
+    BOOST_CHECK_EQUAL(Decode("3b7fffffffffffffff").get_int64(), std::numeric_limits<int64_t>::min());
+    BOOST_CHECK_EQUAL(Decode("3bffffffffffffffff").getValStr(), "-18446744073709551616");
+
+    // Malformed or unsupported
+    BOOST_CHECK(!Decodes(""));
+    BOOST_CHECK(!Decodes("0000"));
+    BOOST_CHECK(!Decodes("19ff"));
+    BOOST_CHECK(!Decodes("6461"));
+    BOOST_CHECK(!Decodes("9f01ff"));
+    BOOST_CHECK(!Decodes("5f4101ff"));
+    BOOST_CHECK(!Decodes("a10101"));
+    BOOST_CHECK(!Decodes("9bffffffffffffffff"));
+    BOOST_CHECK(!Decodes("f97c00"));
+    BOOST_CHECK(!Decodes("f8ff"));
+    BOOST_CHECK(!Decodes("c482186501"));
+    BOOST_CHECK(!Decodes("c482f93e0001"));
+    // Text strings must be valid UTF-8.
+    BOOST_CHECK_EQUAL(Decode("62c3a9").get_str(), "\xc3\xa9");
+    BOOST_CHECK_EQUAL(Decode("64f09f9880").get_str(), "\xf0\x9f\x98\x80");
+    BOOST_CHECK(!Decodes("61ff"));
+    BOOST_CHECK(!Decodes("61c3"));
+    BOOST_CHECK(!Decodes("62c0af"));
+    BOOST_CHECK(!Decodes("63eda080"));
+    BOOST_CHECK(!Decodes("64f4908080"));
+    BOOST_CHECK(!Decodes("a161ff00"));
+    // Nesting as deep as JSON may
+    std::string nested;
+    for (int i = 0; i < 512; ++i) nested += "81";
+    BOOST_CHECK(Decodes(nested + "00"));
+    BOOST_CHECK(!Decodes("81" + nested + "00"));
+}
+
+BOOST_AUTO_TEST_CASE(cbor_negotiation)
+{
+    BOOST_CHECK(IsCBORContentType("application/cbor"));
+    BOOST_CHECK(IsCBORContentType(" Application/CBOR ; charset=utf-8"));
+    BOOST_CHECK(!IsCBORContentType("application/json"));
+    BOOST_CHECK(!IsCBORContentType("application/cbor-seq"));
+    BOOST_CHECK(!IsCBORContentType("text/plain; x=application/cbor"));
+
+    BOOST_CHECK(AcceptsCBOR("application/cbor"));
+    BOOST_CHECK(AcceptsCBOR("application/json;q=0.5, application/cbor"));
+    BOOST_CHECK(AcceptsCBOR("application/cbor, */*;q=0.1"));
+    BOOST_CHECK(AcceptsCBOR("application/cbor;q=0.5, application/json;q=0.500"));
+    BOOST_CHECK(AcceptsCBOR("APPLICATION/CBOR ; Q=1.0"));
+    // Not acceptable
+    BOOST_CHECK(!AcceptsCBOR("application/cbor;q=0"));
+    BOOST_CHECK(!AcceptsCBOR("application/cbor; q=0.000, application/json"));
+    // JSON preferred
+    BOOST_CHECK(!AcceptsCBOR("application/json, application/cbor;q=0.9"));
+    BOOST_CHECK(!AcceptsCBOR("application/cbor;q=0.5, */*"));
+    // Not listed
+    BOOST_CHECK(!AcceptsCBOR(""));
+    BOOST_CHECK(!AcceptsCBOR("*/*"));
+    BOOST_CHECK(!AcceptsCBOR("application/cbor-seq"));
+    BOOST_CHECK(!AcceptsCBOR("text/html;level=application/cbor"));
+    // Malformed qualities are ignored.
+    BOOST_CHECK(!AcceptsCBOR("application/cbor;q=2"));
+    BOOST_CHECK(!AcceptsCBOR("application/cbor;q=0.1234"));
+    BOOST_CHECK(!AcceptsCBOR("application/cbor;q=1.5"));
+    BOOST_CHECK(AcceptsCBOR("application/cbor;q=x, application/cbor;q=0.2"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
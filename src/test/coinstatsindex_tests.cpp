@@ -3,7 +3,9 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <index/coinstatsindex.h>
+#include <node/coinstats.h>
 #include <test/util/setup_common.h>
+#include <txdb.h>
 #include <util/time.h>
 #include <validation.h>
 
@@ -70,6 +72,25 @@ BOOST_FIXTURE_TEST_CASE(coinstatsindex_initial_sync, TestChain100Setup)
 
     BOOST_CHECK(block_index != new_block_index);
 
+    // A scan of the UTXO set, partitioned across threads where possible, must
+    // agree with the incrementally maintained index.
+    ::ChainstateActive().ForceFlushStateToDisk();
+    CCoinsViewDB& coins_db{WITH_LOCK(cs_main, return std::ref(::ChainstateActive().CoinsDB()))};
+    CCoinsStats scan_stats{CoinStatsHashType::MUHASH};
+    scan_stats.index_requested = false;
+    BOOST_REQUIRE(GetUTXOStats(&coins_db, g_chainman.m_blockman, scan_stats, [] {}));
+    BOOST_CHECK(!scan_stats.index_used);
+    BOOST_CHECK_EQUAL(scan_stats.hashSerialized, new_coin_stats.hashSerialized);
+    BOOST_CHECK_EQUAL(scan_stats.nTransactionOutputs, new_coin_stats.nTransactionOutputs);
+    BOOST_CHECK_EQUAL(scan_stats.nTotalAmount, new_coin_stats.nTotalAmount);
+
+    // The partitions cover every coin exactly once.
+    size_t coins_in_partitions{0};
+    for (const auto& cursor : coins_db.PartitionedCursors(7)) {
+        for (; cursor->Valid(); cursor->Next()) ++coins_in_partitions;
+    }
+    BOOST_CHECK_EQUAL(coins_in_partitions, scan_stats.coins_count);
+
     // Shutdown sequence (c.f. Shutdown() in init.cpp)
     coin_stats_index.Stop();
 
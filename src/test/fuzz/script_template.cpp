@@ -0,0 +1,139 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace {
+/**
+ * Accepts a signature depending on a hash of everything it is checked
+ * against, so that both outcomes are reachable without keys, and any
+ * difference in what the two implementations check shows.
+ */
+class HashingSignatureChecker : public BaseSignatureChecker
+{
+public:
+    bool CheckECDSASignature(const std::vector<unsigned char>& sig, const std::vector<unsigned char>& pubkey, const CScript& script_code, SigVersion sigversion) const override
+    {
+        const uint256 hash = (CHashWriter(SER_GETHASH, 0) << sig << pubkey << script_code << int(sigversion)).GetHash();
+        return hash.begin()[0] & 1;
+    }
+};
+
+std::vector<unsigned char> ConsumeSignature(FuzzedDataProvider& fuzzed_data_provider)
+{
+    if (fuzzed_data_provider.ConsumeBool()) return ConsumeRandomLengthByteVector(fuzzed_data_provider, 80);
+    // A DER signature with a hash type, to get past the encoding checks.
+    std::vector<unsigned char> sig{0x30, 0x44};
+    for (int i = 0; i < 2; ++i) {
+        std::vector<unsigned char> integer = fuzzed_data_provider.ConsumeBytes<unsigned char>(32);
+        integer.resize(32, 0x11);
+        integer[0] &= 0x7f;
+        sig.insert(sig.end(), {0x02, 0x20});
+        sig.insert(sig.end(), integer.begin(), integer.end());
+    }
+    sig.push_back(fuzzed_data_provider.ConsumeIntegral<uint8_t>());
+    return sig;
+}
+
+std::vector<unsigned char> ConsumePubKey(FuzzedDataProvider& fuzzed_data_provider)
+{
+    if (fuzzed_data_provider.ConsumeBool()) return ConsumeRandomLengthByteVector(fuzzed_data_provider, 70);
+    std::vector<unsigned char> pubkey = fuzzed_data_provider.ConsumeBytes<unsigned char>(CPubKey::COMPRESSED_SIZE);
+    pubkey.resize(CPubKey::COMPRESSED_SIZE);
+    pubkey[0] = 0x02 | (pubkey[0] & 1);
+    return pubkey;
+}
+
+CScript ConsumePushes(FuzzedDataProvider& fuzzed_data_provider)
+{
+    CScript script;
+    while (fuzzed_data_provider.ConsumeBool()) {
+        script << ConsumeRandomLengthByteVector(fuzzed_data_provider, 80);
+    }
+    return script;
+}
+} // namespace
+
+FUZZ_TARGET(script_template)
+{
+    FuzzedDataProvider fuzzed_data_provider(buffer.data(), buffer.size());
+    unsigned int flags = fuzzed_data_provider.ConsumeIntegral<unsigned int>();
+    // VerifyScript requires these.
+    if (flags & SCRIPT_VERIFY_CLEANSTACK) flags |= SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS;
+    if (flags & SCRIPT_VERIFY_WITNESS) flags |= SCRIPT_VERIFY_P2SH;
+
+    // Scripts that match the templates, whose hashes match by construction.
+    CScript script_sig;
+    CScript script_pubkey;
+    CScriptWitness witness;
+    switch (fuzzed_data_provider.ConsumeIntegralInRange(0, 3)) {
+    case 0: {
+        const std::vector<unsigned char> pubkey = ConsumePubKey(fuzzed_data_provider);
+        script_sig << ConsumeSignature(fuzzed_data_provider) << pubkey;
+        script_pubkey << OP_DUP << OP_HASH160 << ToByteVector(Hash160(pubkey)) << OP_EQUALVERIFY << OP_CHECKSIG;
+        break;
+    }
+    case 1:
+    case 2: {
+        const std::vector<unsigned char> pubkey = ConsumePubKey(fuzzed_data_provider);
+        witness.stack = {ConsumeSignature(fuzzed_data_provider), pubkey};
+        const CScript program = CScript() << OP_0 << ToByteVector(Hash160(pubkey));
+        if (fuzzed_data_provider.ConsumeBool()) {
+            script_pubkey = program;
+        } else {
+            script_sig << ToByteVector(program);
+            script_pubkey << OP_HASH160 << ToByteVector(Hash160(program)) << OP_EQUAL;
+        }
+        break;
+    }
+    case 3: {
+        const int n_keys = fuzzed_data_provider.ConsumeIntegralInRange(1, 17);
+        const int n_sigs = fuzzed_data_provider.ConsumeIntegralInRange(1, n_keys);
+        CScript redeem_script;
+        redeem_script << n_sigs;
+        for (int i = 0; i < n_keys; ++i) redeem_script << ConsumePubKey(fuzzed_data_provider);
+        redeem_script << n_keys << OP_CHECKMULTISIG;
+        script_sig << OP_0;
+        for (int i = 0; i < n_sigs; ++i) script_sig << ConsumeSignature(fuzzed_data_provider);
+        script_sig << ToByteVector(redeem_script);
+        script_pubkey << OP_HASH160 << ToByteVector(Hash160(redeem_script)) << OP_EQUAL;
+        break;
+    }
+    }
+
+    // Then anything may change.
+    if (fuzzed_data_provider.ConsumeBool()) {
+        const CScript pushes = ConsumePushes(fuzzed_data_provider);
+        script_sig.insert(fuzzed_data_provider.ConsumeBool() ? script_sig.begin() : script_sig.end(), pushes.begin(), pushes.end());
+    }
+    if (fuzzed_data_provider.ConsumeBool() && !script_sig.empty()) {
+        std::vector<unsigned char> bytes(script_sig.begin(), script_sig.end());
+        bytes[fuzzed_data_provider.ConsumeIntegralInRange<size_t>(0, bytes.size() - 1)] = fuzzed_data_provider.ConsumeIntegral<uint8_t>();
+        script_sig = CScript(bytes.begin(), bytes.end());
+    }
+    if (fuzzed_data_provider.ConsumeBool()) {
+        witness.stack.push_back(ConsumeRandomLengthByteVector(fuzzed_data_provider, 80));
+    }
+
+    const HashingSignatureChecker checker;
+    ScriptError template_err;
+    ScriptError interpreter_err;
+    const TemplateResult result = VerifyTemplateScript(script_sig, script_pubkey, &witness, flags, checker, &template_err);
+    const bool valid = VerifyScript(script_sig, script_pubkey, &witness, flags, checker, &interpreter_err);
+    if (result != TemplateResult::UNHANDLED) {
+        assert((result == TemplateResult::VALID) == valid);
+        assert(template_err == interpreter_err);
+    }
+}
@@ -147,4 +147,26 @@ BOOST_AUTO_TEST_CASE(siphash)
     }
 }
 
+BOOST_AUTO_TEST_CASE(siphash_batch)
+{
+    // Use the SIMD implementation, if any, and batch sizes around its width.
+    SipHashAutoDetect();
+    FastRandomContext ctx;
+    for (size_t count = 0; count <= 70; ++count) {
+        const uint64_t k1 = ctx.rand64();
+        const uint64_t k2 = ctx.rand64();
+        std::vector<uint256> keys(count);
+        std::vector<const uint256*> vals;
+        for (size_t i = 0; i < count; ++i) {
+            keys[i] = InsecureRand256();
+            vals.push_back(&keys[i]);
+        }
+        std::vector<uint64_t> out(count);
+        SipHashUint256Batch(k1, k2, vals.data(), out.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            BOOST_CHECK_EQUAL(out[i], SipHashUint256(k1, k2, keys[i]));
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
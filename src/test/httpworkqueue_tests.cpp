@@ -0,0 +1,190 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <httpserver.h>
+#include <httpworkqueue.h>
+#include <netbase.h>
+#include <test/util/setup_common.h>
+#include <util/string.h>
+#include <util/time.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct TestItem {
+    std::function<void()> func;
+    void operator()() { func(); }
+};
+
+bool EnqueueItem(WorkQueue<TestItem>& queue, const std::string& client, size_t bytes, std::function<void()> func = [] {})
+{
+    auto item = std::make_unique<TestItem>(TestItem{std::move(func)});
+    if (!queue.Enqueue(item.get(), client, bytes)) return false;
+    item.release();
+    return true;
+}
+
+void WaitForDispatched(WorkQueue<TestItem>& queue, uint64_t dispatched)
+{
+    while (queue.GetStats().dispatched < dispatched) {
+        UninterruptibleSleep(std::chrono::milliseconds{1});
+    }
+}
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(httpworkqueue_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(workqueue_round_robin)
+{
+    WorkQueue<TestItem> queue(1 << 20, 1, 0, [](bool) {});
+    // Only the worker thread appends, and the main thread reads after done.
+    std::vector<std::string> order;
+    std::promise<void> done;
+    for (const std::string name : {"a1", "a2", "a3", "b1", "b2", "c1"}) {
+        BOOST_CHECK(EnqueueItem(queue, name.substr(0, 1), 1, [&order, &done, name] {
+            order.push_back(name);
+            if (order.size() == 6) done.set_value();
+        }));
+    }
+    BOOST_CHECK_EQUAL(queue.GetStats().clients, 3U);
+
+    std::thread worker([&queue] { queue.Run(); });
+    BOOST_CHECK(done.get_future().wait_for(std::chrono::seconds{30}) == std::future_status::ready);
+    queue.Interrupt();
+    worker.join();
+
+    // The clients are served in turn, and the items of each in order.
+    const std::vector<std::string> expected{"a1", "b1", "c1", "a2", "b2", "a3"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+    const HTTPWorkQueueStats stats = queue.GetStats();
+    BOOST_CHECK_EQUAL(stats.queued, 0U);
+    BOOST_CHECK_EQUAL(stats.clients, 0U);
+    BOOST_CHECK_EQUAL(stats.dispatched, 6U);
+}
+
+BOOST_AUTO_TEST_CASE(workqueue_client_connections)
+{
+    // Connections from one address, or from local clients as one user, are
+    // one client.
+    BOOST_CHECK_EQUAL(HTTPClientKey(LookupNumeric("10.0.0.1", 1001), ""), HTTPClientKey(LookupNumeric("10.0.0.1", 1002), ""));
+    BOOST_CHECK_EQUAL(HTTPClientKey(LookupNumeric("10.0.0.1", 1001), "alice"), HTTPClientKey(LookupNumeric("10.0.0.1", 1002), "bob"));
+    BOOST_CHECK_EQUAL(HTTPClientKey(LookupNumeric("127.0.0.1", 1001), "alice"), HTTPClientKey(LookupNumeric("127.0.0.1", 1002), "alice"));
+    BOOST_CHECK(HTTPClientKey(LookupNumeric("127.0.0.1", 1001), "alice") != HTTPClientKey(LookupNumeric("127.0.0.1", 1002), "bob"));
+    BOOST_CHECK(HTTPClientKey(LookupNumeric("::1", 1001), "alice") != HTTPClientKey(LookupNumeric("::1", 1002), ""));
+    BOOST_CHECK(HTTPClientKey(LookupNumeric("10.0.0.1", 1001), "") != HTTPClientKey(LookupNumeric("10.0.0.2", 1001), ""));
+
+    // A client sending requests on several connections at once does not
+    // starve another with a single connection.
+    WorkQueue<TestItem> queue(1 << 20, 1, 0, [](bool) {});
+    std::vector<std::string> order;
+    std::promise<void> done;
+    const auto enqueue = [&](const std::string& name, const std::string& address, uint16_t port, const std::string& user) {
+        BOOST_CHECK(EnqueueItem(queue, HTTPClientKey(LookupNumeric(address, port), user), 1, [&order, &done, name] {
+            order.push_back(name);
+            if (order.size() == 6) done.set_value();
+        }));
+    };
+    for (uint16_t port = 1001; port <= 1004; ++port) {
+        enqueue("a" + ToString(port - 1000), "127.0.0.1", port, "alice");
+    }
+    enqueue("b1", "127.0.0.1", 2001, "bob");
+    enqueue("c1", "10.0.0.1", 3001, "");
+    BOOST_CHECK_EQUAL(queue.GetStats().clients, 3U);
+
+    std::thread worker([&queue] { queue.Run(); });
+    BOOST_CHECK(done.get_future().wait_for(std::chrono::seconds{30}) == std::future_status::ready);
+    queue.Interrupt();
+    worker.join();
+
+    const std::vector<std::string> expected{"a1", "b1", "c1", "a2", "a3", "a4"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(order.begin(), order.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(workqueue_memory_limit)
+{
+    // An item larger than the whole queue is still accepted into an empty one.
+    {
+        WorkQueue<TestItem> queue(100, 1, 0, [](bool) {});
+        BOOST_CHECK(EnqueueItem(queue, "a", 1000));
+        BOOST_CHECK(!EnqueueItem(queue, "b", 1));
+    }
+
+    std::vector<bool> pauses;
+    WorkQueue<TestItem> queue(100, 1, 0, [&pauses](bool paused) { pauses.push_back(paused); });
+    BOOST_CHECK(EnqueueItem(queue, "a", 40));
+    BOOST_CHECK(pauses.empty());
+    // Beyond half of the limit, the queue is paused.
+    BOOST_CHECK(EnqueueItem(queue, "b", 20));
+    BOOST_CHECK(pauses == std::vector<bool>{true});
+    // Beyond the limit, items are rejected.
+    BOOST_CHECK(!EnqueueItem(queue, "a", 50));
+    BOOST_CHECK(EnqueueItem(queue, "c", 40));
+    HTTPWorkQueueStats stats = queue.GetStats();
+    BOOST_CHECK_EQUAL(stats.queued, 3U);
+    BOOST_CHECK_EQUAL(stats.queued_bytes, 100U);
+    BOOST_CHECK_EQUAL(stats.rejected, 1U);
+    BOOST_CHECK(stats.paused);
+
+    // The queue resumes once it has drained to a quarter of the limit.
+    std::thread worker([&queue] { queue.Run(); });
+    WaitForDispatched(queue, 3);
+    queue.Interrupt();
+    worker.join();
+    BOOST_CHECK(pauses == (std::vector<bool>{true, false}));
+    stats = queue.GetStats();
+    BOOST_CHECK_EQUAL(stats.queued_bytes, 0U);
+    BOOST_CHECK(!stats.paused);
+}
+
+BOOST_AUTO_TEST_CASE(workqueue_park)
+{
+    // One active and one parked thread at most, on as many threads.
+    WorkQueue<TestItem> queue(1 << 20, 1, 1, [](bool) {});
+    std::promise<void> second_ran;
+    std::promise<void> done;
+    bool first_parked{false};
+    bool first_saw_second{false};
+    bool second_parked{true};
+    HTTPWorkQueueStats second_stats;
+
+    // The first item parks and waits for the second, which can only run in
+    // the meantime because the first one does not count as active.
+    BOOST_CHECK(EnqueueItem(queue, "a", 1, [&] {
+        first_parked = queue.Park();
+        first_saw_second = second_ran.get_future().wait_for(std::chrono::seconds{30}) == std::future_status::ready;
+        if (first_parked) queue.Unpark();
+        done.set_value();
+    }));
+    // As many threads as allowed are parked already, so the second item cannot park.
+    BOOST_CHECK(EnqueueItem(queue, "b", 1, [&] {
+        second_stats = queue.GetStats();
+        second_parked = queue.Park();
+        if (second_parked) queue.Unpark();
+        second_ran.set_value();
+    }));
+
+    std::thread worker1([&queue] { queue.Run(); });
+    std::thread worker2([&queue] { queue.Run(); });
+    BOOST_CHECK(done.get_future().wait_for(std::chrono::seconds{60}) == std::future_status::ready);
+    queue.Interrupt();
+    worker1.join();
+    worker2.join();
+
+    BOOST_CHECK(first_parked);
+    BOOST_CHECK(first_saw_second);
+    BOOST_CHECK(!second_parked);
+    BOOST_CHECK_EQUAL(second_stats.active, 1);
+    BOOST_CHECK_EQUAL(second_stats.parked, 1);
+    BOOST_CHECK_EQUAL(queue.GetStats().parked, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
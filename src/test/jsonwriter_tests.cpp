@@ -0,0 +1,141 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/jsonwriter.h>
+#include <test/util/setup_common.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+BOOST_FIXTURE_TEST_SUITE(jsonwriter_tests, BasicTestingSetup)
+
+//! Write a value with the writer, containers element by element.
+static void WriteStreaming(JSONWriter& writer, const UniValue& value)
+{
+    if (value.isObject()) {
+        writer.BeginObject();
+        for (size_t i = 0; i < value.size(); ++i) {
+            writer.Key(value.getKeys()[i]);
+            WriteStreaming(writer, value.getValues()[i]);
+        }
+        writer.EndObject();
+    } else if (value.isArray()) {
+        writer.BeginArray();
+        for (const UniValue& element : value.getValues()) {
+            WriteStreaming(writer, element);
+        }
+        writer.EndArray();
+    } else {
+        writer.Value(value);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_matches_univalue)
+{
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("str\"ing\n", "va\\lue");
+    inner.pushKV("num", -42);
+    inner.pushKV("real", UniValue(UniValue::VNUM, "0.00000001"));
+    inner.pushKV("null", NullUniValue);
+    inner.pushKV("empty_array", UniValue(UniValue::VARR));
+    inner.pushKV("empty_object", UniValue(UniValue::VOBJ));
+    UniValue array(UniValue::VARR);
+    array.push_back(true);
+    array.push_back(inner);
+    array.push_back(UniValue(UniValue::VARR));
+    array.push_back("\x01");
+    UniValue outer(UniValue::VOBJ);
+    outer.pushKV("array", array);
+    outer.pushKV("object", inner);
+
+    for (const UniValue& value : {outer, array, inner, UniValue(UniValue::VARR), UniValue("top"), NullUniValue}) {
+        std::string text;
+        JSONWriter writer([&](Span<const char> chunk) { text.append(chunk.begin(), chunk.end()); });
+        WriteStreaming(writer, value);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(text, value.write());
+
+        // Whole values and members are written as they are.
+        text.clear();
+        writer.Value(value);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(text, value.write());
+        if (value.isObject()) {
+            text.clear();
+            writer.BeginObject();
+            writer.Members(value);
+            writer.EndObject();
+            writer.Flush();
+            BOOST_CHECK_EQUAL(text, value.write());
+        }
+    }
+
+    // Raw values are separated like any other.
+    const std::string outer_text = outer.write();
+    std::string text;
+    JSONWriter writer([&](Span<const char> chunk) { text.append(chunk.begin(), chunk.end()); });
+    writer.BeginArray();
+    writer.Value(1);
+    writer.RawValue(outer_text);
+    writer.EndArray();
+    writer.Flush();
+    BOOST_CHECK_EQUAL(text, "[1," + outer_text + "]");
+
+    // So are raw values in parts, as a whole.
+    text.clear();
+    const Span<const char> outer_span{outer_text};
+    writer.BeginArray();
+    writer.Value(1);
+    writer.RawValuePart(outer_span.first(3), /* first */ true);
+    writer.RawValuePart(outer_span.subspan(3), /* first */ false);
+    writer.RawValuePart(outer_span, /* first */ true);
+    writer.EndArray();
+    writer.Flush();
+    BOOST_CHECK_EQUAL(text, "[1," + outer_text + "," + outer_text + "]");
+}
+
+BOOST_AUTO_TEST_CASE(jsonwriter_chunks)
+{
+    std::vector<size_t> chunks;
+    std::string text;
+    JSONWriter writer([&](Span<const char> chunk) {
+        chunks.push_back(chunk.size());
+        text.append(chunk.begin(), chunk.end());
+    });
+
+    // Nothing is passed on until a chunk is full.
+    UniValue expected(UniValue::VARR);
+    const std::string element(1000, 'x');
+    writer.BeginArray();
+    for (int i = 0; i < 60; ++i) {
+        writer.Value(element);
+        expected.push_back(element);
+    }
+    BOOST_CHECK_EQUAL(chunks.size(), 0U);
+    for (int i = 0; i < 40; ++i) {
+        writer.Value(element);
+        expected.push_back(element);
+    }
+    BOOST_CHECK_EQUAL(chunks.size(), 1U);
+    BOOST_CHECK(chunks[0] >= JSONWriter::CHUNK_SIZE && chunks[0] < JSONWriter::CHUNK_SIZE + element.size() + 3);
+
+    // Large raw values are passed on in chunks of their own.
+    const std::string raw = UniValue(std::string(3 * JSONWriter::CHUNK_SIZE, 'y')).write();
+    writer.RawValue(raw);
+    expected.push_back(std::string(3 * JSONWriter::CHUNK_SIZE, 'y'));
+    BOOST_CHECK_EQUAL(chunks.size(), 6U);
+    BOOST_CHECK_EQUAL(chunks[5], raw.size() - 3 * JSONWriter::CHUNK_SIZE);
+
+    writer.EndArray();
+    writer.Flush();
+    BOOST_CHECK_EQUAL(text, expected.write());
+    writer.Flush();
+    BOOST_CHECK_EQUAL(text, expected.write());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
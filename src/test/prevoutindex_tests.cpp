@@ -0,0 +1,167 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <core_io.h>
+#include <index/prevoutindex.h>
+#include <rpc/blockchain.h>
+#include <script/standard.h>
+#include <test/util/setup_common.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(prevoutindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(prevoutindex_initial_sync, TestChain100Setup)
+{
+    PrevoutIndex prevout_index{1 << 20, true};
+
+    // Spend the first coinbase output in a new block before the index starts.
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CMutableTransaction mtx = CreateValidMempoolTransaction(/* input_transaction */ m_coinbase_txns[0], /* vout */ 0,
+                                                                  /* input_height */ 1, /* input_signing_key */ coinbaseKey,
+                                                                  /* output_destination */ locking_script,
+                                                                  /* output_amount */ CAmount(49 * COIN), /* submit */ false);
+    const CTransaction spend_tx{mtx};
+    const CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    CreateAndProcessBlock({mtx}, coinbase_script_pub_key);
+
+    const COutPoint spent_outpoint{m_coinbase_txns[0]->GetHash(), 0};
+    uint256 spending_txid;
+    Coin coin;
+
+    // The outpoint should not be found in the index before it is started.
+    BOOST_CHECK(!prevout_index.FindSpender(spent_outpoint, spending_txid, coin));
+
+    // BlockUntilSyncedToCurrentChain should return false before the index is started.
+    BOOST_CHECK(!prevout_index.BlockUntilSyncedToCurrentChain());
+
+    BOOST_REQUIRE(prevout_index.Start(::ChainstateActive()));
+
+    // Allow the index to catch up with the block index.
+    const auto timeout = GetTime<std::chrono::seconds>() + 120s;
+    while (!prevout_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(timeout > GetTime<std::chrono::milliseconds>());
+        UninterruptibleSleep(100ms);
+    }
+
+    // The spent coinbase output is recorded with its spender and value.
+    BOOST_REQUIRE(prevout_index.FindSpender(spent_outpoint, spending_txid, coin));
+    BOOST_CHECK(spending_txid == spend_tx.GetHash());
+    BOOST_CHECK(coin.IsCoinBase());
+    BOOST_CHECK_EQUAL(coin.nHeight, 1U);
+    BOOST_CHECK(coin.out == m_coinbase_txns[0]->vout[0]);
+
+    CTxUndo txundo;
+    BOOST_REQUIRE(prevout_index.FindPrevouts(spend_tx, txundo));
+    BOOST_REQUIRE_EQUAL(txundo.vprevout.size(), 1U);
+    BOOST_CHECK(txundo.vprevout[0].out == m_coinbase_txns[0]->vout[0]);
+
+    // Unspent outputs are not in the index.
+    BOOST_CHECK(!prevout_index.FindSpender(COutPoint{m_coinbase_txns[1]->GetHash(), 0}, spending_txid, coin));
+    BOOST_CHECK(!prevout_index.FindSpender(COutPoint{spend_tx.GetHash(), 0}, spending_txid, coin));
+
+    // Coinbase transactions have no prevouts.
+    BOOST_CHECK(!prevout_index.FindPrevouts(*m_coinbase_txns[1], txundo));
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    prevout_index.Stop();
+
+    // Let scheduler events finish running to avoid accessing any memory related to the index after it is destructed
+    SyncWithValidationInterfaceQueue();
+}
+
+static void WaitForSync(PrevoutIndex& prevout_index)
+{
+    const auto timeout = GetTime<std::chrono::seconds>() + 120s;
+    while (!prevout_index.BlockUntilSyncedToCurrentChain()) {
+        BOOST_REQUIRE(timeout > GetTime<std::chrono::milliseconds>());
+        UninterruptibleSleep(100ms);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(prevoutindex_reorg, TestChain100Setup)
+{
+    PrevoutIndex prevout_index{1 << 20, true};
+    BOOST_REQUIRE(prevout_index.Start(::ChainstateActive()));
+    WaitForSync(prevout_index);
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CMutableTransaction mtx = CreateValidMempoolTransaction(/* input_transaction */ m_coinbase_txns[0], /* vout */ 0,
+                                                                  /* input_height */ 1, /* input_signing_key */ coinbaseKey,
+                                                                  /* output_destination */ locking_script,
+                                                                  /* output_amount */ CAmount(49 * COIN), /* submit */ false);
+    const CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    CreateAndProcessBlock({mtx}, coinbase_script_pub_key);
+    WaitForSync(prevout_index);
+
+    const COutPoint spent_outpoint{m_coinbase_txns[0]->GetHash(), 0};
+    uint256 spending_txid;
+    Coin coin;
+    BOOST_REQUIRE(prevout_index.FindSpender(spent_outpoint, spending_txid, coin));
+
+    // Replace the block spending the output with one that does not.
+    {
+        BlockValidationState state;
+        CBlockIndex* tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+        BOOST_REQUIRE(::ChainstateActive().InvalidateBlock(state, Params(), tip));
+    }
+    CreateAndProcessBlock({}, GetScriptForDestination(PKHash(key.GetPubKey())));
+    WaitForSync(prevout_index);
+
+    // The output is unspent again, so it is no longer in the index.
+    BOOST_CHECK(!prevout_index.FindSpender(spent_outpoint, spending_txid, coin));
+    CTxUndo txundo;
+    BOOST_CHECK(!prevout_index.FindPrevouts(CTransaction{mtx}, txundo));
+
+    // Spending it again in the active chain indexes the new spender.
+    CreateAndProcessBlock({mtx}, coinbase_script_pub_key);
+    WaitForSync(prevout_index);
+    BOOST_REQUIRE(prevout_index.FindSpender(spent_outpoint, spending_txid, coin));
+    BOOST_CHECK(spending_txid == mtx.GetHash());
+
+    prevout_index.Stop();
+    SyncWithValidationInterfaceQueue();
+}
+
+BOOST_FIXTURE_TEST_CASE(getblock_verbosity_prevouts, TestChain100Setup)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript locking_script = GetScriptForDestination(PKHash(key.GetPubKey()));
+    const CMutableTransaction mtx = CreateValidMempoolTransaction(/* input_transaction */ m_coinbase_txns[0], /* vout */ 0,
+                                                                  /* input_height */ 1, /* input_signing_key */ coinbaseKey,
+                                                                  /* output_destination */ locking_script,
+                                                                  /* output_amount */ CAmount(49 * COIN), /* submit */ false);
+    const CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+    const CBlock block = CreateAndProcessBlock({mtx}, coinbase_script_pub_key);
+    const CBlockIndex* tip = WITH_LOCK(cs_main, return ::ChainActive().Tip());
+
+    // Verbosity 3 adds the spent output to every input, verbosity 2 does not.
+    const UniValue with_prevouts = blockToJSON(block, tip, tip, TxVerbosity::SHOW_DETAILS_AND_PREVOUT);
+    const UniValue& tx = find_value(with_prevouts, "tx")[1];
+    BOOST_CHECK_EQUAL(find_value(tx, "fee").getValStr(), ValueFromAmount(COIN).getValStr());
+    const UniValue& prevout = find_value(find_value(tx, "vin")[0], "prevout");
+    BOOST_REQUIRE(prevout.isObject());
+    BOOST_CHECK(find_value(prevout, "generated").isTrue());
+    BOOST_CHECK_EQUAL(find_value(prevout, "height").get_int(), 1);
+    BOOST_CHECK_EQUAL(find_value(prevout, "value").getValStr(), ValueFromAmount(m_coinbase_txns[0]->vout[0].nValue).getValStr());
+    BOOST_CHECK_EQUAL(find_value(find_value(prevout, "scriptPubKey"), "hex").get_str(), HexStr(m_coinbase_txns[0]->vout[0].scriptPubKey));
+
+    const UniValue without_prevouts = blockToJSON(block, tip, tip, TxVerbosity::SHOW_DETAILS);
+    BOOST_CHECK(find_value(find_value(find_value(without_prevouts, "tx")[1], "vin")[0], "prevout").isNull());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,111 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <chain.h>
+#include <rpc/responsecache.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+//! Lets the tests deliver the validation interface callbacks.
+class TestResponseCache : public ResponseCache
+{
+public:
+    using ResponseCache::ResponseCache;
+    using ResponseCache::BlockDisconnected;
+    using ResponseCache::UpdatedBlockTip;
+};
+
+BOOST_FIXTURE_TEST_SUITE(responsecache_tests, BasicTestingSetup)
+
+static std::string Reply(const std::shared_ptr<const std::string>& reply)
+{
+    return reply ? *reply : "(none)";
+}
+
+BOOST_AUTO_TEST_CASE(responsecache_lru)
+{
+    // Room for eight replies of this size, the most there can be.
+    const std::string reply(100, 'x');
+    const size_t usage = ResponseCache::ENTRY_OVERHEAD + std::string("m\0p0", 4).size() + reply.size() + 1;
+    TestResponseCache cache(usage * 8);
+    BOOST_CHECK_EQUAL(cache.MaxReplySize(), usage);
+
+    std::vector<ResponseCache::Key> keys;
+    for (int i = 0; i < 9; ++i) {
+        keys.push_back(cache.MakeKey("m", "p" + std::to_string(i), ResponseCache::Scope::CHAIN));
+    }
+    for (int i = 0; i < 8; ++i) {
+        BOOST_CHECK(!cache.Get(keys[i]));
+        cache.Put(keys[i], reply + std::to_string(i));
+    }
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 8U);
+    BOOST_CHECK_EQUAL(Reply(cache.Get(keys[0])), reply + "0");
+
+    // The least recently used is evicted first.
+    cache.Put(keys[8], reply + "8");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(keys[1])), "(none)");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(keys[0])), reply + "0");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(keys[8])), reply + "8");
+
+    // Replying again replaces the reply.
+    cache.Put(keys[8], reply + "9");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(keys[8])), reply + "9");
+
+    // Replies too large are not kept.
+    const ResponseCache::Key large = cache.MakeKey("m", "large", ResponseCache::Scope::CHAIN);
+    cache.Put(large, std::string(cache.MaxReplySize(), 'x'));
+    BOOST_CHECK(!cache.Get(large));
+
+    const ResponseCache::Stats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 8U);
+    BOOST_CHECK_EQUAL(stats.bytes, usage * 8);
+    BOOST_CHECK_EQUAL(stats.max_bytes, usage * 8);
+    BOOST_CHECK_EQUAL(stats.hits, 4U);
+    BOOST_CHECK_EQUAL(stats.misses, 10U);
+}
+
+BOOST_AUTO_TEST_CASE(responsecache_invalidation)
+{
+    TestResponseCache cache(1 << 20);
+    uint256 tip_hash{uint256S("01")};
+    uint256 next_hash{uint256S("02")};
+    CBlockIndex tip;
+    tip.phashBlock = &tip_hash;
+    CBlockIndex next;
+    next.phashBlock = &next_hash;
+
+    // Replies that depend on the tip are only kept until it changes.
+    const ResponseCache::Key chain_key = cache.MakeKey("m", "p", ResponseCache::Scope::CHAIN);
+    const ResponseCache::Key tip_key = cache.MakeKey("m", "p", ResponseCache::Scope::TIP, tip_hash);
+    cache.Put(chain_key, "chain");
+    cache.Put(tip_key, "tip");
+    cache.UpdatedBlockTip(&tip, nullptr, false);
+    BOOST_CHECK_EQUAL(Reply(cache.Get(chain_key)), "chain");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(tip_key)), "tip");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(cache.MakeKey("m", "p", ResponseCache::Scope::TIP, next_hash))), "(none)");
+    cache.UpdatedBlockTip(&next, &tip, false);
+    BOOST_CHECK_EQUAL(Reply(cache.Get(chain_key)), "chain");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(tip_key)), "(none)");
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 1U);
+
+    // All are dropped when a block is disconnected, including those computed
+    // before but kept after.
+    const ResponseCache::Key before_key = cache.MakeKey("m", "before", ResponseCache::Scope::CHAIN);
+    cache.BlockDisconnected(nullptr, &next);
+    BOOST_CHECK_EQUAL(Reply(cache.Get(chain_key)), "(none)");
+    cache.Put(before_key, "before");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(before_key)), "(none)");
+    const ResponseCache::Key after_key = cache.MakeKey("m", "p", ResponseCache::Scope::CHAIN);
+    cache.Put(after_key, "after");
+    BOOST_CHECK_EQUAL(Reply(cache.Get(after_key)), "after");
+    BOOST_CHECK_EQUAL(cache.GetStats().bytes, ResponseCache::ENTRY_OVERHEAD + after_key.key.size() + 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
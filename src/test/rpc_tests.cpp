@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <rpc/client.h>
+#include <rpc/jsonwriter.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
 
@@ -13,6 +14,7 @@
 #include <util/time.h>
 
 #include <any>
+#include <optional>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/test/unit_test.hpp>
@@ -24,10 +26,25 @@
 class RPCTestingSetup : public TestingSetup
 {
 public:
-    UniValue CallRPC(std::string args);
+    UniValue CallRPC(std::string args, JSONRPCResultStream* stream = nullptr);
 };
 
-UniValue RPCTestingSetup::CallRPC(std::string args)
+/** Collects a streamed result as text. */
+class StringResultStream : public JSONRPCResultStream
+{
+public:
+    std::string m_text;
+    std::optional<JSONWriter> m_writer;
+
+    JSONWriter& Begin() override
+    {
+        m_writer.emplace([this](Span<const char> chunk) { m_text.append(chunk.begin(), chunk.end()); });
+        return *m_writer;
+    }
+    bool Started() const override { return m_writer.has_value(); }
+};
+
+UniValue RPCTestingSetup::CallRPC(std::string args, JSONRPCResultStream* stream)
 {
     std::vector<std::string> vArgs;
     boost::split(vArgs, args, boost::is_any_of(" \t"));
@@ -37,6 +54,7 @@ UniValue RPCTestingSetup::CallRPC(std::string args)
     request.context = &m_node;
     request.strMethod = strMethod;
     request.params = RPCConvertValues(strMethod, vArgs);
+    request.result_stream = stream;
     if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
     try {
         UniValue result = tableRPC.execute(request);
@@ -85,6 +103,53 @@ BOOST_AUTO_TEST_CASE(rpc_rawparams)
     BOOST_CHECK_THROW(CallRPC(std::string("sendrawtransaction ")+rawtx+" extra"), std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_stream_result)
+{
+    const std::string genesis = WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Genesis()->GetBlockHash().GetHex());
+    for (const std::string& call : {"getblock " + genesis + " 2", "getblock " + genesis + " 3", "getrawmempool true"}) {
+        StringResultStream stream;
+        BOOST_CHECK(CallRPC(call, &stream).isNull());
+        BOOST_CHECK(stream.Started());
+        stream.m_writer->Flush();
+        BOOST_CHECK_EQUAL(stream.m_text, CallRPC(call).write());
+    }
+
+    // Small results are still returned.
+    StringResultStream stream;
+    BOOST_CHECK_EQUAL(CallRPC("getblock " + genesis + " 1", &stream)["hash"].get_str(), genesis);
+    BOOST_CHECK(!stream.Started());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_batch)
+{
+    UniValue batch(UniValue::VARR);
+    for (int i = 0; i < 200; ++i) {
+        UniValue params(UniValue::VARR);
+        if (i % 3 == 1) params.push_back(0);
+        batch.push_back(JSONRPCRequestObj(i % 3 == 0 ? "getblockcount" : i % 3 == 1 ? "getblockhash" : "nosuchmethod", params, i));
+    }
+    JSONRPCRequest jreq;
+    jreq.context = &m_node;
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+    const std::string sequential = JSONRPCExecBatch(jreq, batch);
+
+    // Executing the elements in parallel gives the same replies, in order.
+    StartRPCBatchThreads(4, 3);
+    for (int i = 0; i < 10; ++i) {
+        BOOST_CHECK_EQUAL(JSONRPCExecBatch(jreq, batch), sequential);
+    }
+    BOOST_CHECK_EQUAL(JSONRPCExecBatch(jreq, UniValue(UniValue::VARR)), "[]\n");
+    StopRPCBatchThreads();
+
+    UniValue replies;
+    BOOST_REQUIRE(replies.read(sequential));
+    BOOST_REQUIRE_EQUAL(replies.size(), batch.size());
+    for (int i = 0; i < 200; ++i) {
+        BOOST_CHECK_EQUAL(find_value(replies[i], "id").get_int(), i);
+        BOOST_CHECK_EQUAL(find_value(replies[i], "error").isNull(), i % 3 != 2);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(rpc_togglenetwork)
 {
     UniValue r;
@@ -0,0 +1,257 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <hash.h>
+#include <key.h>
+#include <policy/policy.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <test/util/setup_common.h>
+#include <test/util/transaction_utils.h>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(script_template_tests, BasicTestingSetup)
+
+namespace {
+
+//! Flag combinations to compare VerifyTemplateScript and VerifyScript under.
+const unsigned int TEST_FLAGS[] = {
+    SCRIPT_VERIFY_NONE,
+    SCRIPT_VERIFY_P2SH,
+    SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS,
+    MANDATORY_SCRIPT_VERIFY_FLAGS,
+    STANDARD_SCRIPT_VERIFY_FLAGS,
+    STANDARD_SCRIPT_VERIFY_FLAGS & ~SCRIPT_VERIFY_NULLFAIL,
+    STANDARD_SCRIPT_VERIFY_FLAGS & ~(SCRIPT_VERIFY_MINIMALDATA | SCRIPT_VERIFY_CONST_SCRIPTCODE),
+    STANDARD_SCRIPT_VERIFY_FLAGS & ~(SCRIPT_VERIFY_STRICTENC | SCRIPT_VERIFY_NULLDUMMY | SCRIPT_VERIFY_WITNESS_PUBKEYTYPE),
+};
+
+/** An input spending an output, with a valid signature. */
+struct TemplateSpend {
+    CScript script_pubkey;
+    CScript script_sig;
+    CScriptWitness witness;
+    CMutableTransaction tx;
+    CAmount amount{1};
+};
+
+std::vector<unsigned char> Sign(const CKey& key, const CScript& script_code, const CMutableTransaction& tx, CAmount amount, SigVersion sigversion)
+{
+    std::vector<unsigned char> sig;
+    BOOST_CHECK(key.Sign(SignatureHash(script_code, tx, 0, SIGHASH_ALL, amount, sigversion), sig));
+    sig.push_back(SIGHASH_ALL);
+    return sig;
+}
+
+TemplateSpend MakeSpend(const CScript& script_pubkey)
+{
+    TemplateSpend spend;
+    spend.script_pubkey = script_pubkey;
+    const CMutableTransaction tx_credit = BuildCreditingTransaction(script_pubkey, spend.amount);
+    spend.tx = BuildSpendingTransaction(CScript(), CScriptWitness(), CTransaction(tx_credit));
+    return spend;
+}
+
+TemplateSpend MakeP2PKH(const CKey& key)
+{
+    const CPubKey pubkey = key.GetPubKey();
+    TemplateSpend spend = MakeSpend(CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkey.GetID()) << OP_EQUALVERIFY << OP_CHECKSIG);
+    spend.script_sig << Sign(key, spend.script_pubkey, spend.tx, spend.amount, SigVersion::BASE) << ToByteVector(pubkey);
+    return spend;
+}
+
+TemplateSpend MakeP2WPKH(const CKey& key, bool nested)
+{
+    const CPubKey pubkey = key.GetPubKey();
+    const CScript program = CScript() << OP_0 << ToByteVector(pubkey.GetID());
+    TemplateSpend spend = MakeSpend(nested ? CScript() << OP_HASH160 << ToByteVector(Hash160(program)) << OP_EQUAL : program);
+    if (nested) spend.script_sig << ToByteVector(program);
+    const CScript script_code = CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkey.GetID()) << OP_EQUALVERIFY << OP_CHECKSIG;
+    spend.witness.stack = {Sign(key, script_code, spend.tx, spend.amount, SigVersion::WITNESS_V0), ToByteVector(pubkey)};
+    return spend;
+}
+
+/** m-of-n multisig in P2SH, signed by the keys at signers. */
+TemplateSpend MakeP2SHMultisig(const std::vector<CKey>& keys, int required, const std::vector<size_t>& signers)
+{
+    CScript redeem_script;
+    redeem_script << CScript::EncodeOP_N(required);
+    for (const CKey& key : keys) redeem_script << ToByteVector(key.GetPubKey());
+    redeem_script << CScript::EncodeOP_N(keys.size()) << OP_CHECKMULTISIG;
+    TemplateSpend spend = MakeSpend(CScript() << OP_HASH160 << ToByteVector(Hash160(redeem_script)) << OP_EQUAL);
+    spend.script_sig << OP_0;
+    for (size_t signer : signers) {
+        spend.script_sig << Sign(keys[signer], redeem_script, spend.tx, spend.amount, SigVersion::BASE);
+    }
+    spend.script_sig << ToByteVector(redeem_script);
+    return spend;
+}
+
+/** Compare VerifyTemplateScript with VerifyScript under all TEST_FLAGS, and return its results. */
+std::vector<TemplateResult> CheckAgainstInterpreter(const TemplateSpend& spend)
+{
+    const MutableTransactionSignatureChecker checker(&spend.tx, 0, spend.amount, MissingDataBehavior::ASSERT_FAIL);
+    std::vector<TemplateResult> results;
+    for (unsigned int flags : TEST_FLAGS) {
+        ScriptError template_err, interpreter_err;
+        const TemplateResult result = VerifyTemplateScript(spend.script_sig, spend.script_pubkey, &spend.witness, flags, checker, &template_err);
+        const bool valid = VerifyScript(spend.script_sig, spend.script_pubkey, &spend.witness, flags, checker, &interpreter_err);
+        if (result != TemplateResult::UNHANDLED) {
+            BOOST_CHECK_EQUAL(result == TemplateResult::VALID, valid);
+            BOOST_CHECK_MESSAGE(template_err == interpreter_err, ScriptErrorString(template_err) + " instead of " + ScriptErrorString(interpreter_err));
+        }
+        results.push_back(result);
+    }
+    return results;
+}
+
+/** The result under STANDARD_SCRIPT_VERIFY_FLAGS. */
+TemplateResult CheckStandard(const TemplateSpend& spend)
+{
+    return CheckAgainstInterpreter(spend)[4];
+}
+
+/** Flip random bits of the scriptSig and witness, and compare the results every time. */
+void CheckMutations(const TemplateSpend& spend)
+{
+    for (int i = 0; i < 200; ++i) {
+        TemplateSpend mutated = spend;
+        std::vector<std::vector<unsigned char>*> targets;
+        std::vector<unsigned char> script_sig(mutated.script_sig.begin(), mutated.script_sig.end());
+        if (!script_sig.empty()) targets.push_back(&script_sig);
+        for (auto& item : mutated.witness.stack) {
+            if (!item.empty()) targets.push_back(&item);
+        }
+        std::vector<unsigned char>& target = *targets[InsecureRandRange(targets.size())];
+        target[InsecureRandRange(target.size())] ^= 1 << InsecureRandBits(3);
+        mutated.script_sig = CScript(script_sig.begin(), script_sig.end());
+        CheckAgainstInterpreter(mutated);
+    }
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(template_p2pkh)
+{
+    for (bool compressed : {true, false}) {
+        CKey key;
+        key.MakeNewKey(compressed);
+        const TemplateSpend spend = MakeP2PKH(key);
+        BOOST_CHECK(CheckStandard(spend) == TemplateResult::VALID);
+        CheckMutations(spend);
+
+        // A bad signature fails, with NULLFAIL when it is not empty.
+        TemplateSpend bad_sig = spend;
+        std::vector<unsigned char> sig = Sign(key, spend.script_pubkey, spend.tx, spend.amount + 1, SigVersion::BASE);
+        bad_sig.script_sig = CScript() << sig << ToByteVector(key.GetPubKey());
+        BOOST_CHECK(CheckStandard(bad_sig) == TemplateResult::INVALID);
+        bad_sig.script_sig = CScript() << OP_0 << ToByteVector(key.GetPubKey());
+        BOOST_CHECK(CheckStandard(bad_sig) == TemplateResult::INVALID);
+
+        // So does an undefined hash type.
+        sig.back() = 0;
+        bad_sig.script_sig = CScript() << sig << ToByteVector(key.GetPubKey());
+        BOOST_CHECK(CheckStandard(bad_sig) == TemplateResult::INVALID);
+
+        // The interpreter decides on the wrong key, extra pushes and unexpected witnesses.
+        CKey other_key;
+        other_key.MakeNewKey(compressed);
+        TemplateSpend unhandled = spend;
+        unhandled.script_sig = CScript() << sig << ToByteVector(other_key.GetPubKey());
+        BOOST_CHECK(CheckStandard(unhandled) == TemplateResult::UNHANDLED);
+        unhandled.script_sig = spend.script_sig;
+        unhandled.script_sig << OP_1;
+        BOOST_CHECK(CheckStandard(unhandled) == TemplateResult::UNHANDLED);
+        // And on non-minimal pushes, when they matter.
+        const std::vector<unsigned char> good_sig = Sign(key, spend.script_pubkey, spend.tx, spend.amount, SigVersion::BASE);
+        unhandled.script_sig = CScript() << OP_PUSHDATA1;
+        unhandled.script_sig.push_back(good_sig.size());
+        unhandled.script_sig.insert(unhandled.script_sig.end(), good_sig.begin(), good_sig.end());
+        unhandled.script_sig << ToByteVector(key.GetPubKey());
+        const std::vector<TemplateResult> results = CheckAgainstInterpreter(unhandled);
+        BOOST_CHECK(results[4] == TemplateResult::UNHANDLED);
+        BOOST_CHECK(results[6] == TemplateResult::VALID);
+        unhandled = spend;
+        unhandled.witness.stack = {{1}};
+        BOOST_CHECK(CheckStandard(unhandled) == TemplateResult::UNHANDLED);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(template_p2wpkh)
+{
+    for (bool nested : {false, true}) {
+        CKey key;
+        key.MakeNewKey(true);
+        const TemplateSpend spend = MakeP2WPKH(key, nested);
+        BOOST_CHECK(CheckStandard(spend) == TemplateResult::VALID);
+        CheckMutations(spend);
+
+        TemplateSpend bad_sig = spend;
+        bad_sig.witness.stack[0].back() = SIGHASH_NONE;
+        BOOST_CHECK(CheckStandard(bad_sig) == TemplateResult::INVALID);
+        bad_sig.witness.stack[0].clear();
+        BOOST_CHECK(CheckStandard(bad_sig) == TemplateResult::INVALID);
+
+        // Uncompressed keys are not standard in witnesses.
+        CKey uncompressed_key;
+        uncompressed_key.MakeNewKey(false);
+        BOOST_CHECK(CheckStandard(MakeP2WPKH(uncompressed_key, nested)) == TemplateResult::INVALID);
+
+        TemplateSpend unhandled = spend;
+        unhandled.witness.stack.push_back({});
+        BOOST_CHECK(CheckStandard(unhandled) == TemplateResult::UNHANDLED);
+        unhandled = spend;
+        unhandled.script_sig << OP_0;
+        BOOST_CHECK(CheckStandard(unhandled) == TemplateResult::UNHANDLED);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(template_p2sh_multisig)
+{
+    std::vector<CKey> keys(3);
+    for (CKey& key : keys) key.MakeNewKey(true);
+
+    for (const auto& signers : std::vector<std::vector<size_t>>{{0, 1}, {0, 2}, {1, 2}}) {
+        const TemplateSpend spend = MakeP2SHMultisig(keys, 2, signers);
+        BOOST_CHECK(CheckStandard(spend) == TemplateResult::VALID);
+        CheckMutations(spend);
+    }
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 1, {2})) == TemplateResult::VALID);
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 3, {0, 1, 2})) == TemplateResult::VALID);
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig({keys[0]}, 1, {0})) == TemplateResult::VALID);
+
+    // Signatures out of order, or by the same key twice, fail.
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 2, {1, 0})) == TemplateResult::INVALID);
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 2, {1, 1})) == TemplateResult::INVALID);
+
+    // Too few or too many signatures are left to the interpreter.
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 2, {1})) == TemplateResult::UNHANDLED);
+    BOOST_CHECK(CheckStandard(MakeP2SHMultisig(keys, 1, {1, 2})) == TemplateResult::UNHANDLED);
+
+    // As are a non-empty dummy and a signature that FindAndDelete would remove.
+    TemplateSpend spend = MakeP2SHMultisig(keys, 2, {0, 1});
+    std::vector<unsigned char> script_sig(spend.script_sig.begin(), spend.script_sig.end());
+    script_sig[0] = OP_1;
+    spend.script_sig = CScript(script_sig.begin(), script_sig.end());
+    BOOST_CHECK(CheckStandard(spend) == TemplateResult::UNHANDLED);
+
+    CScript redeem_script = CScript() << OP_1 << ToByteVector(keys[0].GetPubKey()) << OP_1 << OP_CHECKMULTISIG;
+    spend = MakeSpend(CScript() << OP_HASH160 << ToByteVector(Hash160(redeem_script)) << OP_EQUAL);
+    spend.script_sig << OP_0 << ToByteVector(keys[0].GetPubKey()) << ToByteVector(redeem_script);
+    BOOST_CHECK(CheckStandard(spend) == TemplateResult::UNHANDLED);
+
+    // More than 16 keys are left to the interpreter.
+    std::vector<CKey> many_keys(17);
+    for (CKey& key : many_keys) key.MakeNewKey(true);
+    redeem_script = CScript() << OP_1;
+    for (const CKey& key : many_keys) redeem_script << ToByteVector(key.GetPubKey());
+    redeem_script << 17 << OP_CHECKMULTISIG;
+    spend = MakeSpend(CScript() << OP_HASH160 << ToByteVector(Hash160(redeem_script)) << OP_EQUAL);
+    spend.script_sig << OP_0 << Sign(many_keys[0], redeem_script, spend.tx, spend.amount, SigVersion::BASE) << ToByteVector(redeem_script);
+    BOOST_CHECK(CheckStandard(spend) == TemplateResult::UNHANDLED);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
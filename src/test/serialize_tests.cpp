@@ -3,11 +3,15 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <hash.h>
+#include <prevector.h>
+#include <script/script.h>
 #include <serialize.h>
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <uint256.h>
 #include <util/strencodings.h>
 
+#include <limits>
 #include <stdint.h>
 
 #include <boost/test/unit_test.hpp>
@@ -178,6 +182,55 @@ BOOST_AUTO_TEST_CASE(vector_bool)
     BOOST_CHECK(SerializeHash(vec1) == SerializeHash(vec2));
 }
 
+template <typename V>
+static void CheckBulkSerialization(const V& v)
+{
+    // Bulk serialization must be the same on the wire as serializing element by element.
+    CDataStream bulk(SER_DISK, 0);
+    CDataStream elementwise(SER_DISK, 0);
+    bulk << v;
+    elementwise << Using<VectorFormatter<DefaultFormatter>>(v);
+    BOOST_CHECK_EQUAL(HexStr(bulk), HexStr(elementwise));
+    BOOST_CHECK_EQUAL(bulk.size(), GetSerializeSize(v, 0));
+
+    V read;
+    bulk >> read;
+    BOOST_CHECK(read == v);
+    BOOST_CHECK(bulk.empty());
+}
+
+BOOST_AUTO_TEST_CASE(vector_bulk)
+{
+#if !defined(WORDS_BIGENDIAN)
+    static_assert(IsBulkSerializable<uint32_t>::value, "integers are bulk serializable on little-endian hosts");
+#endif
+    static_assert(IsBulkSerializable<uint256>::value, "uint256 serializes as bytes");
+    static_assert(!IsBulkSerializable<bool>::value && !IsBulkSerializable<CScript>::value, "");
+
+    CheckBulkSerialization(std::vector<uint16_t>{});
+    CheckBulkSerialization(std::vector<uint16_t>{1, 0x1234, 0xfffe});
+    CheckBulkSerialization(std::vector<int32_t>{-1, 0, 0x12345678, std::numeric_limits<int32_t>::min()});
+    CheckBulkSerialization(std::vector<uint64_t>{0, 1, 0x0123456789abcdefULL});
+    CheckBulkSerialization(std::vector<int64_t>{-2, std::numeric_limits<int64_t>::max()});
+    const std::vector<uint32_t> ints{1, 2, 3, 4, 5, 6};
+    CheckBulkSerialization(prevector<4, uint32_t>(ints.begin(), ints.end()));
+    CheckBulkSerialization(prevector<4, uint32_t>(ints.begin(), ints.begin() + 1));
+
+    std::vector<uint256> hashes;
+    for (int i = 0; i < 100; ++i) {
+        hashes.push_back(SerializeHash(i));
+    }
+    CheckBulkSerialization(hashes);
+    CheckBulkSerialization(std::vector<uint160>(3, uint160(std::vector<unsigned char>(20, 0x5a))));
+
+    // Truncated data is rejected as with element by element deserialization.
+    CDataStream ss(SER_DISK, 0);
+    ss << hashes;
+    ss.resize(ss.size() - 1);
+    std::vector<uint256> read;
+    BOOST_CHECK_THROW(ss >> read, std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_CASE(noncanonical)
 {
     // Write some non-canonical CompactSize encodings, and
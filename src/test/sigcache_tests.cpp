@@ -0,0 +1,192 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <clientversion.h>
+#include <crypto/sha256.h>
+#include <fs.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/sigcache.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/system.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/** The cache entry of an ECDSA signature: SHA256(nonce || 'E' || 31 zero bytes || sighash || pubkey || signature). */
+uint256 EntryECDSA(const uint256& nonce, const uint256& sighash, const CPubKey& pubkey, const std::vector<unsigned char>& sig)
+{
+    static constexpr unsigned char PADDING_ECDSA[32] = {'E'};
+    uint256 entry;
+    CSHA256().Write(nonce.begin(), 32).Write(PADDING_ECDSA, 32).Write(sighash.begin(), 32).Write(pubkey.data(), pubkey.size()).Write(sig.data(), sig.size()).Finalize(entry.begin());
+    return entry;
+}
+
+/** Entries whose first byte is zero share a shard, for any power-of-two number of shards up to 256. */
+bool InFirstShard(const uint256& entry)
+{
+    return *entry.begin() == 0;
+}
+
+/** Read the salt and the entries of the dumped signature cache. */
+void ReadSignatureCacheDump(uint64_t& version, int& client_version, uint256& nonce, std::vector<uint256>& entries)
+{
+    CAutoFile file(fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat", "rb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    file >> version >> client_version >> nonce >> entries;
+}
+
+/** Replace the dumped signature cache, for LoadSignatureCache to read. */
+void WriteSignatureCacheDump(uint64_t version, int client_version, const uint256& nonce, const std::vector<uint256>& entries)
+{
+    CAutoFile file(fsbridge::fopen(gArgs.GetDataDirNet() / "sigcache.dat", "wb"), SER_DISK, CLIENT_VERSION);
+    BOOST_REQUIRE(!file.IsNull());
+    file << version << client_version << nonce << entries;
+}
+
+} // namespace
+
+BOOST_FIXTURE_TEST_SUITE(sigcache_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(sigcache_shard_contention)
+{
+    static constexpr int READERS = 4;
+    static constexpr int WRITERS = 2;
+    static constexpr size_t CACHED_ENTRIES = 32;
+    static constexpr size_t ENTRIES_PER_WRITER = 16;
+    static constexpr int MIN_READ_ROUNDS = 100;
+
+    // Get the salt of the cache from a dump of it.
+    uint64_t version;
+    int client_version;
+    uint256 nonce;
+    std::vector<uint256> entries;
+    BOOST_REQUIRE(DumpSignatureCache());
+    ReadSignatureCacheDump(version, client_version, nonce, entries);
+
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey = key.GetPubKey();
+
+    // Invalid signatures are only accepted when found in the cache, so the
+    // readers can tell a hit from a miss. Load entries for some of them, all
+    // in one shard.
+    const std::vector<unsigned char> bad_sig(71, 1);
+    std::vector<uint256> bad_sighashes;
+    entries.clear();
+    while (entries.size() < CACHED_ENTRIES) {
+        const uint256 sighash = InsecureRand256();
+        const uint256 entry = EntryECDSA(nonce, sighash, pubkey, bad_sig);
+        if (!InFirstShard(entry)) continue;
+        bad_sighashes.push_back(sighash);
+        entries.push_back(entry);
+    }
+    WriteSignatureCacheDump(version, client_version, nonce, entries);
+    BOOST_REQUIRE(LoadSignatureCache());
+
+    // Valid signatures, which the writers insert into the same shard.
+    std::vector<std::pair<uint256, std::vector<unsigned char>>> good_sigs;
+    while (good_sigs.size() < WRITERS * ENTRIES_PER_WRITER) {
+        const uint256 sighash = InsecureRand256();
+        std::vector<unsigned char> sig;
+        BOOST_REQUIRE(key.Sign(sighash, sig));
+        if (!InFirstShard(EntryECDSA(nonce, sighash, pubkey, sig))) continue;
+        good_sigs.emplace_back(sighash, std::move(sig));
+    }
+
+    const CTransaction tx{CMutableTransaction{}};
+    PrecomputedTransactionData txdata;
+    std::atomic<int> writers_running{WRITERS};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < READERS; ++t) {
+        threads.emplace_back([&] {
+            const CachingTransactionSignatureChecker checker(&tx, 0, 0, /* storeIn */ true, txdata);
+            for (int round = 0; round < MIN_READ_ROUNDS || writers_running > 0; ++round) {
+                for (const uint256& sighash : bad_sighashes) {
+                    if (!checker.VerifyECDSASignature(bad_sig, pubkey, sighash)) ++failures;
+                }
+            }
+        });
+    }
+    for (int t = 0; t < WRITERS; ++t) {
+        threads.emplace_back([&, t] {
+            const CachingTransactionSignatureChecker checker(&tx, 0, 0, /* storeIn */ true, txdata);
+            for (size_t i = t; i < good_sigs.size(); i += WRITERS) {
+                if (!checker.VerifyECDSASignature(good_sigs[i].second, pubkey, good_sigs[i].first)) ++failures;
+            }
+            --writers_running;
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // No lookup of a cached entry missed while the shard was being written to.
+    BOOST_CHECK_EQUAL(failures, 0);
+
+    // Both the loaded entries and the inserted ones are in the cache.
+    BOOST_REQUIRE(DumpSignatureCache());
+    ReadSignatureCacheDump(version, client_version, nonce, entries);
+    const std::set<uint256> dumped(entries.begin(), entries.end());
+    for (const uint256& sighash : bad_sighashes) {
+        BOOST_CHECK(dumped.count(EntryECDSA(nonce, sighash, pubkey, bad_sig)));
+    }
+    for (const auto& [sighash, sig] : good_sigs) {
+        BOOST_CHECK(dumped.count(EntryECDSA(nonce, sighash, pubkey, sig)));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(sigcache_persist)
+{
+    CKey key;
+    key.MakeNewKey(true);
+    const CPubKey pubkey = key.GetPubKey();
+    const CTransaction tx{CMutableTransaction{}};
+    PrecomputedTransactionData txdata;
+    const CachingTransactionSignatureChecker checker(&tx, 0, 0, /* storeIn */ true, txdata);
+
+    // A signature checked before the dump is in it, under the salt written with it.
+    const uint256 sighash = InsecureRand256();
+    std::vector<unsigned char> sig;
+    BOOST_REQUIRE(key.Sign(sighash, sig));
+    BOOST_CHECK(checker.VerifyECDSASignature(sig, pubkey, sighash));
+    BOOST_REQUIRE(DumpSignatureCache());
+    uint64_t version;
+    int client_version;
+    uint256 nonce;
+    std::vector<uint256> entries;
+    ReadSignatureCacheDump(version, client_version, nonce, entries);
+    BOOST_CHECK(std::count(entries.begin(), entries.end(), EntryECDSA(nonce, sighash, pubkey, sig)) == 1);
+
+    // Lookups after a reload hit the loaded entries. Add one for an invalid
+    // signature, which is only accepted when found in the cache.
+    const std::vector<unsigned char> bad_sig(71, 1);
+    BOOST_CHECK(!checker.VerifyECDSASignature(bad_sig, pubkey, sighash));
+    entries.push_back(EntryECDSA(nonce, sighash, pubkey, bad_sig));
+
+    // Load an empty cache with another salt first, as after a restart.
+    WriteSignatureCacheDump(version, client_version, InsecureRand256(), {});
+    BOOST_REQUIRE(LoadSignatureCache());
+    BOOST_CHECK(!checker.VerifyECDSASignature(bad_sig, pubkey, sighash));
+
+    WriteSignatureCacheDump(version, client_version, nonce, entries);
+    BOOST_REQUIRE(LoadSignatureCache());
+    BOOST_CHECK(checker.VerifyECDSASignature(bad_sig, pubkey, sighash));
+
+    // A dump written by another version is ignored.
+    WriteSignatureCacheDump(version + 1, client_version, nonce, entries);
+    BOOST_CHECK(!LoadSignatureCache());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,8 @@
 
 #include <streams.h>
 #include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <version.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -158,6 +160,50 @@ BOOST_AUTO_TEST_CASE(bitstream_reader_writer)
     BOOST_CHECK_THROW(bit_reader.Read(8), std::ios_base::failure);
 }
 
+BOOST_AUTO_TEST_CASE(streams_non_secret)
+{
+    CDataStream secret(SER_NETWORK, INIT_PROTO_VERSION);
+    CDataStream plain(non_secret, SER_NETWORK, INIT_PROTO_VERSION);
+    BOOST_CHECK(secret.get_allocator().Cleanses());
+    BOOST_CHECK(!plain.get_allocator().Cleanses());
+
+    // Non-secret streams behave like any other.
+    const std::vector<uint32_t> values{1, 2, 3, 0xdeadbeef};
+    secret << values << std::string("foo");
+    plain << values << std::string("foo");
+    BOOST_CHECK_EQUAL(HexStr(secret), HexStr(plain));
+
+    const std::vector<uint8_t> bytes(plain.begin(), plain.end());
+    CDataStream from_span(non_secret, bytes, SER_NETWORK, INIT_PROTO_VERSION);
+    BOOST_CHECK(!from_span.get_allocator().Cleanses());
+    std::vector<uint32_t> read;
+    std::string str;
+    from_span >> read >> str;
+    BOOST_CHECK(read == values);
+    BOOST_CHECK_EQUAL(str, "foo");
+
+    // The setting travels with the buffer.
+    CDataStream copy(plain);
+    BOOST_CHECK(!copy.get_allocator().Cleanses());
+    secret = std::move(plain);
+    BOOST_CHECK(!secret.get_allocator().Cleanses());
+}
+
+BOOST_AUTO_TEST_CASE(streams_reserve_for)
+{
+    const std::vector<uint32_t> values(1000, 42);
+    const std::string str(100, 'x');
+
+    CDataStream ss(non_secret, SER_NETWORK, INIT_PROTO_VERSION);
+    ss << uint8_t{1};
+    ss.ReserveFor(values, str);
+    const auto* const data = ss.data();
+    ss << values << str;
+    // Everything fit in the reserved space.
+    BOOST_CHECK(ss.data() == data);
+    BOOST_CHECK_EQUAL(ss.size(), 1 + GetSerializeSizeMany(INIT_PROTO_VERSION, values, str));
+}
+
 BOOST_AUTO_TEST_CASE(streams_serializedata_xor)
 {
     std::vector<uint8_t> in;
@@ -957,4 +957,25 @@ BOOST_AUTO_TEST_CASE(test_IsStandard)
     fIsBareMultisigStd = DEFAULT_PERMIT_BAREMULTISIG;
 }
 
+BOOST_AUTO_TEST_CASE(make_transaction_refs)
+{
+    std::vector<CMutableTransaction> txs(10);
+    std::vector<uint256> txids, wtxids;
+    for (size_t i = 0; i < txs.size(); ++i) {
+        txs[i].nLockTime = i;
+        txs[i].vin.resize(1);
+        if (i % 2) txs[i].vin[0].scriptWitness.stack.push_back({0x01});
+        txs[i].vout.resize(1);
+        txids.push_back(txs[i].GetHash());
+        wtxids.push_back(CTransaction(txs[i]).GetWitnessHash());
+    }
+    std::vector<CTransactionRef> refs = MakeTransactionRefs(std::move(txs));
+    BOOST_REQUIRE_EQUAL(refs.size(), txids.size());
+    for (size_t i = 0; i < refs.size(); ++i) {
+        BOOST_CHECK_EQUAL(refs[i]->GetHash(), txids[i]);
+        BOOST_CHECK_EQUAL(refs[i]->GetWitnessHash(), wtxids[i]);
+        BOOST_CHECK_EQUAL(refs[i]->nLockTime, i);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,259 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/merkle.h>
+#include <primitives/block_view.h>
+#include <primitives/transaction_view.h>
+#include <script/script.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <version.h>
+
+#include <iterator>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(transaction_view_tests, BasicTestingSetup)
+
+static std::vector<unsigned char> RandomBytes(size_t max_size)
+{
+    std::vector<unsigned char> bytes(InsecureRandRange(max_size + 1));
+    for (auto& b : bytes) b = InsecureRandBits(8);
+    return bytes;
+}
+
+static CScript RandomScript()
+{
+    static const opcodetype ops[] = {OP_0, OP_1, OP_3, OP_16, OP_DUP, OP_HASH160, OP_EQUALVERIFY, OP_CHECKSIG, OP_CHECKSIGVERIFY, OP_CHECKMULTISIG, OP_CHECKMULTISIGVERIFY};
+    CScript script;
+    const int ops_count = InsecureRandRange(10);
+    for (int i = 0; i < ops_count; i++) {
+        if (InsecureRandBool()) {
+            script << ops[InsecureRandRange(std::size(ops))];
+        } else {
+            script << RandomBytes(80);
+        }
+    }
+    return script;
+}
+
+static CMutableTransaction RandomTransaction(bool witness)
+{
+    CMutableTransaction tx;
+    tx.nVersion = InsecureRand32();
+    tx.nLockTime = InsecureRandBool() ? InsecureRand32() : 0;
+    const int ins = InsecureRandRange(4) + 1;
+    const int outs = InsecureRandRange(4) + 1;
+    for (int i = 0; i < ins; i++) {
+        CTxIn& txin = tx.vin.emplace_back(COutPoint(InsecureRand256(), InsecureRandBits(2)), RandomScript(), InsecureRand32());
+        if (witness && InsecureRandBool()) {
+            const int items = InsecureRandRange(4);
+            for (int j = 0; j < items; j++) txin.scriptWitness.stack.push_back(RandomBytes(100));
+        }
+    }
+    for (int i = 0; i < outs; i++) {
+        tx.vout.emplace_back(InsecureRandRange(MAX_MONEY / outs), RandomScript());
+    }
+    return tx;
+}
+
+static std::vector<unsigned char> Serialize(const CTransaction& tx, int flags = 0)
+{
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | flags, data, 0, tx);
+    return data;
+}
+
+static void CheckTransactionView(const CTransaction& tx, const CTransactionView& view)
+{
+    BOOST_CHECK_EQUAL(view.GetVersion(), tx.nVersion);
+    BOOST_CHECK_EQUAL(view.GetLockTime(), tx.nLockTime);
+    BOOST_CHECK_EQUAL(view.GetHash(), tx.GetHash());
+    BOOST_CHECK_EQUAL(view.GetWitnessHash(), tx.GetWitnessHash());
+    BOOST_CHECK_EQUAL(view.HasWitness(), tx.HasWitness());
+    BOOST_CHECK_EQUAL(view.IsCoinBase(), tx.IsCoinBase());
+    BOOST_CHECK_EQUAL(view.IsNull(), tx.IsNull());
+    BOOST_CHECK_EQUAL(view.GetTotalSize(), tx.GetTotalSize());
+    BOOST_CHECK_EQUAL(view.GetStrippedSize(), ::GetSerializeSize(tx, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
+
+    BOOST_REQUIRE_EQUAL(view.Inputs().size(), tx.vin.size());
+    size_t i = 0;
+    for (const auto& txin : view.Inputs()) {
+        BOOST_CHECK(txin.prevout == tx.vin[i].prevout);
+        BOOST_CHECK_EQUAL(HexStr(txin.scriptSig), HexStr(tx.vin[i].scriptSig));
+        BOOST_CHECK_EQUAL(txin.nSequence, tx.vin[i].nSequence);
+        BOOST_CHECK(txin.scriptWitness.ToScriptWitness().stack == tx.vin[i].scriptWitness.stack);
+        BOOST_CHECK(txin.ToTxIn() == tx.vin[i]);
+        ++i;
+    }
+    BOOST_REQUIRE_EQUAL(view.Outputs().size(), tx.vout.size());
+    i = 0;
+    for (const auto& txout : view.Outputs()) {
+        BOOST_CHECK(txout.ToTxOut() == tx.vout[i]);
+        ++i;
+    }
+
+    std::vector<unsigned char> with_witness, without_witness;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, with_witness, 0, view);
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS, without_witness, 0, view);
+    BOOST_CHECK(with_witness == Serialize(tx));
+    BOOST_CHECK(without_witness == Serialize(tx, SERIALIZE_TRANSACTION_NO_WITNESS));
+    BOOST_CHECK(Serialize(*view.ToTransaction()) == Serialize(tx));
+}
+
+static void CheckTransactionView(const CTransaction& tx)
+{
+    const std::vector<unsigned char> data = Serialize(tx);
+    CheckTransactionView(tx, CTransactionView(MakeByteSpan(data)));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_view_random)
+{
+    for (int i = 0; i < 200; i++) {
+        CheckTransactionView(CTransaction(RandomTransaction(/* witness */ i % 2)));
+    }
+
+    // Transactions CheckTransaction() rejects still parse.
+    CMutableTransaction mtx = RandomTransaction(/* witness */ true);
+    mtx.vin.push_back(mtx.vin[0]);
+    CheckTransactionView(CTransaction(mtx)); // bad-txns-inputs-duplicate
+    mtx = RandomTransaction(/* witness */ false);
+    mtx.vout[0].nValue = -1;
+    CheckTransactionView(CTransaction(mtx)); // bad-txns-vout-negative
+    mtx.vout[0].nValue = 0;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.SetNull();
+    mtx.vin[0].scriptSig = CScript() << OP_1;
+    CheckTransactionView(CTransaction(mtx)); // bad-cb-length
+
+    // Neither inputs nor outputs: the byte after the empty input count is the
+    // empty output count, not a flag.
+    CheckTransactionView(CTransaction(CMutableTransaction()));
+}
+
+BOOST_AUTO_TEST_CASE(transaction_view_invalid)
+{
+    CMutableTransaction mtx = RandomTransaction(/* witness */ true);
+    mtx.vin[0].scriptWitness.stack.push_back({0x01});
+    const CTransaction tx(mtx);
+    const std::vector<unsigned char> data = Serialize(tx);
+
+    // Truncated at every position.
+    for (size_t size = 0; size < data.size(); size++) {
+        const Span<const unsigned char> truncated(data.data(), size);
+        BOOST_CHECK_THROW(CTransactionView{MakeByteSpan(truncated)}, std::ios_base::failure);
+    }
+
+    // Trailing data.
+    std::vector<unsigned char> trailing = data;
+    trailing.push_back(0);
+    BOOST_CHECK_THROW(CTransactionView{MakeByteSpan(trailing)}, std::ios_base::failure);
+
+    // Witness flag with only empty witness stacks.
+    for (auto& txin : mtx.vin) txin.scriptWitness.SetNull();
+    std::vector<unsigned char> superfluous = Serialize(CTransaction(mtx));
+    superfluous.insert(superfluous.begin() + 4, {0x00, 0x01});
+    superfluous.insert(superfluous.end() - 4, mtx.vin.size(), 0x00);
+    BOOST_CHECK_THROW(CDataStream(superfluous, SER_NETWORK, PROTOCOL_VERSION) >> mtx, std::ios_base::failure);
+    BOOST_CHECK_THROW(CTransactionView{MakeByteSpan(superfluous)}, std::ios_base::failure);
+
+    // Unknown flag.
+    std::vector<unsigned char> unknown_flag = data;
+    unknown_flag[5] = 0x03;
+    BOOST_CHECK_THROW(CDataStream(unknown_flag, SER_NETWORK, PROTOCOL_VERSION) >> mtx, std::ios_base::failure);
+    BOOST_CHECK_THROW(CTransactionView{MakeByteSpan(unknown_flag)}, std::ios_base::failure);
+
+    // Non-canonical compact size for the input count.
+    std::vector<unsigned char> non_canonical = Serialize(tx, SERIALIZE_TRANSACTION_NO_WITNESS);
+    non_canonical[4] = 0xfd;
+    non_canonical.insert(non_canonical.begin() + 5, {uint8_t(tx.vin.size()), 0x00});
+    BOOST_CHECK_THROW(CTransactionView{MakeByteSpan(non_canonical)}, std::ios_base::failure);
+}
+
+static CBlock RandomBlock(size_t txs)
+{
+    CBlock block;
+    block.nVersion = 4;
+    block.hashPrevBlock = InsecureRand256();
+    block.nTime = InsecureRand32();
+    block.nBits = InsecureRand32();
+    block.nNonce = InsecureRand32();
+
+    CMutableTransaction coinbase = RandomTransaction(/* witness */ false);
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+    block.vtx.push_back(MakeTransactionRef(std::move(coinbase)));
+    for (size_t i = 1; i < txs; i++) {
+        block.vtx.push_back(MakeTransactionRef(RandomTransaction(/* witness */ true)));
+    }
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    return block;
+}
+
+static void CheckBlockView(const CBlock& block)
+{
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, data, 0, block);
+    const CBlockView view(MakeByteSpan(data));
+
+    BOOST_CHECK_EQUAL(view.GetHash(), block.GetHash());
+    BOOST_CHECK_EQUAL(view.GetTotalSize(), data.size());
+    BOOST_CHECK_EQUAL(view.GetStrippedSize(), ::GetSerializeSize(block, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS));
+    BOOST_REQUIRE_EQUAL(view.Transactions().size(), block.vtx.size());
+    const std::vector<uint256> txids = view.GetTxHashes();
+    const std::vector<uint256> wtxids = view.GetWitnessHashes();
+    for (size_t i = 0; i < block.vtx.size(); i++) {
+        BOOST_CHECK_EQUAL(txids[i], block.vtx[i]->GetHash());
+        BOOST_CHECK_EQUAL(wtxids[i], block.vtx[i]->GetWitnessHash());
+        CheckTransactionView(*block.vtx[i], view.Transactions()[i]);
+    }
+
+    std::vector<unsigned char> with_witness, without_witness, stripped;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, with_witness, 0, view);
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS, without_witness, 0, view);
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION | SERIALIZE_TRANSACTION_NO_WITNESS, stripped, 0, block);
+    BOOST_CHECK(with_witness == data);
+    BOOST_CHECK(without_witness == stripped);
+
+    std::vector<unsigned char> materialized;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, materialized, 0, view.ToBlock());
+    BOOST_CHECK(materialized == data);
+}
+
+BOOST_AUTO_TEST_CASE(block_view)
+{
+    for (size_t txs = 1; txs < 20; txs++) {
+        CheckBlockView(RandomBlock(txs));
+    }
+
+    // Blocks CheckBlock() rejects still parse.
+    CBlock block = RandomBlock(5);
+    block.vtx.push_back(block.vtx.back());
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    CheckBlockView(block); // bad-txns-duplicate
+
+    block = RandomBlock(5);
+    block.hashMerkleRoot = InsecureRand256();
+    CheckBlockView(block); // bad-txnmrklroot
+
+    block = RandomBlock(5);
+    block.vtx[0] = MakeTransactionRef(RandomTransaction(/* witness */ false));
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    CheckBlockView(block); // bad-cb-missing
+
+    block = RandomBlock(5);
+    block.vtx[2] = block.vtx[0];
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    CheckBlockView(block); // bad-cb-multiple
+
+    // Trailing data after the last transaction.
+    std::vector<unsigned char> data;
+    CVectorWriter(SER_NETWORK, PROTOCOL_VERSION, data, 0, RandomBlock(3));
+    data.push_back(0);
+    BOOST_CHECK_THROW(CBlockView{MakeByteSpan(data)}, std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -53,6 +53,26 @@ BOOST_FIXTURE_TEST_CASE(txindex_initial_sync, TestChain100Setup)
         }
     }
 
+    // Check that a batched lookup finds the same transactions, in request
+    // order, and reports the ones that are not indexed as missing.
+    std::vector<uint256> hashes;
+    for (auto it = m_coinbase_txns.rbegin(); it != m_coinbase_txns.rend(); ++it) {
+        hashes.push_back((*it)->GetHash());
+    }
+    hashes.push_back(genesis_block.vtx[0]->GetHash());
+    std::vector<uint256> block_hashes;
+    std::vector<CTransactionRef> txs_disk;
+    BOOST_CHECK_EQUAL(txindex.FindTxs(hashes, block_hashes, txs_disk), m_coinbase_txns.size());
+    BOOST_REQUIRE_EQUAL(txs_disk.size(), hashes.size());
+    for (size_t i = 0; i < m_coinbase_txns.size(); ++i) {
+        BOOST_REQUIRE(txs_disk[i]);
+        BOOST_CHECK(txs_disk[i]->GetHash() == hashes[i]);
+        BOOST_CHECK(txindex.FindTx(hashes[i], block_hash, tx_disk));
+        BOOST_CHECK(block_hashes[i] == block_hash);
+    }
+    BOOST_CHECK(!txs_disk.back());
+    BOOST_CHECK(block_hashes.back().IsNull());
+
     // Check that new transactions in new blocks make it into the index.
     for (int i = 0; i < 10; i++) {
         CScript coinbase_script_pub_key = GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
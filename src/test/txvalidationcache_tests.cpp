@@ -4,6 +4,7 @@
 
 #include <consensus/validation.h>
 #include <key.h>
+#include <script/sigcache.h>
 #include <script/sign.h>
 #include <script/signingprovider.h>
 #include <script/standard.h>
@@ -374,4 +375,45 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, TestChain100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(scriptcache_persist, TestChain100Setup)
+{
+    LOCK(cs_main);
+    InitScriptExecutionCache();
+
+    const CScript p2pk_scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CMutableTransaction spend_tx;
+    spend_tx.nVersion = 1;
+    spend_tx.vin.resize(1);
+    spend_tx.vin[0].prevout = COutPoint{m_coinbase_txns[0]->GetHash(), 0};
+    spend_tx.vout.resize(1);
+    spend_tx.vout[0].nValue = 11 * CENT;
+    spend_tx.vout[0].scriptPubKey = p2pk_scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    BOOST_CHECK(coinbaseKey.Sign(SignatureHash(p2pk_scriptPubKey, spend_tx, 0, SIGHASH_ALL, 0, SigVersion::BASE), vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    spend_tx.vin[0].scriptSig << vchSig;
+    const CTransaction tx{spend_tx};
+
+    TxValidationState state;
+    PrecomputedTransactionData txdata;
+    std::vector<CScriptCheck> scriptchecks;
+    BOOST_CHECK(CheckInputScripts(tx, state, &::ChainstateActive().CoinsTip(), SCRIPT_VERIFY_P2SH, true, true, txdata, nullptr));
+    BOOST_CHECK(DumpScriptExecutionCache());
+
+    // A new salt makes the cached execution unreachable...
+    InitScriptExecutionCache();
+    BOOST_CHECK(CheckInputScripts(tx, state, &::ChainstateActive().CoinsTip(), SCRIPT_VERIFY_P2SH, true, false, txdata, &scriptchecks));
+    BOOST_CHECK_EQUAL(scriptchecks.size(), 1U);
+
+    // ...until the dumped cache and its salt are loaded back.
+    scriptchecks.clear();
+    BOOST_CHECK(LoadScriptExecutionCache());
+    BOOST_CHECK(CheckInputScripts(tx, state, &::ChainstateActive().CoinsTip(), SCRIPT_VERIFY_P2SH, true, false, txdata, &scriptchecks));
+    BOOST_CHECK(scriptchecks.empty());
+
+    // The signature cache is persisted alongside; sigcache_tests check its lookups after a reload.
+    BOOST_CHECK(DumpSignatureCache());
+    BOOST_CHECK(LoadSignatureCache());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
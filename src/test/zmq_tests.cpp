@@ -0,0 +1,107 @@
+// Copyright (c) 2021 The Chymera Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/transaction.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <util/strencodings.h>
+#include <version.h>
+#include <zmq/zmqpublishnotifier.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(zmq_tests, BasicTestingSetup)
+
+static std::vector<std::string> Buffered(const CZMQRawTransactionBatch& batch, uint64_t first, size_t count, uint64_t expected_oldest, uint64_t expected_next)
+{
+    std::vector<std::string> txs;
+    uint64_t oldest, next;
+    BOOST_CHECK(batch.GetBuffered(first, count, txs, oldest, next));
+    BOOST_CHECK_EQUAL(oldest, expected_oldest);
+    BOOST_CHECK_EQUAL(next, expected_next);
+    return txs;
+}
+
+BOOST_AUTO_TEST_CASE(rawtxbatch_framing)
+{
+    CZMQRawTransactionBatch batch(1 << 20);
+    BOOST_CHECK(batch.Empty());
+    BOOST_CHECK_EQUAL(batch.Add("ab"), 2U);
+    BOOST_CHECK_EQUAL(batch.Add(""), 2U);
+    BOOST_CHECK_EQUAL(batch.Add("cde"), 5U);
+    BOOST_CHECK(!batch.Empty());
+
+    // First sequence number, count, compression, then each size and transaction
+    BOOST_CHECK_EQUAL(HexStr(batch.TakeBatch()), "0000000000000000" "03000000" "00"
+                                                 "02000000" "6162"
+                                                 "00000000"
+                                                 "03000000" "636465");
+    BOOST_CHECK(batch.Empty());
+
+    // The next batch continues the sequence numbers.
+    BOOST_CHECK_EQUAL(batch.Add("f"), 1U);
+    BOOST_CHECK_EQUAL(HexStr(batch.TakeBatch()), "0300000000000000" "01000000" "00" "01000000" "66");
+    BOOST_CHECK_EQUAL(HexStr(batch.TakeBatch()), "0400000000000000" "00000000" "00");
+}
+
+BOOST_AUTO_TEST_CASE(rawtxbatch_buffer)
+{
+    CZMQRawTransactionBatch batch(12);
+    // A subscriber receives the batch of 0, misses that of 1 and 2, and
+    // receives that of 3, which evicts 0 from the buffer.
+    batch.Add("aaaa");
+    batch.TakeBatch();
+    batch.Add("bbbb");
+    batch.Add("cccc");
+    batch.TakeBatch();
+    batch.Add("dddd");
+    // Transactions are only evicted once the batch being collected is taken.
+    BOOST_CHECK(Buffered(batch, 0, 10, 0, 3) == (std::vector<std::string>{"aaaa", "bbbb", "cccc"}));
+    batch.TakeBatch();
+
+    // The subscriber recovers the gap between 0 and 3.
+    BOOST_CHECK(Buffered(batch, 1, 2, 1, 4) == (std::vector<std::string>{"bbbb", "cccc"}));
+    BOOST_CHECK(Buffered(batch, 1, 10, 1, 4) == (std::vector<std::string>{"bbbb", "cccc", "dddd"}));
+    BOOST_CHECK(Buffered(batch, 4, 10, 1, 4).empty());
+    std::vector<std::string> txs;
+    uint64_t oldest, next;
+    BOOST_CHECK(!batch.GetBuffered(0, 10, txs, oldest, next));
+    BOOST_CHECK(!batch.GetBuffered(5, 10, txs, oldest, next));
+
+    // The batch being collected is not returned before it is published.
+    batch.Add("eeee");
+    BOOST_CHECK(Buffered(batch, 3, 10, 1, 4) == std::vector<std::string>{"dddd"});
+    batch.TakeBatch();
+    // Lookups are relative to the oldest buffered transaction.
+    BOOST_CHECK(Buffered(batch, 2, 1, 2, 5) == std::vector<std::string>{"cccc"});
+    BOOST_CHECK(Buffered(batch, 4, 10, 2, 5) == std::vector<std::string>{"eeee"});
+
+    // A transaction larger than the whole buffer is published but not kept.
+    batch.Add(std::string(20, 'f'));
+    BOOST_CHECK_EQUAL(batch.TakeBatch().size(), 8U + 4U + 1U + 4U + 20U);
+    BOOST_CHECK(Buffered(batch, 6, 10, 6, 6).empty());
+    BOOST_CHECK(!batch.GetBuffered(5, 10, txs, oldest, next));
+}
+
+BOOST_AUTO_TEST_CASE(rawtxbatch_outlives_notifier)
+{
+    const CTransaction tx{CMutableTransaction{}};
+    std::shared_ptr<CZMQRawTransactionBatch> batch;
+    {
+        CZMQPublishRawTransactionBatchNotifier notifier;
+        batch = notifier.GetBatch();
+        // Below -zmqpubrawtxbatchsize, so collected without being sent.
+        BOOST_CHECK(notifier.NotifyTransaction(tx));
+    }
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << tx;
+    batch->TakeBatch();
+    BOOST_CHECK(Buffered(*batch, 0, 10, 0, 1) == std::vector<std::string>{ss.str()});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
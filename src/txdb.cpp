@@ -14,6 +14,7 @@
 #include <util/translation.h>
 #include <util/vector.h>
 
+#include <algorithm>
 #include <stdint.h>
 
 static constexpr uint8_t DB_COIN{'C'};
@@ -176,14 +177,45 @@ CCoinsViewCursor *CCoinsViewDB::Cursor() const
        that restriction.  */
     i->pcursor->Seek(DB_COIN);
     // Cache key of first record
-    if (i->pcursor->Valid()) {
-        CoinEntry entry(&i->keyTmp.second);
-        i->pcursor->GetKey(entry);
-        i->keyTmp.first = entry.key;
+    i->LoadKey();
+    return i;
+}
+
+std::vector<std::unique_ptr<CCoinsViewCursor>> CCoinsViewDB::PartitionedCursors(size_t n) const
+{
+    // Coins are keyed by txid, so splitting on the leading txid byte yields
+    // evenly sized ranges that never separate the outputs of a transaction.
+    n = std::clamp<size_t>(n, 1, 256);
+
+    CDBWrapper* db = m_db.get();
+    std::shared_ptr<const leveldb::Snapshot> snapshot{db->GetSnapshot(),
+        [db](const leveldb::Snapshot* s) { db->ReleaseSnapshot(s); }};
+    const uint256 best_block = GetBestBlock();
+
+    std::vector<std::unique_ptr<CCoinsViewCursor>> cursors;
+    cursors.reserve(n);
+    for (size_t part = 0; part < n; ++part) {
+        const unsigned int begin_prefix = 256 * part / n;
+        const unsigned int end_prefix = 256 * (part + 1) / n;
+        std::unique_ptr<CCoinsViewDBCursor> cursor{new CCoinsViewDBCursor(db->NewIterator(snapshot.get()), best_block, snapshot, end_prefix)};
+
+        COutPoint start{uint256{}, 0};
+        *start.hash.begin() = begin_prefix;
+        cursor->pcursor->Seek(CoinEntry(&start));
+        cursor->LoadKey();
+        cursors.push_back(std::move(cursor));
+    }
+    return cursors;
+}
+
+void CCoinsViewDBCursor::LoadKey()
+{
+    CoinEntry entry(&keyTmp.second);
+    if (!pcursor->Valid() || !pcursor->GetKey(entry) || *keyTmp.second.hash.begin() >= m_end_prefix) {
+        keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
     } else {
-        i->keyTmp.first = 0; // Make sure Valid() and GetKey() return false
+        keyTmp.first = entry.key;
     }
-    return i;
 }
 
 bool CCoinsViewDBCursor::GetKey(COutPoint &key) const
@@ -214,12 +246,7 @@ bool CCoinsViewDBCursor::Valid() const
 void CCoinsViewDBCursor::Next()
 {
     pcursor->Next();
-    CoinEntry entry(&keyTmp.second);
-    if (!pcursor->Valid() || !pcursor->GetKey(entry)) {
-        keyTmp.first = 0; // Invalidate cached key after last record so that Valid() and GetKey() return false
-    } else {
-        keyTmp.first = entry.key;
-    }
+    LoadKey();
 }
 
 bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo) {
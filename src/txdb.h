@@ -61,6 +61,7 @@ public:
     std::vector<uint256> GetHeadBlocks() const override;
     bool BatchWrite(CCoinsMap &mapCoins, const uint256 &hashBlock) override;
     CCoinsViewCursor *Cursor() const override;
+    std::vector<std::unique_ptr<CCoinsViewCursor>> PartitionedCursors(size_t n) const override;
 
     //! Attempt to update from an older database format. Returns whether an error occurred.
     bool Upgrade();
@@ -86,8 +87,19 @@ public:
 private:
     CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256 &hashBlockIn):
         CCoinsViewCursor(hashBlockIn), pcursor(pcursorIn) {}
+    CCoinsViewDBCursor(CDBIterator* pcursorIn, const uint256 &hashBlockIn,
+                       std::shared_ptr<const leveldb::Snapshot> snapshot, unsigned int end_prefix):
+        CCoinsViewCursor(hashBlockIn), m_snapshot(std::move(snapshot)), pcursor(pcursorIn), m_end_prefix(end_prefix) {}
+
+    //! Cache the key of the current record, or invalidate the cursor past the last one.
+    void LoadKey();
+
+    //! Snapshot shared by partitioned cursors; must outlive pcursor.
+    std::shared_ptr<const leveldb::Snapshot> m_snapshot;
     std::unique_ptr<CDBIterator> pcursor;
     std::pair<char, COutPoint> keyTmp;
+    //! The cursor ends before the first txid whose leading byte is at least this.
+    unsigned int m_end_prefix{256};
 
     friend class CCoinsViewDB;
 };
@@ -20,6 +20,9 @@ protected:
     static constexpr int WIDTH = BITS / 8;
     uint8_t m_data[WIDTH];
 public:
+    /* Serialize writes m_data as is, so vectors of blobs are serialized with a single write. */
+    static constexpr bool SERIALIZE_AS_BYTES = true;
+
     /* construct 0 value by default */
     constexpr base_blob() : m_data() {}
 
@@ -5,9 +5,12 @@
 #ifndef chymera_UTIL_GOLOMBRICE_H
 #define chymera_UTIL_GOLOMBRICE_H
 
+#include <crypto/common.h>
+#include <span.h>
 #include <streams.h>
 
 #include <cstdint>
+#include <ios>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -40,4 +43,84 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Word-at-a-time Golomb-Rice decoder over an in-memory buffer. It produces the
+ * same values as repeated GolombRiceDecode calls on a BitStreamReader, but
+ * keeps up to 64 unread bits in a register and counts the unary-encoded
+ * quotient with a single leading-zero count instead of one Read(1) per bit.
+ */
+class GolombRiceReader
+{
+private:
+    Span<const unsigned char> m_data;
+
+    /// Index of the next byte of m_data to be loaded into m_window.
+    size_t m_pos{0};
+
+    /// Unread bits, aligned to the most significant bit. Bits below the
+    /// m_bits valid ones are always zero.
+    uint64_t m_window{0};
+
+    /// Number of valid bits in m_window.
+    int m_bits{0};
+
+    void Refill()
+    {
+        while (m_bits <= 56 && m_pos < m_data.size()) {
+            m_window |= uint64_t{m_data[m_pos++]} << (56 - m_bits);
+            m_bits += 8;
+        }
+    }
+
+    void Consume(int nbits)
+    {
+        m_window = nbits < 64 ? m_window << nbits : 0;
+        m_bits -= nbits;
+    }
+
+    uint64_t ReadBits(int nbits)
+    {
+        if (nbits == 0) return 0;
+        Refill();
+        if (nbits > m_bits) {
+            // Only reachable for P > 56 or at the end of the data.
+            if (m_pos == m_data.size()) throw std::ios_base::failure("GolombRiceReader: end of data");
+            const int high_bits = m_bits;
+            const uint64_t high = ReadBits(high_bits);
+            return (high << (nbits - high_bits)) | ReadBits(nbits - high_bits);
+        }
+        const uint64_t data = m_window >> (64 - nbits);
+        Consume(nbits);
+        return data;
+    }
+
+public:
+    explicit GolombRiceReader(Span<const unsigned char> data) : m_data(data) {}
+
+    /** Decode the next value with Golomb-Rice parameter P. */
+    uint64_t Decode(uint8_t P)
+    {
+        // Read unary-encoded quotient: q 1's followed by one 0.
+        uint64_t q = 0;
+        while (true) {
+            Refill();
+            if (m_bits == 0) throw std::ios_base::failure("GolombRiceReader: end of data");
+            // Invalid bits are zero, so the run of ones never extends past m_bits.
+            const int ones = 64 - static_cast<int>(CountBits(~m_window));
+            if (ones < m_bits) {
+                q += ones;
+                Consume(ones + 1);
+                break;
+            }
+            q += m_bits;
+            Consume(m_bits);
+        }
+
+        return (q << P) + ReadBits(P);
+    }
+
+    /** Number of bytes of the input that have been at least partially read. */
+    size_t BytesConsumed() const { return m_pos - m_bits / 8; }
+};
+
 #endif // chymera_UTIL_GOLOMBRICE_H
@@ -9,6 +9,11 @@
 #include <primitives/transaction.h>
 #include <uint256.h>
 
+/**
+ * The salted hashers below hash one key at a time: the unordered containers
+ * that use them compute each hash themselves and cannot take a precomputed
+ * one. Callers holding many keys at once can use SipHashUint256Batch.
+ */
 class SaltedTxidHasher
 {
 private:
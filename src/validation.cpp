@@ -1261,6 +1261,32 @@ CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMe
     return nullptr;
 }
 
+std::vector<CTransactionRef> GetTransactions(const CTxMemPool* const mempool, const std::vector<uint256>& hashes, std::vector<uint256>& block_hashes)
+{
+    std::vector<CTransactionRef> txs(hashes.size());
+    block_hashes.assign(hashes.size(), uint256());
+
+    std::vector<size_t> missing;
+    for (size_t i = 0; i < hashes.size(); ++i) {
+        if (mempool) txs[i] = mempool->get(hashes[i]);
+        if (!txs[i]) missing.push_back(i);
+    }
+    if (missing.empty() || !g_txindex) return txs;
+
+    std::vector<uint256> missing_hashes;
+    missing_hashes.reserve(missing.size());
+    for (const size_t i : missing) missing_hashes.push_back(hashes[i]);
+
+    std::vector<uint256> found_block_hashes;
+    std::vector<CTransactionRef> found_txs;
+    g_txindex->FindTxs(missing_hashes, found_block_hashes, found_txs);
+    for (size_t j = 0; j < missing.size(); ++j) {
+        txs[missing[j]] = std::move(found_txs[j]);
+        block_hashes[missing[j]] = found_block_hashes[j];
+    }
+    return txs;
+}
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 {
     int halvings = nHeight / consensusParams.nSubsidyHalvingInterval;
@@ -1437,7 +1463,14 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight)
 bool CScriptCheck::operator()() {
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     const CScriptWitness *witness = &ptxTo->vin[nIn].scriptWitness;
-    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, CachingTransactionSignatureChecker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata), &error);
+    const CachingTransactionSignatureChecker checker(ptxTo, nIn, m_tx_out.nValue, cacheStore, *txdata);
+    // Most inputs are of a few standard types, which are verified without running the interpreter.
+    switch (VerifyTemplateScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, checker, &error)) {
+    case TemplateResult::VALID: return true;
+    case TemplateResult::INVALID: return false;
+    case TemplateResult::UNHANDLED: break;
+    } // no default case, so the compiler can warn about missing cases
+    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, witness, nFlags, checker, &error);
 }
 
 int BlockManager::GetSpendHeight(const CCoinsViewCache& inputs)
@@ -1450,16 +1483,23 @@ int BlockManager::GetSpendHeight(const CCoinsViewCache& inputs)
 
 
 static CuckooCache::cache<uint256, SignatureCacheHasher> g_scriptExecutionCache;
+static uint256 g_scriptExecutionCacheNonce;
 static CSHA256 g_scriptExecutionCacheHasher;
 
-void InitScriptExecutionCache() {
-    // Setup the salted hasher
-    uint256 nonce = GetRandHash();
+static void SetScriptExecutionCacheNonce(const uint256& nonce)
+{
+    g_scriptExecutionCacheNonce = nonce;
     // We want the nonce to be 64 bytes long to force the hasher to process
     // this chunk, which makes later hash computations more efficient. We
     // just write our 32-byte entropy twice to fill the 64 bytes.
+    g_scriptExecutionCacheHasher.Reset();
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
     g_scriptExecutionCacheHasher.Write(nonce.begin(), 32);
+}
+
+void InitScriptExecutionCache() {
+    // Setup the salted hasher
+    SetScriptExecutionCacheNonce(GetRandHash());
     // nMaxCacheSize is unsigned. If -maxsigcachesize is set to zero,
     // setup_bytes creates the minimum possible cache (2 elements).
     size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE) / 2), MAX_MAX_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
@@ -4776,6 +4816,81 @@ bool DumpMempool(const CTxMemPool& pool, FopenFn mockable_fopen_function, bool s
     return true;
 }
 
+static const uint64_t SCRIPTCACHE_DUMP_VERSION = 1;
+
+bool DumpScriptExecutionCache()
+{
+    AssertLockHeld(cs_main);
+    int64_t start = GetTimeMillis();
+
+    std::vector<uint256> entries;
+    g_scriptExecutionCache.for_each_element([&](const uint256& entry) { entries.push_back(entry); });
+
+    try {
+        FILE* filestr{fsbridge::fopen(gArgs.GetDataDirNet() / "scriptcache.dat.new", "wb")};
+        if (!filestr) {
+            return false;
+        }
+
+        CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+        file << SCRIPTCACHE_DUMP_VERSION;
+        file << int{CLIENT_VERSION};
+        file << g_scriptExecutionCacheNonce;
+        file << entries;
+
+        if (!FileCommit(file.Get()))
+            throw std::runtime_error("FileCommit failed");
+        file.fclose();
+        if (!RenameOver(gArgs.GetDataDirNet() / "scriptcache.dat.new", gArgs.GetDataDirNet() / "scriptcache.dat")) {
+            throw std::runtime_error("Rename failed");
+        }
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to dump script execution cache: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    LogPrintf("Dumped %u script execution cache entries in %dms\n", entries.size(), GetTimeMillis() - start);
+    return true;
+}
+
+bool LoadScriptExecutionCache()
+{
+    AssertLockHeld(cs_main);
+    int64_t start = GetTimeMillis();
+    FILE* filestr{fsbridge::fopen(gArgs.GetDataDirNet() / "scriptcache.dat", "rb")};
+    CAutoFile file(filestr, SER_DISK, CLIENT_VERSION);
+    if (file.IsNull()) {
+        LogPrintf("Failed to open script execution cache file from disk. Continuing anyway.\n");
+        return false;
+    }
+
+    try {
+        uint64_t version;
+        int client_version;
+        uint256 nonce;
+        file >> version;
+        file >> client_version;
+        // Entries commit to the script flags but not to the rules those flags
+        // stood for in the release that wrote them.
+        if (version != SCRIPTCACHE_DUMP_VERSION || client_version != CLIENT_VERSION) {
+            LogPrintf("Ignoring script execution cache file written by another version.\n");
+            return false;
+        }
+        file >> nonce;
+        std::vector<uint256> entries;
+        file >> entries;
+
+        SetScriptExecutionCacheNonce(nonce);
+        for (const uint256& entry : entries) {
+            g_scriptExecutionCache.insert(entry);
+        }
+        LogPrintf("Imported %u script execution cache entries from disk in %dms\n", entries.size(), GetTimeMillis() - start);
+    } catch (const std::exception& e) {
+        LogPrintf("Failed to deserialize script execution cache data on disk: %s. Continuing anyway.\n", e.what());
+        return false;
+    }
+    return true;
+}
+
 //! Guess how far we are in the verification process at the given block index
 //! require cs_main if pindex has not been validated yet (because nChainTx might be unset)
 double GuessVerificationProgress(const ChainTxData& data, const CBlockIndex *pindex) {
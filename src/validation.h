@@ -80,6 +80,8 @@ static const int64_t DEFAULT_MAX_TIP_AGE = 24 * 60 * 60;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
 static constexpr bool DEFAULT_COINSTATSINDEX{false};
+static constexpr bool DEFAULT_PREVOUTINDEX{false};
+static constexpr bool DEFAULT_BLOCKSTATSINDEX{false};
 static const char* const DEFAULT_BLOCKFILTERINDEX = "0";
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -154,6 +156,16 @@ void StopScriptCheckWorkerThreads();
  * @returns                    The tx if found, otherwise nullptr
  */
 CTransactionRef GetTransaction(const CBlockIndex* const block_index, const CTxMemPool* const mempool, const uint256& hash, const Consensus::Params& consensusParams, uint256& hashBlock);
+/**
+ * Return a batch of transactions, looked up in the mempool first and then
+ * with a single batched txindex lookup.
+ *
+ * @param[in]  mempool         Look in the mempool, if provided
+ * @param[in]  hashes          The txids
+ * @param[out] block_hashes    For each txid, the hash of the block the tx was found in, if found via txindex
+ * @returns                    For each txid, the tx if found, otherwise nullptr
+ */
+std::vector<CTransactionRef> GetTransactions(const CTxMemPool* const mempool, const std::vector<uint256>& hashes, std::vector<uint256>& block_hashes);
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams);
 
 bool AbortNode(BlockValidationState& state, const std::string& strMessage, const bilingual_str& userMessage = bilingual_str{});
@@ -324,6 +336,10 @@ public:
 
 /** Initializes the script-execution cache */
 void InitScriptExecutionCache();
+/** Save the script-execution cache and its salt to scriptcache.dat in the data directory */
+bool DumpScriptExecutionCache() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+/** Replace the script-execution cache by the one saved in scriptcache.dat, if written by this client version */
+bool LoadScriptExecutionCache() EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -36,6 +36,7 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
+    factories["pubrawtxbatch"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionBatchNotifier>;
     factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
 
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
@@ -55,6 +56,11 @@ CZMQNotificationInterface* CZMQNotificationInterface::Create()
     if (!notifiers.empty())
     {
         std::unique_ptr<CZMQNotificationInterface> notificationInterface(new CZMQNotificationInterface());
+        for (const auto& notifier : notifiers) {
+            if (notifier->GetType() == "pubrawtxbatch") {
+                notificationInterface->m_rawtx_batches[notifier->GetAddress()] = static_cast<CZMQPublishRawTransactionBatchNotifier&>(*notifier).GetBatch();
+            }
+        }
         notificationInterface->notifiers = std::move(notifiers);
 
         if (notificationInterface->Initialize()) {
@@ -129,13 +135,29 @@ void TryForEachAndRemoveFailed(std::list<std::unique_ptr<CZMQAbstractNotifier>>&
 
 } // anonymous namespace
 
+void CZMQNotificationInterface::FlushBatches()
+{
+    TryForEachAndRemoveFailed(notifiers, [](CZMQAbstractNotifier* notifier) {
+        return notifier->FlushBatch();
+    });
+}
+
+std::shared_ptr<const CZMQRawTransactionBatch> CZMQNotificationInterface::GetRawTransactionBatch(const std::string& address) const
+{
+    const auto it = m_rawtx_batches.find(address);
+    return it == m_rawtx_batches.end() ? nullptr : it->second;
+}
+
 void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
 {
+    std::shared_ptr<const CBlock> block = std::move(m_last_connected_block);
     if (fInitialDownload || pindexNew == pindexFork) // In IBD or blocks were disconnected without any new ones
         return;
 
-    TryForEachAndRemoveFailed(notifiers, [pindexNew](CZMQAbstractNotifier* notifier) {
-        return notifier->NotifyBlock(pindexNew);
+    // The new tip is usually the block just connected, which is still in memory.
+    if (block && block->GetHash() != pindexNew->GetBlockHash()) block.reset();
+    TryForEachAndRemoveFailed(notifiers, [pindexNew, &block](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlock(pindexNew, block);
     });
 }
 
@@ -171,6 +193,8 @@ void CZMQNotificationInterface::BlockConnected(const std::shared_ptr<const CBloc
     TryForEachAndRemoveFailed(notifiers, [pindexConnected](CZMQAbstractNotifier* notifier) {
         return notifier->NotifyBlockConnect(pindexConnected);
     });
+
+    m_last_connected_block = pblock;
 }
 
 void CZMQNotificationInterface::BlockDisconnected(const std::shared_ptr<const CBlock>& pblock, const CBlockIndex* pindexDisconnected)
@@ -7,10 +7,13 @@
 
 #include <validationinterface.h>
 #include <list>
+#include <map>
 #include <memory>
+#include <string>
 
 class CBlockIndex;
 class CZMQAbstractNotifier;
+class CZMQRawTransactionBatch;
 
 class CZMQNotificationInterface final : public CValidationInterface
 {
@@ -21,6 +24,20 @@ public:
 
     static CZMQNotificationInterface* Create();
 
+    /**
+     * Send the batches collected by batching notifiers. Must be called on the
+     * thread that runs the validation interface callbacks, the scheduler's,
+     * as ZMQ sockets are not thread safe.
+     */
+    void FlushBatches();
+
+    /**
+     * The transactions of the rawtxbatch notification at address, or null.
+     * They remain available after the notifier is removed. Can be called from
+     * any thread.
+     */
+    std::shared_ptr<const CZMQRawTransactionBatch> GetRawTransactionBatch(const std::string& address) const;
+
 protected:
     bool Initialize();
     void Shutdown();
@@ -37,6 +54,11 @@ private:
 
     void *pcontext;
     std::list<std::unique_ptr<CZMQAbstractNotifier>> notifiers;
+    //! Transactions of the rawtxbatch notifications by address, set on creation
+    std::map<std::string, std::shared_ptr<const CZMQRawTransactionBatch>> m_rawtx_batches;
+    //! The block last connected, kept for the UpdatedBlockTip that follows it
+    //! on the same queue of validation callbacks
+    std::shared_ptr<const CBlock> m_last_connected_block;
 };
 
 extern CZMQNotificationInterface* g_zmq_notification_interface;
@@ -15,12 +15,14 @@
 
 #include <zmq.h>
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstddef>
 #include <map>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
@@ -28,6 +30,7 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_RAWTXBATCH = "rawtxbatch";
 static const char *MSG_SEQUENCE  = "sequence";
 
 // Internal function to send multipart message
@@ -179,7 +182,47 @@ bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void
     return true;
 }
 
-bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, std::vector<unsigned char>&& data)
+{
+    assert(psocket);
+
+    if (zmq_send(psocket, command, strlen(command), ZMQ_SNDMORE) == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    // ZMQ frees the data once it has been sent, possibly from its I/O thread.
+    auto owned = new std::vector<unsigned char>(std::move(data));
+    zmq_msg_t msg;
+    int rc = zmq_msg_init_data(&msg, owned->data(), owned->size(), [](void* /*data*/, void* hint) {
+        delete static_cast<std::vector<unsigned char>*>(hint);
+    }, owned);
+    if (rc != 0) {
+        zmqError("Unable to initialize ZMQ msg");
+        delete owned;
+        return false;
+    }
+    rc = zmq_msg_send(&msg, psocket, ZMQ_SNDMORE);
+    zmq_msg_close(&msg);
+    if (rc == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(msgseq, nSequence);
+    if (zmq_send(psocket, msgseq, sizeof(msgseq), 0) == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return false;
+    }
+
+    /* increment memory only sequence number after sending */
+    nSequence++;
+
+    return true;
+}
+
+bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& /*block*/)
 {
     uint256 hash = pindex->GetBlockHash();
     LogPrint(BCLog::ZMQ, "zmq: Publish hashblock %s to %s\n", hash.GetHex(), this->address);
@@ -199,25 +242,30 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &t
     return SendZmqMessage(MSG_HASHTX, data, 32);
 }
 
-bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block)
 {
     LogPrint(BCLog::ZMQ, "zmq: Publish rawblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
-    {
+    const int serialize_flags = PROTOCOL_VERSION | RPCSerializationFlags();
+    std::vector<unsigned char> data;
+    if (block) {
+        // The block that was just connected, no need to read it back
+        data.reserve(::GetSerializeSize(*block, serialize_flags));
+        CVectorWriter{SER_NETWORK, serialize_flags, data, 0} << *block;
+    } else {
+        const Consensus::Params& consensusParams = Params().GetConsensus();
         LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
+        CBlock block_from_disk;
+        if(!ReadBlockFromDisk(block_from_disk, pindex, consensusParams))
         {
             zmqError("Can't read block from disk");
             return false;
         }
 
-        ss << block;
+        CVectorWriter{SER_NETWORK, serialize_flags, data, 0} << block_from_disk;
     }
 
-    return SendZmqMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    return SendZmqMessage(MSG_RAWBLOCK, std::move(data));
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
@@ -229,6 +277,96 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
 
+CZMQRawTransactionBatch::CZMQRawTransactionBatch(size_t buffer_bytes)
+    : m_buffer_bytes(buffer_bytes)
+{
+}
+
+size_t CZMQRawTransactionBatch::Add(std::string tx)
+{
+    LOCK(m_mutex);
+    m_buffered_bytes += tx.size();
+    m_batch_bytes += tx.size();
+    m_buffer.push_back({m_next_sequence++, std::move(tx)});
+    return m_batch_bytes;
+}
+
+bool CZMQRawTransactionBatch::Empty() const
+{
+    LOCK(m_mutex);
+    return m_batch_first == m_next_sequence;
+}
+
+// A batch is a single message with the following structure:
+//    <8-byte LE first sequence> | <4-byte LE count> | <1-byte compression> | (<4-byte LE size> | <transaction>)*count
+std::vector<unsigned char> CZMQRawTransactionBatch::TakeBatch()
+{
+    LOCK(m_mutex);
+    const uint32_t count = m_next_sequence - m_batch_first;
+
+    std::vector<unsigned char> data(sizeof(uint64_t) + sizeof(uint32_t) + 1);
+    data.reserve(data.size() + count * sizeof(uint32_t) + m_batch_bytes);
+    WriteLE64(data.data(), m_batch_first);
+    WriteLE32(data.data() + sizeof(uint64_t), count);
+    data[sizeof(uint64_t) + sizeof(uint32_t)] = COMPRESSION_NONE;
+    for (auto it = m_buffer.end() - count; it != m_buffer.end(); ++it) {
+        unsigned char size[sizeof(uint32_t)];
+        WriteLE32(size, it->data.size());
+        data.insert(data.end(), size, size + sizeof(size));
+        data.insert(data.end(), it->data.begin(), it->data.end());
+    }
+
+    m_batch_first = m_next_sequence;
+    m_batch_bytes = 0;
+    while (m_buffered_bytes > m_buffer_bytes && m_buffer.front().sequence < m_batch_first) {
+        m_buffered_bytes -= m_buffer.front().data.size();
+        m_buffer.pop_front();
+    }
+    return data;
+}
+
+bool CZMQRawTransactionBatch::GetBuffered(uint64_t first, size_t count, std::vector<std::string>& txs, uint64_t& oldest, uint64_t& next) const
+{
+    LOCK(m_mutex);
+    next = m_batch_first;
+    oldest = m_buffer.empty() || m_buffer.front().sequence >= m_batch_first ? m_batch_first : m_buffer.front().sequence;
+    if (first < oldest || first > next) return false;
+
+    // Sequence numbers are consecutive, so first is at its distance from the oldest.
+    txs.clear();
+    for (auto it = m_buffer.begin() + (first - oldest); it != m_buffer.end() && it->sequence < m_batch_first && txs.size() < count; ++it) {
+        txs.push_back(it->data);
+    }
+    return true;
+}
+
+CZMQPublishRawTransactionBatchNotifier::CZMQPublishRawTransactionBatchNotifier()
+    : m_batch_size(std::max<int64_t>(gArgs.GetArg("-zmqpubrawtxbatchsize", DEFAULT_BATCH_SIZE), 1)),
+      m_batch(std::make_shared<CZMQRawTransactionBatch>(std::max<int64_t>(gArgs.GetArg("-zmqpubrawtxbatchbuffer", DEFAULT_BATCH_BUFFER), 0) << 20))
+{
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::NotifyTransaction(const CTransaction &transaction)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION | RPCSerializationFlags());
+    ss << transaction;
+    if (m_batch->Add(ss.str()) < m_batch_size) return true;
+    return SendBatch();
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::FlushBatch()
+{
+    if (m_batch->Empty()) return true;
+    return SendBatch();
+}
+
+bool CZMQPublishRawTransactionBatchNotifier::SendBatch()
+{
+    std::vector<unsigned char> data = m_batch->TakeBatch();
+    LogPrint(BCLog::ZMQ, "zmq: Publish rawtxbatch of %d transactions from %d to %s\n", ReadLE32(data.data() + sizeof(uint64_t)), ReadLE64(data.data()), this->address);
+    return SendZmqMessage(MSG_RAWTXBATCH, std::move(data));
+}
+
 // Helper function to send a 'sequence' topic message with the following structure:
 //    <32-byte hash> | <1-byte label> | <8-byte LE sequence> (optional)
 static bool SendSequenceMsg(CZMQAbstractPublishNotifier& notifier, uint256 hash, char label, std::optional<uint64_t> sequence = {})
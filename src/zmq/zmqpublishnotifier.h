@@ -5,8 +5,14 @@
 #ifndef chymera_ZMQ_ZMQPUBLISHNOTIFIER_H
 #define chymera_ZMQ_ZMQPUBLISHNOTIFIER_H
 
+#include <sync.h>
 #include <zmq/zmqabstractnotifier.h>
 
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
 class CBlockIndex;
 
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
@@ -24,6 +30,10 @@ public:
     */
     bool SendZmqMessage(const char *command, const void* data, size_t size);
 
+    /* send zmq multipart message like the above, handing data over to
+       ZMQ instead of copying it, for large messages */
+    bool SendZmqMessage(const char *command, std::vector<unsigned char>&& data);
+
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
 };
@@ -31,7 +41,7 @@ public:
 class CZMQPublishHashBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) override;
 };
 
 class CZMQPublishHashTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -43,7 +53,7 @@ public:
 class CZMQPublishRawBlockNotifier : public CZMQAbstractPublishNotifier
 {
 public:
-    bool NotifyBlock(const CBlockIndex *pindex) override;
+    bool NotifyBlock(const CBlockIndex *pindex, const std::shared_ptr<const CBlock>& block) override;
 };
 
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
@@ -52,6 +62,91 @@ public:
     bool NotifyTransaction(const CTransaction &transaction) override;
 };
 
+/**
+ * The transactions of rawtxbatch notifications: those of the batch being
+ * collected, and the published ones, kept in a ring buffer bounded by memory
+ * from which GetBuffered() recovers those a subscriber missed. It is shared
+ * with the notification interface, so that it remains available to
+ * getzmqrawtxbatch after the notifier is removed for failing to send.
+ */
+class CZMQRawTransactionBatch
+{
+public:
+    //! Compression of the transactions of a batch; none is defined yet
+    static constexpr uint8_t COMPRESSION_NONE{0};
+
+    explicit CZMQRawTransactionBatch(size_t buffer_bytes);
+
+    /** Add a transaction to the batch being collected, and return the size of its transactions. */
+    size_t Add(std::string tx);
+
+    /** Whether no transaction was added since the batch was last taken */
+    bool Empty() const;
+
+    /**
+     * Take the batch being collected as the body of a rawtxbatch message, see
+     * doc/zmq.md. Its transactions count as published from then on, even if
+     * the message cannot be sent, so that they can be recovered like those of
+     * one that was dropped on the way.
+     */
+    std::vector<unsigned char> TakeBatch();
+
+    /**
+     * Get up to count published transactions from sequence number first on.
+     * @param[out] oldest  the oldest sequence number still buffered
+     * @param[out] next    the sequence number of the next transaction to be published
+     * @returns false if first is not buffered
+     */
+    bool GetBuffered(uint64_t first, size_t count, std::vector<std::string>& txs, uint64_t& oldest, uint64_t& next) const;
+
+private:
+    struct BufferedTx {
+        uint64_t sequence;
+        std::string data;
+    };
+
+    const size_t m_buffer_bytes;
+
+    mutable Mutex m_mutex;
+    //! Published transactions, followed by those of the batch being collected
+    std::deque<BufferedTx> m_buffer GUARDED_BY(m_mutex);
+    size_t m_buffered_bytes GUARDED_BY(m_mutex){0};
+    //! Sequence number of the first transaction of the batch being collected
+    uint64_t m_batch_first GUARDED_BY(m_mutex){0};
+    size_t m_batch_bytes GUARDED_BY(m_mutex){0};
+    uint64_t m_next_sequence GUARDED_BY(m_mutex){0};
+};
+
+/**
+ * Publishes the transactions that rawtx publishes one by one in batches,
+ * each sent once it reaches a size or by the periodic FlushBatch(). Every
+ * transaction gets a sequence number.
+ */
+class CZMQPublishRawTransactionBatchNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    //! Default size in bytes above which a batch is sent
+    static constexpr size_t DEFAULT_BATCH_SIZE{1000000};
+    //! Default milliseconds after which a batch is sent
+    static constexpr int64_t DEFAULT_BATCH_INTERVAL{100};
+    //! Default memory in MiB of the transactions kept for recovery
+    static constexpr int64_t DEFAULT_BATCH_BUFFER{16};
+
+    CZMQPublishRawTransactionBatchNotifier();
+
+    bool NotifyTransaction(const CTransaction &transaction) override;
+
+    bool FlushBatch() override;
+
+    const std::shared_ptr<CZMQRawTransactionBatch>& GetBatch() const { return m_batch; }
+
+private:
+    const size_t m_batch_size;
+    const std::shared_ptr<CZMQRawTransactionBatch> m_batch;
+
+    bool SendBatch();
+};
+
 class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -8,6 +8,8 @@
 #include <rpc/util.h>
 #include <zmq/zmqabstractnotifier.h>
 #include <zmq/zmqnotificationinterface.h>
+#include <zmq/zmqpublishnotifier.h>
+#include <util/strencodings.h>
 
 #include <univalue.h>
 
@@ -51,10 +53,76 @@ static RPCHelpMan getzmqnotifications()
     };
 }
 
+static RPCHelpMan getzmqrawtxbatch()
+{
+    return RPCHelpMan{"getzmqrawtxbatch",
+                "\nReturns raw transactions published in rawtxbatch notifications, by their sequence numbers,\n"
+                "to recover those a subscriber missed. Only the most recent ones are kept, see -zmqpubrawtxbatchbuffer.\n",
+                {
+                    {"address", RPCArg::Type::STR, RPCArg::Optional::NO, "The address of the rawtxbatch publisher"},
+                    {"first", RPCArg::Type::NUM, RPCArg::Optional::NO, "The sequence number of the first transaction"},
+                    {"count", RPCArg::Type::NUM, RPCArg::Default{1000}, "The maximum number of transactions"},
+                },
+                RPCResult{
+                    RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::NUM, "first", "The sequence number of the first transaction"},
+                        {RPCResult::Type::NUM, "next", "The sequence number of the next transaction to be published"},
+                        {RPCResult::Type::ARR, "txs", "The serialized, hex-encoded transactions, up to the next to be published",
+                        {
+                            {RPCResult::Type::STR_HEX, "", "The transaction"},
+                        }},
+                    }
+                },
+                RPCExamples{
+                    HelpExampleCli("getzmqrawtxbatch", "\"tcp://127.0.0.1:28336\" 1000")
+            + HelpExampleRpc("getzmqrawtxbatch", "\"tcp://127.0.0.1:28336\", 1000")
+                },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const std::string& address = request.params[0].get_str();
+    const int64_t first = request.params[1].get_int64();
+    if (first < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative sequence number");
+    }
+    const int count = request.params[2].isNull() ? 1000 : request.params[2].get_int();
+    if (count < 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Negative count");
+    }
+
+    // Held rather than the notifier, which may be removed meanwhile.
+    std::shared_ptr<const CZMQRawTransactionBatch> batch;
+    if (g_zmq_notification_interface != nullptr) {
+        batch = g_zmq_notification_interface->GetRawTransactionBatch(address);
+    }
+    if (!batch) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "No rawtxbatch notification at " + address);
+    }
+
+    std::vector<std::string> txs;
+    uint64_t oldest, next;
+    if (!batch->GetBuffered(first, count, txs, oldest, next)) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Sequence number %d is not available (available: %d to %d)", first, oldest, next));
+    }
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("first", first);
+    result.pushKV("next", next);
+    UniValue txs_hex(UniValue::VARR);
+    for (const std::string& tx : txs) {
+        txs_hex.push_back(HexStr(tx));
+    }
+    result.pushKV("txs", txs_hex);
+    return result;
+},
+    };
+}
+
 const CRPCCommand commands[] =
 { //  category           actor (function)
   //  -----------------  -----------------------
     { "zmq",             &getzmqnotifications,    },
+    { "zmq",             &getzmqrawtxbatch,       },
 };
 
 } // anonymous namespace